@@ -0,0 +1,52 @@
+#include "ActuatorHistory.h"
+
+bool ActuatorHistory::record(ControlDevice device, int16_t value, bool isActive, ControlCause cause) {
+    if (device >= ControlDevice::UNKNOWN) return false;
+    uint8_t index = (uint8_t)device;
+    if (known[index] && lastValue[index] == value) return false;
+
+    unsigned long now = millis();
+
+    // Наработка и включения: учитываются только переходы между "выключено"
+    // и "включено"; смена яркости или угла включенного выхода - нет
+    if (isActive != active[index]) {
+        if (isActive) {
+            activeSince[index] = now;
+            switches[index]++;
+        } else {
+            onTimeMs[index] += now - activeSince[index];
+        }
+        active[index] = isActive;
+    }
+    known[index] = true;
+    lastValue[index] = value;
+
+    Event& event = events[head];
+    event.timestamp = now;
+    event.device = device;
+    event.cause = cause;
+    event.value = value;
+
+    head = (head + 1) % EVENT_COUNT;
+    if (count < EVENT_COUNT) count++;
+    total++;
+    return true;
+}
+
+uint64_t ActuatorHistory::getOnTimeMs(ControlDevice device) const {
+    uint8_t index = (uint8_t)device;
+    uint64_t time = onTimeMs[index];
+    if (active[index]) time += millis() - activeSince[index];
+    return time;
+}
+
+const char* ActuatorHistory::causeName(ControlCause cause) {
+    switch (cause) {
+        case ControlCause::SYSTEM: return "system";
+        case ControlCause::AUTOMATION: return "automation";
+        case ControlCause::HTTP: return "http";
+        case ControlCause::MQTT: return "mqtt";
+        case ControlCause::TIMER: return "timer";
+    }
+    return "unknown";
+}
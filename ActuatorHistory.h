@@ -0,0 +1,65 @@
+#ifndef ACTUATOR_HISTORY_H
+#define ACTUATOR_HISTORY_H
+
+#include "Config.h"
+#include "DeviceNames.h"
+
+// Источник изменения состояния выхода
+enum class ControlCause : uint8_t {
+    SYSTEM,       // запуск, аварийная остановка
+    AUTOMATION,
+    HTTP,
+    MQTT,
+    TIMER
+};
+
+// Журнал переключений исполнительных устройств.
+// Каждое изменение - 8-байтовое событие в кольцевом буфере (O(1), без кучи);
+// наработка и число включений считаются по каждому выходу отдельно.
+class ActuatorHistory {
+public:
+    struct Event {
+        uint32_t timestamp;
+        ControlDevice device;
+        ControlCause cause;
+        int16_t value;
+    };
+
+    // Повтор текущего значения не записывается (false)
+    bool record(ControlDevice device, int16_t value, bool isActive, ControlCause cause);
+
+    // События по порядку: 0 - самое старое из сохраненных
+    uint16_t getEventCount() const { return count; }
+    const Event& getEvent(uint16_t index) const {
+        return events[(head + EVENT_COUNT - count + index) % EVENT_COUNT];
+    }
+    // Сквозной номер события: не сбрасывается при перезаписи буфера
+    uint32_t getSequence(uint16_t index) const { return total - count + index; }
+    uint32_t getTotalEvents() const { return total; }
+
+    // Переходы из выключенного состояния во включенное
+    uint32_t getSwitchCount(ControlDevice device) const { return switches[(uint8_t)device]; }
+    uint64_t getOnTimeMs(ControlDevice device) const;
+    bool isActive(ControlDevice device) const { return active[(uint8_t)device]; }
+
+    static const char* causeName(ControlCause cause);
+
+    static constexpr uint16_t EVENT_COUNT = 128;
+
+private:
+    static constexpr uint8_t DEVICE_COUNT = (uint8_t)ControlDevice::UNKNOWN;
+
+    Event events[EVENT_COUNT];
+    uint16_t head = 0;
+    uint16_t count = 0;
+    uint32_t total = 0;
+
+    int16_t lastValue[DEVICE_COUNT] = {};
+    bool known[DEVICE_COUNT] = {};
+    bool active[DEVICE_COUNT] = {};
+    unsigned long activeSince[DEVICE_COUNT] = {};
+    uint64_t onTimeMs[DEVICE_COUNT] = {};
+    uint32_t switches[DEVICE_COUNT] = {};
+};
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef ACTUATORS_H
+#define ACTUATORS_H
+
+#include "ActuatorHistory.h"
+
+// Выходы, которыми командует автоматика. Реализации: DeviceManager
+// (реле и матрица) и TraceReplay (решения при воспроизведении трассы).
+class Actuators {
+public:
+    virtual void controlPump(bool state, ControlCause cause, unsigned long duration = 0) = 0;
+    virtual void controlFan(bool state, ControlCause cause) = 0;
+    virtual void controlHeater(bool state, ControlCause cause) = 0;
+    virtual void controlLight(bool state, ControlCause cause) = 0;
+
+protected:
+    ~Actuators() = default;
+};
+
+#endif
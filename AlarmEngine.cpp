@@ -0,0 +1,275 @@
+#include "AlarmEngine.h"
+#include "GlobalInstances.h"
+#include "Logger.h"
+
+// ===== Описание каналов =====
+struct ChannelLimits {
+    int32_t hysteresis;            // возврат в норму - на столько глубже порога
+    float minValue, maxValue;      // допустимые пороги
+    int32_t (*toRaw)(float value);
+    int32_t (*read)(const SensorData& data, bool& valid);
+};
+
+template <typename Traits>
+static int32_t toRaw(float value) {
+    return Traits::Value::fromFloat(value).raw();
+}
+
+template <typename Traits, typename Traits::Value SensorData::*Field>
+static int32_t readChannel(const SensorData& data, bool& valid) {
+    valid = (data.*Field).isValid();
+    return (data.*Field).raw();
+}
+
+template <typename Traits, typename Traits::Value SensorData::*Field>
+static constexpr ChannelLimits limits(float hysteresis) {
+    return {Traits::Value::fromFloat(hysteresis).raw(),
+            Traits::MIN_VALUE.toFloat(), Traits::MAX_VALUE.toFloat(),
+            toRaw<Traits>, readChannel<Traits, Field>};
+}
+
+// В порядке SensorChannel
+static const ChannelLimits LIMITS[] = {
+    limits<AirTemperatureTraits, &SensorData::airTemperature>(0.5),
+    limits<AirHumidityTraits, &SensorData::airHumidity>(2.0),
+    limits<PressureTraits, &SensorData::pressure>(1.0),
+    limits<SoilTemperatureTraits, &SensorData::soilTemperature>(0.5),
+    limits<SoilMoistureTraits, &SensorData::soilMoisture>(2.0),
+    limits<LightLevelTraits, &SensorData::lightLevel>(50),
+};
+
+static_assert(sizeof(LIMITS) / sizeof(LIMITS[0]) == (size_t)SensorChannel::COUNT, "LIMITS must cover SensorChannel");
+
+// Включенный выход должен за window сдвинуть показание хотя бы на minRise
+struct StuckRule {
+    ControlDevice device;
+    SensorChannel channel;
+    int32_t minRise;
+    unsigned long window;
+};
+
+static const StuckRule STUCK[] = {
+    {ControlDevice::HEATER, SensorChannel::AIR_TEMPERATURE, Temperature::fromFloat(0.5).raw(), 1200000},
+    {ControlDevice::LIGHT, SensorChannel::LIGHT_LEVEL, Illuminance::fromFloat(20).raw(), 120000},
+};
+
+static_assert(sizeof(STUCK) / sizeof(STUCK[0]) == AlarmEngine::STUCK_RULES, "STUCK_RULES out of sync");
+
+void AlarmEngine::configure(const SystemSettings& settings) {
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        lowEnabled[i] = !isnan(settings.alarmLow[i]);
+        highEnabled[i] = !isnan(settings.alarmHigh[i]);
+        lowRaw[i] = lowEnabled[i] ? LIMITS[i].toRaw(settings.alarmLow[i]) : 0;
+        highRaw[i] = highEnabled[i] ? LIMITS[i].toRaw(settings.alarmHigh[i]) : 0;
+    }
+}
+
+void AlarmEngine::update(const SensorData& data) {
+    unsigned long now = millis();
+    if (now - lastUpdate < Constants::ALARM_EVALUATE_INTERVAL) return;
+    lastUpdate = now;
+
+    for (uint8_t channel = 0; channel < (uint8_t)SensorChannel::COUNT; channel++) {
+        bool valid;
+        int32_t value = LIMITS[channel].read(data, valid);
+        bool trusted = valid && sensorFusion.getConfidence((SensorChannel)channel) > 0;
+        if (trusted) seen[channel] = true;
+
+        uint8_t base = channel * KINDS_PER_CHANNEL;
+        evaluate(base + (uint8_t)AlarmKind::LOW_LIMIT, limitCondition(base + (uint8_t)AlarmKind::LOW_LIMIT, valid, value),
+                 Constants::ALARM_DEBOUNCE, now);
+        evaluate(base + (uint8_t)AlarmKind::HIGH_LIMIT, limitCondition(base + (uint8_t)AlarmKind::HIGH_LIMIT, valid, value),
+                 Constants::ALARM_DEBOUNCE, now);
+        // Отсутствующий с момента старта датчик - не тревога, а конфигурация
+        evaluate(base + (uint8_t)AlarmKind::STALE, seen[channel] && !trusted,
+                 Constants::ALARM_STALE_TIMEOUT, now);
+    }
+
+    for (uint8_t rule = 0; rule < STUCK_RULES; rule++) {
+        evaluate(SENSOR_ALARMS + rule, stuckCondition(rule, data, now), 0, now);
+    }
+}
+
+bool AlarmEngine::addListener(Listener listener) {
+    if (listenerCount >= MAX_LISTENERS) return false;
+    listeners[listenerCount++] = listener;
+    return true;
+}
+
+bool AlarmEngine::acknowledge(uint8_t id) {
+    if (id >= ALARM_COUNT) return false;
+    unsigned long now = millis();
+    switch (alarms[id].state) {
+        case AlarmState::ACTIVE: setState(id, AlarmState::ACKNOWLEDGED, now); return true;
+        case AlarmState::LATCHED: setState(id, AlarmState::NORMAL, now); return true;
+        default: return false;
+    }
+}
+
+uint8_t AlarmEngine::acknowledgeAll() {
+    uint8_t count = 0;
+    for (uint8_t id = 0; id < ALARM_COUNT; id++) {
+        if (acknowledge(id)) count++;
+    }
+    return count;
+}
+
+uint8_t AlarmEngine::getActiveCount() const {
+    uint8_t count = 0;
+    for (const Alarm& alarm : alarms) {
+        if (alarm.state != AlarmState::NORMAL) count++;
+    }
+    return count;
+}
+
+uint8_t AlarmEngine::getUnacknowledgedCount() const {
+    uint8_t count = 0;
+    for (const Alarm& alarm : alarms) {
+        if (alarm.state == AlarmState::ACTIVE || alarm.state == AlarmState::LATCHED) count++;
+    }
+    return count;
+}
+
+uint8_t AlarmEngine::nextActive(uint8_t after) const {
+    uint8_t start = after < ALARM_COUNT ? after + 1 : 0;
+    for (uint8_t id = start; id < ALARM_COUNT; id++) {
+        if (alarms[id].state != AlarmState::NORMAL) return id;
+    }
+    return NONE;
+}
+
+// ===== Оценка =====
+// Мгновенное условие становится условием тревоги, продержавшись debounce
+void AlarmEngine::evaluate(uint8_t id, bool pending, unsigned long debounce, unsigned long now) {
+    Alarm& alarm = alarms[id];
+    if (pending != alarm.pending) {
+        alarm.pending = pending;
+        alarm.pendingSince = now;
+    }
+    if (alarm.pending == alarm.condition || now - alarm.pendingSince < debounce) return;
+
+    alarm.condition = alarm.pending;
+    if (alarm.condition) {
+        alarm.raised++;
+        if (alarm.state != AlarmState::ACKNOWLEDGED) setState(id, AlarmState::ACTIVE, now);
+    } else if (alarm.state == AlarmState::ACTIVE) {
+        setState(id, AlarmState::LATCHED, now);
+    } else if (alarm.state == AlarmState::ACKNOWLEDGED) {
+        setState(id, AlarmState::NORMAL, now);
+    }
+}
+
+void AlarmEngine::setState(uint8_t id, AlarmState state, unsigned long now) {
+    alarms[id].state = state;
+    alarms[id].since = now;
+
+    Name alarmName;
+    name(id, alarmName);
+    if (state == AlarmState::ACTIVE) {
+        LOG_WARN("🚨 Alarm %s: %s", alarmName.c_str(), stateName(state));
+    } else {
+        LOG_INFO("🔔 Alarm %s: %s", alarmName.c_str(), stateName(state));
+    }
+
+    for (uint8_t i = 0; i < listenerCount; i++) {
+        listeners[i](id, state);
+    }
+}
+
+// Порог с гистерезисом: выход из тревоги - только за полосой возврата.
+// Без значения условие сохраняется - пропажу канала сообщает STALE
+bool AlarmEngine::limitCondition(uint8_t id, bool valid, int32_t value) const {
+    uint8_t channel = id / KINDS_PER_CHANNEL;
+    bool current = alarms[id].pending;
+    if (!valid) return current;
+
+    int32_t hysteresis = current ? LIMITS[channel].hysteresis : 0;
+    if (kindOf(id) == AlarmKind::LOW_LIMIT) {
+        return lowEnabled[channel] && value < lowRaw[channel] + hysteresis;
+    }
+    return highEnabled[channel] && value > highRaw[channel] - hysteresis;
+}
+
+bool AlarmEngine::stuckCondition(uint8_t rule, const SensorData& data, unsigned long now) {
+    const StuckRule& config = STUCK[rule];
+    StuckTracker& tracker = stuck[rule];
+
+    bool valid;
+    int32_t value = LIMITS[(uint8_t)config.channel].read(data, valid);
+    if (deviceManager.getChannelValue(config.device) == 0 || !valid) {
+        tracker.active = false;
+        return false;
+    }
+
+    if (!tracker.active) {
+        tracker.active = true;
+        tracker.reacted = false;
+        tracker.baseline = value;
+        tracker.start = now;
+        return false;
+    }
+
+    // Однажды отреагировавший выход исправен до следующего включения
+    if (value - tracker.baseline >= config.minRise) tracker.reacted = true;
+    return !tracker.reacted && now - tracker.start >= config.window;
+}
+
+// ===== Имена =====
+AlarmKind AlarmEngine::kindOf(uint8_t id) {
+    return id < SENSOR_ALARMS ? (AlarmKind)(id % KINDS_PER_CHANNEL) : AlarmKind::STUCK;
+}
+
+SensorChannel AlarmEngine::channelOf(uint8_t id) {
+    return id < SENSOR_ALARMS ? (SensorChannel)(id / KINDS_PER_CHANNEL) : STUCK[id - SENSOR_ALARMS].channel;
+}
+
+ControlDevice AlarmEngine::deviceOf(uint8_t id) {
+    return id >= SENSOR_ALARMS && id < ALARM_COUNT ? STUCK[id - SENSOR_ALARMS].device : ControlDevice::UNKNOWN;
+}
+
+// "airTemperature.high", "heater.stuck"
+void AlarmEngine::name(uint8_t id, Name& out) {
+    out.clear();
+    if (kindOf(id) == AlarmKind::STUCK) {
+        out += DeviceNames::name(deviceOf(id));
+    } else {
+        out += SensorFusion::channelName(channelOf(id));
+    }
+    out += '.';
+    out += kindName(kindOf(id));
+}
+
+uint8_t AlarmEngine::find(StringView alarmName) {
+    Name candidate;
+    for (uint8_t id = 0; id < ALARM_COUNT; id++) {
+        name(id, candidate);
+        if (candidate == alarmName) return id;
+    }
+    return NONE;
+}
+
+const char* AlarmEngine::kindName(AlarmKind kind) {
+    switch (kind) {
+        case AlarmKind::LOW_LIMIT: return "low";
+        case AlarmKind::HIGH_LIMIT: return "high";
+        case AlarmKind::STALE: return "stale";
+        case AlarmKind::STUCK: return "stuck";
+    }
+    return "unknown";
+}
+
+const char* AlarmEngine::stateName(AlarmState state) {
+    switch (state) {
+        case AlarmState::NORMAL: return "normal";
+        case AlarmState::ACTIVE: return "active";
+        case AlarmState::ACKNOWLEDGED: return "acknowledged";
+        case AlarmState::LATCHED: return "latched";
+    }
+    return "unknown";
+}
+
+bool AlarmEngine::thresholdInRange(SensorChannel channel, float value) {
+    if (channel >= SensorChannel::COUNT) return false;
+    const ChannelLimits& limit = LIMITS[(uint8_t)channel];
+    return isnan(value) || (value >= limit.minValue && value <= limit.maxValue);
+}
@@ -0,0 +1,105 @@
+#ifndef ALARM_ENGINE_H
+#define ALARM_ENGINE_H
+
+#include "Config.h"
+#include "DeviceNames.h"
+#include "SensorFusion.h"
+
+static_assert(sizeof(SystemSettings::alarmLow) / sizeof(float) == (size_t)SensorChannel::COUNT,
+              "Alarm thresholds must cover SensorChannel");
+
+enum class AlarmKind : uint8_t {
+    LOW_LIMIT,
+    HIGH_LIMIT,
+    STALE,      // канал был исправен, но давно не дает значений
+    STUCK       // выход включен, а связанное показание не реагирует
+};
+
+// NORMAL -> ACTIVE (условие выполнено) -> ACKNOWLEDGED (подтверждена, условие держится)
+// ACTIVE -> LATCHED (условие ушло, но тревога не подтверждена) -> NORMAL после подтверждения
+enum class AlarmState : uint8_t {
+    NORMAL,
+    ACTIVE,
+    ACKNOWLEDGED,
+    LATCHED
+};
+
+// Тревоги фиксированного набора: три на каждый канал датчиков и по одной
+// на каждое правило залипания выхода. Оценка - один проход по массиву
+// состояний, без выделения памяти. Смена состояния рассылается слушателям
+// (MQTT и т.п.); дисплей, матрица и API опрашивают состояния сами.
+class AlarmEngine {
+public:
+    static constexpr uint8_t KINDS_PER_CHANNEL = 3;
+    static constexpr uint8_t SENSOR_ALARMS = (uint8_t)SensorChannel::COUNT * KINDS_PER_CHANNEL;
+    static constexpr uint8_t STUCK_RULES = 2;
+    static constexpr uint8_t ALARM_COUNT = SENSOR_ALARMS + STUCK_RULES;
+    static constexpr uint8_t MAX_LISTENERS = 4;
+    static constexpr uint8_t NONE = 0xFF;
+
+    using Listener = void (*)(uint8_t id, AlarmState state);
+    using Name = FixedString<32>;
+
+    // Пороги из настроек переводятся в единицы каналов один раз
+    void configure(const SystemSettings& settings);
+    void update(const SensorData& data);
+    bool addListener(Listener listener);
+
+    bool acknowledge(uint8_t id);
+    uint8_t acknowledgeAll();
+
+    AlarmState getState(uint8_t id) const { return alarms[id].state; }
+    unsigned long getSince(uint8_t id) const { return alarms[id].since; }
+    uint32_t getRaiseCount(uint8_t id) const { return alarms[id].raised; }
+    uint8_t getActiveCount() const;
+    uint8_t getUnacknowledgedCount() const;
+    // Следующая после after тревога не в NORMAL (NONE - таких нет)
+    uint8_t nextActive(uint8_t after) const;
+
+    static AlarmKind kindOf(uint8_t id);
+    static SensorChannel channelOf(uint8_t id);
+    static ControlDevice deviceOf(uint8_t id);
+    static void name(uint8_t id, Name& out);
+    static uint8_t find(StringView name);
+    static const char* kindName(AlarmKind kind);
+    static const char* stateName(AlarmState state);
+    static bool thresholdInRange(SensorChannel channel, float value);
+
+private:
+    struct Alarm {
+        AlarmState state = AlarmState::NORMAL;
+        bool condition = false;         // условие после антидребезга
+        bool pending = false;           // мгновенное условие
+        unsigned long pendingSince = 0;
+        unsigned long since = 0;        // последняя смена state
+        uint32_t raised = 0;
+    };
+
+    struct StuckTracker {
+        bool active = false;
+        bool reacted = false;
+        int32_t baseline = 0;
+        unsigned long start = 0;
+    };
+
+    void evaluate(uint8_t id, bool pending, unsigned long debounce, unsigned long now);
+    void setState(uint8_t id, AlarmState state, unsigned long now);
+    bool limitCondition(uint8_t id, bool valid, int32_t value) const;
+    bool stuckCondition(uint8_t rule, const SensorData& data, unsigned long now);
+
+    Alarm alarms[ALARM_COUNT];
+    StuckTracker stuck[STUCK_RULES];
+
+    // Пороги в единицах канала; disabled - порог не задан
+    int32_t lowRaw[(uint8_t)SensorChannel::COUNT] = {};
+    int32_t highRaw[(uint8_t)SensorChannel::COUNT] = {};
+    bool lowEnabled[(uint8_t)SensorChannel::COUNT] = {};
+    bool highEnabled[(uint8_t)SensorChannel::COUNT] = {};
+    bool seen[(uint8_t)SensorChannel::COUNT] = {};
+
+    Listener listeners[MAX_LISTENERS] = {};
+    uint8_t listenerCount = 0;
+    unsigned long lastUpdate = 0;
+};
+
+#endif
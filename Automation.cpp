@@ -1,87 +1,129 @@
 #include "Automation.h"
 #include "Config.h"
-#include "GlobalInstances.h"
+#include "Logger.h"
 
-void Automation::process(const SensorData& data, const SystemSettings& settings, DeviceManager& devices) {
+void Automation::process(const SensorData& data, const SystemSettings& settings, Actuators& devices, unsigned long now) {
     if (!settings.automationEnabled) return;
     
-    controlTemperature(data, settings, devices);
-    controlHumidity(data, settings, devices);
-    controlSoilMoisture(data, settings, devices);
+    // При открытой двери обогрев и вентиляция работали бы на улицу
+    if (!data.doorState) {
+        controlTemperature(data, settings, devices);
+        controlHumidity(data, settings, devices);
+        controlVentilation(data, settings, devices);
+    }
+    controlSoilMoisture(data, settings, devices, now);
     controlLighting(data, settings, devices);
-    controlVentilation(data, settings, devices);
 }
 
-void Automation::controlTemperature(const SensorData& data, const SystemSettings& settings, DeviceManager& devices) {
-    if (isnan(data.airTemperature)) return;
+void Automation::onDoorChanged(bool open, Actuators& devices) {
+    if (open) {
+        devices.controlHeater(false, ControlCause::AUTOMATION);
+        devices.controlFan(false, ControlCause::AUTOMATION);
+    }
+    if (!logging) return;
+    if (open) {
+        LOG_INFO("🚪 Door open - heating and ventilation paused");
+    } else {
+        LOG_INFO("🚪 Door closed - climate control resumes on next cycle");
+    }
+}
+
+// Пороги в фиксированной точке: сравнения целочисленные
+static constexpr Temperature TEMP_HYSTERESIS = Temperature::fromFloat(1.0);
+static constexpr Percent HUMIDITY_HYSTERESIS = Percent::fromFloat(5.0);
+static constexpr Percent SOIL_MOISTURE_MARGIN = Percent::fromFloat(5.0);
+static constexpr Temperature VENTILATION_TEMP = Temperature::fromFloat(28.0);
+static constexpr Percent VENTILATION_HUMIDITY = Percent::fromFloat(70.0);
+
+// Канал с недостаточной достоверностью не управляет выходами
+bool Automation::trusted(SensorChannel channel) const {
+    return fusion->getConfidence(channel) >= Constants::FUSION_MIN_CONFIDENCE;
+}
+
+void Automation::controlTemperature(const SensorData& data, const SystemSettings& settings, Actuators& devices) {
+    // Без достоверной температуры обогрев и вентиляция выключаются, а не
+    // остаются в последнем состоянии: обогреватель не должен греть вслепую
+    bool reliable = data.airTemperature.isValid() && trusted(SensorChannel::AIR_TEMPERATURE);
+    if (reliable != temperatureReliable && logging) {
+        if (reliable) {
+            LOG_INFO("✅ Air temperature trusted again - climate control resumes");
+        } else {
+            LOG_WARN("⚠️ Air temperature untrusted - heater and fan off");
+        }
+    }
+    temperatureReliable = reliable;
+    if (!reliable) {
+        devices.controlHeater(false, ControlCause::AUTOMATION);
+        devices.controlFan(false, ControlCause::AUTOMATION);
+        return;
+    }
     
-    float temp = data.airTemperature;
-    float setpoint = settings.tempSetpoint;
-    float hysteresis = 1.0;
+    Temperature temp = data.airTemperature;
+    Temperature setpoint = Temperature::fromFloat(settings.tempSetpoint);
+    Temperature hysteresis = TEMP_HYSTERESIS;
     
     if (temp > setpoint + hysteresis) {
         // Too hot - turn on fan, turn off heater
-        devices.controlFan(true);
-        devices.controlHeater(false);
+        devices.controlFan(true, ControlCause::AUTOMATION);
+        devices.controlHeater(false, ControlCause::AUTOMATION);
     } else if (temp < setpoint - hysteresis) {
         // Too cold - turn on heater, turn off fan
-        devices.controlHeater(true);
-        devices.controlFan(false);
+        devices.controlHeater(true, ControlCause::AUTOMATION);
+        devices.controlFan(false, ControlCause::AUTOMATION);
     } else {
         // Within range - turn both off
-        devices.controlFan(false);
-        devices.controlHeater(false);
+        devices.controlFan(false, ControlCause::AUTOMATION);
+        devices.controlHeater(false, ControlCause::AUTOMATION);
     }
 }
 
-void Automation::controlHumidity(const SensorData& data, const SystemSettings& settings, DeviceManager& devices) {
-    if (isnan(data.airHumidity)) return;
+void Automation::controlHumidity(const SensorData& data, const SystemSettings& settings, Actuators& devices) {
+    if (!data.airHumidity.isValid() || !trusted(SensorChannel::AIR_HUMIDITY)) return;
     
-    float humidity = data.airHumidity;
-    float setpoint = settings.humSetpoint;
-    float hysteresis = 5.0;
+    Percent humidity = data.airHumidity;
+    Percent setpoint = Percent::fromFloat(settings.humSetpoint);
+    Percent hysteresis = HUMIDITY_HYSTERESIS;
     
     if (humidity > setpoint + hysteresis) {
         // Too humid - increase ventilation
-        devices.controlFan(true);
+        devices.controlFan(true, ControlCause::AUTOMATION);
     } else if (humidity < setpoint - hysteresis) {
         // Too dry -可以考虑 добавить увлажнитель в будущем
-        devices.controlFan(false);
+        devices.controlFan(false, ControlCause::AUTOMATION);
     }
 }
 
-void Automation::controlSoilMoisture(const SensorData& data, const SystemSettings& settings, DeviceManager& devices) {
-    if (isnan(data.soilMoisture)) return;
-    
-    float moisture = data.soilMoisture;
-    float setpoint = settings.soilMoistureSetpoint;
-    unsigned long currentTime = millis();
+void Automation::controlSoilMoisture(const SensorData& data, const SystemSettings& settings, Actuators& devices, unsigned long now) {
+    if (!data.soilMoisture.isValid() || !trusted(SensorChannel::SOIL_MOISTURE)) return;
     
+    Percent moisture = data.soilMoisture;
+    Percent setpoint = Percent::fromFloat(settings.soilMoistureSetpoint);
     // Проверяем, нужно ли поливать и прошло ли достаточно времени с последнего полива
-    if (moisture < setpoint - 5.0 && (currentTime - lastPumpRun) > PUMP_COOLDOWN) {
+    if (moisture < setpoint - SOIL_MOISTURE_MARGIN && (now - lastPumpRun) > PUMP_COOLDOWN) {
         // Полив в течение 5 секунд
-        devices.controlPump(true, 5000);
-        lastPumpRun = currentTime;
-        Serial.println("💧 Automated watering started");
+        devices.controlPump(true, ControlCause::AUTOMATION, Constants::PUMP_DURATION);
+        lastPumpRun = now;
+        if (logging) LOG_INFO("💧 Automated watering started");
     }
 }
 
-void Automation::controlLighting(const SensorData& data, const SystemSettings& settings, DeviceManager& devices) {
+void Automation::controlLighting(const SensorData& data, const SystemSettings& settings, Actuators& devices) {
     // Простое управление по времени (можно улучшить с учетом освещенности)
     int currentHour = 12; // В реальности получать из NTPClient
     
     if (currentHour >= settings.lightOnHour && currentHour < settings.lightOffHour) {
-        devices.controlLight(true);
+        devices.controlLight(true, ControlCause::AUTOMATION);
     } else {
-        devices.controlLight(false);
+        devices.controlLight(false, ControlCause::AUTOMATION);
     }
 }
 
-void Automation::controlVentilation(const SensorData& data, const SystemSettings& settings, DeviceManager& devices) {
+void Automation::controlVentilation(const SensorData& data, const SystemSettings& settings, Actuators& devices) {
     // Дополнительная вентиляция при высокой температуре и влажности
-    if (!isnan(data.airTemperature) && !isnan(data.airHumidity)) {
-        if (data.airTemperature > 28.0 && data.airHumidity > 70.0) {
-            devices.controlFan(true);
+    if (data.airTemperature.isValid() && data.airHumidity.isValid() &&
+        trusted(SensorChannel::AIR_TEMPERATURE) && trusted(SensorChannel::AIR_HUMIDITY)) {
+        if (data.airTemperature > VENTILATION_TEMP && data.airHumidity > VENTILATION_HUMIDITY) {
+            devices.controlFan(true, ControlCause::AUTOMATION);
         }
     }
 }
\ No newline at end of file
@@ -2,21 +2,35 @@
 #define AUTOMATION_H
 
 #include "Config.h"
-#include "DeviceManager.h"
+#include "Actuators.h"
+#include "SensorFusion.h"
 
+// Решения принимаются только по данным, настройкам, достоверности каналов
+// и переданному времени, поэтому тот же код воспроизводит записанные трассы.
 class Automation {
 public:
-    void process(const SensorData& data, const SystemSettings& settings, DeviceManager& devices);
+    explicit Automation(const SensorFusion& fusion) : fusion(&fusion) {}
+
+    void process(const SensorData& data, const SystemSettings& settings, Actuators& devices, unsigned long now);
+    void onDoorChanged(bool open, Actuators& devices);
+    void setLogging(bool enabled) { logging = enabled; }
+    // Воспроизведение трассы: время последнего полива на устройстве
+    void setLastPumpRun(unsigned long time) { lastPumpRun = time; }
+    
+    static constexpr unsigned long PUMP_COOLDOWN = 300000; // 5 minutes
     
 private:
-    void controlTemperature(const SensorData& data, const SystemSettings& settings, DeviceManager& devices);
-    void controlHumidity(const SensorData& data, const SystemSettings& settings, DeviceManager& devices);
-    void controlSoilMoisture(const SensorData& data, const SystemSettings& settings, DeviceManager& devices);
-    void controlLighting(const SensorData& data, const SystemSettings& settings, DeviceManager& devices);
-    void controlVentilation(const SensorData& data, const SystemSettings& settings, DeviceManager& devices);
+    void controlTemperature(const SensorData& data, const SystemSettings& settings, Actuators& devices);
+    void controlHumidity(const SensorData& data, const SystemSettings& settings, Actuators& devices);
+    void controlSoilMoisture(const SensorData& data, const SystemSettings& settings, Actuators& devices, unsigned long now);
+    void controlLighting(const SensorData& data, const SystemSettings& settings, Actuators& devices);
+    void controlVentilation(const SensorData& data, const SystemSettings& settings, Actuators& devices);
+    bool trusted(SensorChannel channel) const;
     
+    const SensorFusion* fusion;
+    bool logging = true;
+    bool temperatureReliable = true;
     unsigned long lastPumpRun = 0;
-    const unsigned long PUMP_COOLDOWN = 300000; // 5 minutes
 };
 
-#endif
\ No newline at end of file
+#endif
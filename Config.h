@@ -2,10 +2,34 @@
 #define CONFIG_H
 
 #include <Arduino.h>
+#include "FixedString.h"
+#include "FixedPoint.h"
 
 // Версия конфигурации для миграции EEPROM
-#define CONFIG_VERSION 3
-#define EEPROM_SIZE 512
+#define CONFIG_VERSION 9
+#define EEPROM_SIZE 1024
+
+// Уровень журналирования: вызовы ниже уровня не компилируются
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+// Профилирование горячих участков (0 - код замеров не компилируется)
+#ifndef ENABLE_PROFILING
+#define ENABLE_PROFILING 1
+#endif
+
+// Задача управления на ядре 1 и сетевая задача на ядре 0
+// (0 - прежний единый loop(), для сравнения джиттера)
+#ifndef ENABLE_CONTROL_TASK
+#define ENABLE_CONTROL_TASK 1
+#endif
 
 // ===== Структуры для хранения данных =====
 struct SystemSettings {
@@ -20,20 +44,49 @@ struct SystemSettings {
   bool automationEnabled = true;
   uint8_t displayBrightness = 7;
   bool use24HourFormat = true;
+  
+  // Телеметрия по UDP (с версии 4)
+  bool telemetryEnabled = false;
+  uint16_t telemetryPort = 4210;
+  uint16_t telemetryInterval = 10;  // секунды
+  
+  // MQTT брокер (с версии 5)
+  bool mqttEnabled = false;
+  char mqttHost[40] = "";
+  uint16_t mqttPort = 1883;
+  
+  // Номинальные мощности выходов и расход насоса для учета потребления (с версии 6)
+  uint16_t pumpPowerW = 25;
+  uint16_t fanPowerW = 15;
+  uint16_t heaterPowerW = 500;
+  uint16_t lightPowerW = 60;      // при полной яркости
+  uint16_t pumpFlowRate = 1500;   // мл/мин
+  
+  // Профиль фитосвета LED матрицы, GrowProfile (с версии 7)
+  uint8_t growProfile = 0;
+  
+  // Пороги тревог по каналам в порядке SensorChannel, NAN - порог отключен (с версии 8)
+  // Воздух t, влажность, давление, почва t, влажность почвы, освещенность
+  float alarmLow[6] = {5.0, 20.0, NAN, 2.0, 15.0, NAN};
+  float alarmHigh[6] = {40.0, 95.0, NAN, 35.0, NAN, NAN};
+  
+  // Пониженное потребление: сон между циклами, датчики в разовых измерениях (с версии 9)
+  bool lowPowerMode = false;
 };
 
 struct SensorData {
+  // Показания в фиксированной точке; по умолчанию - "нет данных"
   // Воздух
-  float airTemperature = NAN;
-  float airHumidity = NAN;
-  float pressure = NAN;
+  Temperature airTemperature;
+  Percent airHumidity;
+  Pressure pressure;
   
   // Почва
-  float soilTemperature = NAN;
-  float soilMoisture = NAN;
+  Temperature soilTemperature;
+  Percent soilMoisture;
   
   // Свет
-  float lightLevel = NAN;
+  Illuminance lightLevel;
   
   // Состояния устройств
   bool pumpState = false;
@@ -44,7 +97,7 @@ struct SensorData {
   
   // Статус системы
   bool systemHealthy = true;
-  String lastError = "";
+  FixedString<48> lastError;
 };
 
 struct DeviceConfig {
@@ -59,9 +112,9 @@ struct DeviceConfig {
   bool hasSoilSensors = false;
   bool hasRelays = true;
   
-  // Калибровочные значения
-  float soilAirValue = 2800.0;
-  float soilWaterValue = 1200.0;
+  // Калибровочные значения (отсчеты АЦП)
+  uint16_t soilAirValue = 2800;
+  uint16_t soilWaterValue = 1200;
   
   // Статусы устройств
   bool bme280Healthy = false;
@@ -83,6 +136,10 @@ namespace Pins {
   constexpr uint8_t SOIL_TEMPERATURE = 35;
   constexpr uint8_t DOOR_SENSOR = 12;
   
+  // Шина I2C
+  constexpr uint8_t I2C_SDA = 21;
+  constexpr uint8_t I2C_SCL = 22;
+  
   // Дисплей
   constexpr uint8_t TM1637_CLK = 15;
   constexpr uint8_t TM1637_DIO = 14;
@@ -99,13 +156,105 @@ namespace Constants {
   constexpr uint16_t NUM_LEDS = 64;
   constexpr uint16_t SOIL_ADC_MAX = 4095;
   constexpr float SOIL_TEMP_CONVERSION = 6.27;
-  constexpr unsigned long SERVO_DELAY = 1000;
+  // Температура почвы = отсчет * SOIL_TEMP_FULL_SCALE / SOIL_ADC_MAX - SOIL_TEMP_OFFSET (0.01 °C)
+  constexpr int32_t SOIL_TEMP_FULL_SCALE = (int32_t)(SOIL_TEMP_CONVERSION * 10000 + 0.5);
+  constexpr int32_t SOIL_TEMP_OFFSET = 5000;
+  constexpr unsigned long SERVO_DELAY = 1000;           // время поворота сервопривода
   constexpr unsigned long PUMP_DURATION = 5000;
+  constexpr unsigned long PUMP_MAX_DURATION = 600000;     // 10 минут
+  constexpr unsigned long OUTPUT_MAX_DURATION = 86400000; // 24 часа
+  constexpr uint8_t LED_DEFAULT_BRIGHTNESS = 50;
+  constexpr uint8_t DOOR_NEUTRAL_ANGLE = 90;
+  constexpr uint8_t MAX_BATCH_COMMANDS = 8;
+  
+  // MQTT
+  constexpr unsigned long MQTT_PUBLISH_INTERVAL = 30000;
+  constexpr unsigned long MQTT_RECONNECT_MIN = 5000;
+  constexpr unsigned long MQTT_RECONNECT_MAX = 300000;
+  constexpr uint8_t MQTT_SOCKET_TIMEOUT = 2;     // секунды
+  constexpr uint8_t MQTT_FLUSH_BATCH = 4;        // сообщений за один вызов update()
+  
+  // Шина I2C
+  constexpr uint16_t I2C_PROBE_TIMEOUT_MS = 10;
+  constexpr uint16_t I2C_DEFAULT_TIMEOUT_MS = 50;
+  constexpr uint8_t I2C_SCAN_BATCH = 8;
+  constexpr unsigned long I2C_RESCAN_INTERVAL = 300000;
+  
+  // Учет энергии и воды
+  constexpr unsigned long ENERGY_SAMPLE_INTERVAL = 1000;
+  constexpr unsigned long ENERGY_SAVE_INTERVAL = 3600000;  // 1 час - щадящий режим для flash
+  constexpr unsigned long ENERGY_DAY_MS = 86400000;
+  constexpr uint16_t MAX_RATED_POWER = 5000;     // Вт
+  constexpr uint16_t MAX_PUMP_FLOW = 20000;      // мл/мин
+  
+  // Фильтрация показаний
+  constexpr uint8_t FUSION_MIN_CONFIDENCE = 50;      // ниже - автоматика не реагирует на канал
+  constexpr uint8_t FUSION_CROSS_CHECK_CONFIDENCE = 25;  // потолок при расхождении воздуха и почвы
+  constexpr Temperature FUSION_MAX_AIR_SOIL_DELTA = Temperature::fromFloat(15.0);
+  
+  // Индикатор
+  constexpr unsigned long DISPLAY_FRAME_INTERVAL = 100;    // шаг таймера кадров
+  constexpr unsigned long DISPLAY_REFRESH_INTERVAL = 1000; // обновление значения неподвижной страницы
+  constexpr unsigned long DISPLAY_PAGE_DWELL = 3000;
+  constexpr unsigned long DISPLAY_SCROLL_HOLD = 800;       // пауза перед прокруткой и после нее
+  constexpr unsigned long DISPLAY_SCROLL_STEP = 300;       // сдвиг на одно знакоместо
+  
+  // LED матрица
+  constexpr unsigned long LED_FRAME_INTERVAL = 50;   // минимальный интервал кадров
+  constexpr uint8_t LED_MAX_DUTY_PERCENT = 5;        // доля времени на FastLED.show()
+  constexpr uint8_t LED_STATUS_BRIGHTNESS = 32;      // индикация не слепит
+  constexpr unsigned long LED_ALARM_BLINK = 1000;
+  // При включенном фитосвете тревога видна угловым значком поверх него
+  constexpr uint8_t LED_ALARM_OVERLAY = 2;           // сторона углового значка, пиксели
+  constexpr uint16_t LED_LIGHT_FULL_SCALE = 2000;    // лк - полный столбец освещенности
+  
+  // Датчик двери
+  constexpr uint32_t DOOR_DEBOUNCE_MS = 50;
+  
+  // Тревоги
+  constexpr unsigned long ALARM_EVALUATE_INTERVAL = 1000;
+  constexpr unsigned long ALARM_DEBOUNCE = 60000;        // условие держится 2 опроса датчиков
+  constexpr unsigned long ALARM_STALE_TIMEOUT = 300000;  // 5 минут без достоверных значений
+  
+  // Питание
+  constexpr unsigned long POWER_MAX_SLEEP_MS = 250;      // предел задержки ответа на HTTP
+  constexpr unsigned long POWER_MIN_SLEEP_MS = 5;        // короче - вход в сон дороже выигрыша
+  constexpr unsigned long POWER_NETWORK_HOLD_MS = 2000;  // без сна после сетевого запроса
+  constexpr int POWER_MAX_CPU_MHZ = 160;
+  constexpr int POWER_MIN_CPU_MHZ = 40;
+  // Оценка тока потребления модуля, мА
+  constexpr float POWER_ACTIVE_MA = 100.0;        // CPU и Wi-Fi без сна
+  constexpr float POWER_MODEM_SLEEP_MA = 40.0;    // CPU активен, модем спит между маяками
+  constexpr float POWER_LIGHT_SLEEP_MA = 2.0;     // light sleep с пробуждениями на маяки
+  
+  // Задачи
+  constexpr unsigned long CONTROL_PERIOD_MS = 20;        // период цикла управления
+  // Худший цикл: опрос датчиков с таймаутами I2C и восстановлением шины
+  constexpr unsigned long CONTROL_WORST_CYCLE_MS = 150;
+  constexpr unsigned long CONTROL_STATUS_INTERVAL = 500; // снимок состояния для сети без запросов
+  constexpr uint8_t CONTROL_TASK_CORE = 1;
+  constexpr uint8_t CONTROL_TASK_PRIORITY = 5;   // выше loopTask и сетевой задачи
+  constexpr uint32_t CONTROL_TASK_STACK = 6144;
+  constexpr uint8_t NETWORK_TASK_CORE = 0;       // вместе со стеком Wi-Fi/lwIP
+  constexpr uint8_t NETWORK_TASK_PRIORITY = 1;
+  constexpr uint32_t NETWORK_TASK_STACK = 8192;
+  
+  // Трасса для воспроизведения автоматики
+  constexpr uint16_t TRACE_CAPACITY = 512;       // записей в ОЗУ: ~4 ч опросов, 10 КБ
+  
+  // Мониторинг кучи
+  constexpr unsigned long HEAP_SAMPLE_INTERVAL = 60000;
+  // Окно тренда: снимки сводятся в интервалы по 2 ч (минимум за интервал),
+  // 60 интервалов - 5 суток; медленная фрагментация за час не видна
+  constexpr uint8_t HEAP_SAMPLES_PER_BUCKET = 120;
+  constexpr uint8_t HEAP_TREND_MIN_BUCKETS = 12;  // решение не раньше чем через сутки
+  constexpr float HEAP_TREND_WARN = 256.0;  // байт/час уменьшения наибольшего блока
 }
 
 // ===== Глобальные экземпляры =====
 extern SystemSettings systemSettings;
-extern SensorData sensorData;
+extern SensorData sensorData;     // пишет только цикл управления
+extern SensorData sensorView;     // снимок sensorData для сетевой стороны
 extern DeviceConfig deviceConfig;
 
 #endif
\ No newline at end of file
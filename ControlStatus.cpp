@@ -0,0 +1,65 @@
+#include "ControlStatus.h"
+#include "ControlTask.h"
+#include "GlobalInstances.h"
+
+void ControlStatus::capture() {
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice device = DeviceManager::getChannel(i).id;
+        channelValue[(uint8_t)device] = deviceManager.getChannelValue(device);
+        channelRemainingMs[(uint8_t)device] = deviceManager.getChannelRemainingMs(device);
+    }
+    history = deviceManager.getHistory();
+
+    devices = deviceConfig;
+    deviceCount = deviceManager.getDeviceCount();
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        deviceStatus[i] = deviceManager.getDeviceStatus(i);
+    }
+    soilState = deviceManager.getSoilState();
+    i2cStatsCount = i2cBus.getStatsCount();
+    for (uint8_t i = 0; i < i2cStatsCount; i++) {
+        i2cStats[i] = i2cBus.getStats(i);
+    }
+    i2cStuckCount = i2cBus.getStuckCount();
+    i2cRecoveryCount = i2cBus.getRecoveryCount();
+    i2cTimeoutCount = i2cBus.getTimeoutCount();
+
+    alarms = alarmEngine;
+    energy = energyMeter;
+    door.openCount = doorMonitor.getOpenCount();
+    door.totalOpenMs = doorMonitor.getTotalOpenMs();
+    door.lastOpenMs = doorMonitor.getLastOpenMs();
+    door.longestOpenMs = doorMonitor.getLongestOpenMs();
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        confidence[i] = sensorFusion.getConfidence((SensorChannel)i);
+        rejected[i] = sensorFusion.getRejectedCount((SensorChannel)i);
+    }
+    crossCheckFailed = sensorFusion.isCrossCheckFailed();
+
+    jitterUs = controlTask.getJitter();
+    cycleUs = controlTask.getCycleTime();
+    overruns = controlTask.getOverruns();
+    for (uint8_t i = 0; i < (uint8_t)PowerDomain::COUNT; i++) {
+        controlAwakeMicros[i] = powerManager.getAwakeMicros((PowerDomain)i, Constants::CONTROL_TASK_CORE);
+    }
+}
+
+uint64_t ControlStatus::awakeMicros(PowerDomain domain) const {
+    return controlAwakeMicros[(uint8_t)domain] + powerManager.getAwakeMicros(domain, Constants::NETWORK_TASK_CORE);
+}
+
+FixedString<384> ControlStatus::deviceSummary() const {
+    FixedString<384> summary("=== Device Summary ===\n");
+    if (!devices.hasBME280) summary += "BME280: Missing [ERROR]\n";
+    if (!devices.hasBH1750) summary += "BH1750: Missing [ERROR]\n";
+    for (uint8_t i = 0; i < deviceCount; i++) {
+        const DeviceManager::DeviceStatus& device = deviceStatus[i];
+        summary.appendf("%s @0x%02X: Present [%s]\n", device.name, device.address,
+                        DeviceHealth::stateName(device.state));
+    }
+    summary.appendf("Soil Sensors: %s [%s]\n", devices.hasSoilSensors ? "Present" : "Missing",
+                    devices.hasSoilSensors ? DeviceHealth::stateName(soilState) : "ERROR");
+    summary += "TM1637: Present [OK]\n";
+    summary += "Relays: Present [OK]\n";
+    return summary;
+}
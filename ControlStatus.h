@@ -0,0 +1,71 @@
+#ifndef CONTROL_STATUS_H
+#define CONTROL_STATUS_H
+
+#include "Config.h"
+#include "ActuatorHistory.h"
+#include "AlarmEngine.h"
+#include "DeviceManager.h"
+#include "EnergyMeter.h"
+#include "I2CBus.h"
+#include "LatencyHistogram.h"
+#include "PowerManager.h"
+#include "SensorFusion.h"
+
+// Состояние управления для сетевой стороны. Цикл управления заполняет его
+// в снимке (seqlock) после запросов и раз в CONTROL_STATUS_INTERVAL; HTTP,
+// метрики, MQTT и индикатор читают копию statusView и не обращаются к
+// объектам управления. Журнал выходов, тревоги и учет энергии не держат
+// внешних ресурсов и копируются целиком - читатели пользуются их методами.
+struct ControlStatus {
+    static constexpr uint8_t DEVICE_COUNT = (uint8_t)ControlDevice::UNKNOWN;
+
+    struct DoorStats {
+        uint32_t openCount = 0;
+        uint32_t totalOpenMs = 0;   // с учетом текущего открытия
+        uint32_t lastOpenMs = 0;
+        uint32_t longestOpenMs = 0;
+    };
+
+    // Выходы
+    int16_t channelValue[DEVICE_COUNT] = {};
+    unsigned long channelRemainingMs[DEVICE_COUNT] = {};
+    ActuatorHistory history;
+
+    // Устройства и шина I2C
+    DeviceConfig devices;
+    uint8_t deviceCount = 0;
+    DeviceManager::DeviceStatus deviceStatus[DeviceManager::MAX_ATTACHED_DEVICES] = {};
+    DeviceHealth::State soilState = DeviceHealth::State::HEALTHY;
+    uint8_t i2cStatsCount = 0;
+    I2CBus::AddressStats i2cStats[I2CBus::MAX_TRACKED_ADDRESSES] = {};
+    uint32_t i2cStuckCount = 0;
+    uint32_t i2cRecoveryCount = 0;
+    uint32_t i2cTimeoutCount = 0;
+
+    // Тревоги, учет, дверь, фильтрация
+    AlarmEngine alarms;
+    EnergyMeter energy;
+    DoorStats door;
+    uint8_t confidence[(uint8_t)SensorChannel::COUNT] = {};
+    uint32_t rejected[(uint8_t)SensorChannel::COUNT] = {};
+    bool crossCheckFailed = false;
+
+    // Цикл управления
+    LatencyHistogram<24> jitterUs;
+    LatencyHistogram<24> cycleUs;
+    uint32_t overruns = 0;
+    uint64_t controlAwakeMicros[(uint8_t)PowerDomain::COUNT] = {};  // ядро управления
+
+    // Время бодрствования подсистемы на обоих ядрах: ядро управления - из
+    // снимка, сетевое - на месте (вызывать только на сетевой стороне)
+    uint64_t awakeMicros(PowerDomain domain) const;
+
+    // Заполнение из объектов управления - только в цикле управления
+    void capture();
+
+    FixedString<384> deviceSummary() const;
+};
+
+extern ControlStatus statusView;    // копия для сетевой стороны
+
+#endif
@@ -0,0 +1,234 @@
+#include "ControlTask.h"
+#include "GlobalInstances.h"
+#include "Logger.h"
+#include "PowerManager.h"
+
+ControlTask controlTask;
+
+void ControlTask::begin(Cycle control, Cycle network) {
+    controlCycle = control;
+    networkCycle = network;
+    // В режиме пониженного потребления цикл реже, чтобы чип успевал уснуть
+    periodMs = systemSettings.lowPowerMode ? Constants::POWER_MAX_SLEEP_MS : Constants::CONTROL_PERIOD_MS;
+    sensors.publish(sensorData);
+    publishStatus();
+    readSnapshots();
+
+#if ENABLE_CONTROL_TASK
+    // Запросы сетевой стороны идут через кольцо с момента ее создания
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreatePinnedToCore(controlTaskMain, "control", Constants::CONTROL_TASK_STACK, this,
+                                Constants::CONTROL_TASK_PRIORITY, &handle, Constants::CONTROL_TASK_CORE) == pdPASS) {
+        controlHandle = handle;
+        tasked = true;
+        if (systemSettings.lowPowerMode) powerManager.setDoorTask(controlHandle);
+        if (xTaskCreatePinnedToCore(networkTaskMain, "network", Constants::NETWORK_TASK_STACK, this,
+                                    Constants::NETWORK_TASK_PRIORITY, &handle, Constants::NETWORK_TASK_CORE) == pdPASS) {
+            networkHandle = handle;
+            LOG_INFO("🧵 Control task on core %u every %lums, network task on core %u",
+                     Constants::CONTROL_TASK_CORE, periodMs, Constants::NETWORK_TASK_CORE);
+            return;
+        }
+        powerManager.setDoorTask(nullptr);
+        vTaskDelete((TaskHandle_t)controlHandle);
+        controlHandle = nullptr;
+        tasked = false;
+    }
+
+    // Без памяти под стеки работаем по-старому, из loop()
+    LOG_ERROR("❌ Failed to create control/network tasks, falling back to loop()");
+#endif
+    LOG_INFO("🧵 Control and network share loop(), control every %lums", periodMs);
+}
+
+void ControlTask::poll() {
+    unsigned long now = millis();
+    if (now - lastPoll >= periodMs) {
+        lastPoll = now;
+        powerManager.takeWake();
+        runControl();
+    } else if (powerManager.takeWake()) {
+        runControl(false);
+    }
+    runNetwork();
+
+    unsigned long elapsed = millis() - lastPoll;
+    powerManager.idle(elapsed < periodMs ? periodMs - elapsed : 0);
+}
+
+void ControlTask::controlTaskMain(void* arg) {
+    ControlTask* self = static_cast<ControlTask*>(arg);
+    TickType_t wake = xTaskGetTickCount();
+    const TickType_t period = pdMS_TO_TICKS(self->periodMs);
+    for (;;) {
+        if (!powerManager.isLowPower()) {
+            vTaskDelayUntil(&wake, period);
+            self->runControl();
+            continue;
+        }
+        // Остаток периода - ожидание уведомления: дверь будит раньше
+        TickType_t elapsed = xTaskGetTickCount() - wake;
+        if (elapsed < period && ulTaskNotifyTake(pdTRUE, period - elapsed) > 0) {
+            self->runControl(false);
+            continue;
+        }
+        wake += period;
+        self->runControl();
+    }
+}
+
+void ControlTask::networkTaskMain(void* arg) {
+    ControlTask* self = static_cast<ControlTask*>(arg);
+    for (;;) {
+        self->runNetwork();
+        // Ядро отдается стеку Wi-Fi и idle-задаче (сторожевой таймер);
+        // в режиме пониженного потребления вместо этого - сон
+        if (!powerManager.idle(self->periodMs)) vTaskDelay(1);
+    }
+}
+
+void ControlTask::runControl(bool scheduled) {
+    uint32_t start = micros();
+    if (resetRequested.exchange(false, std::memory_order_relaxed)) {
+        jitterUs.reset();
+        cycleUs.reset();
+        overruns = 0;
+        lastStart = 0;
+    }
+
+    // Джиттер - отклонение фактического интервала между циклами от периода
+    uint32_t periodUs = periodMs * 1000;
+    if (scheduled) {
+        if (lastStart != 0) {
+            uint32_t interval = start - lastStart;
+            jitterUs.record(interval > periodUs ? interval - periodUs : periodUs - interval);
+        }
+        lastStart = start;
+    }
+
+    // Сеть ждет ответа и больше QUEUE_SIZE запросов за цикл не отправит
+    ControlRequest request;
+    ControlResult done[QUEUE_SIZE];
+    uint8_t doneCount = 0;
+    while (doneCount < QUEUE_SIZE && requests.pop(request)) {
+        // Отмененный отправителем запрос не выполняется
+        uint32_t expected = request.id;
+        if (!pendingId.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) continue;
+        ControlResult& result = done[doneCount++];
+        result.id = request.id;
+        execute(request, result);
+    }
+
+    controlCycle();
+    sensors.publish(sensorData);
+    // Снимок состояния - до ответов: получив ответ, сеть видит его результат
+    if (doneCount > 0 || millis() - lastStatus >= Constants::CONTROL_STATUS_INTERVAL) {
+        publishStatus();
+    }
+    for (uint8_t i = 0; i < doneCount; i++) {
+        results.push(done[i]);
+    }
+
+    uint32_t elapsed = micros() - start;
+    cycleUs.record(elapsed);
+    if (elapsed > periodUs) overruns++;
+}
+
+void ControlTask::runNetwork() {
+    readSnapshots();
+    networkCycle();
+}
+
+bool ControlTask::submit(ControlRequest& request, ControlResult& result) {
+    request.id = ++nextId;
+    result = ControlResult();
+    result.id = request.id;
+    if (!tasked) {
+        execute(request, result);
+        publishStatus();
+        readSnapshots();
+        return true;
+    }
+
+    pendingId.store(request.id, std::memory_order_release);
+    if (requests.push(request)) {
+        unsigned long start = millis();
+        unsigned long timeout = getRequestTimeoutMs();
+        for (;;) {
+            if (results.pop(result)) {
+                if (result.id != request.id) continue;
+                readSnapshots();
+                return true;
+            }
+            // Отмена удалась - запрос не выполнится. Иначе цикл управления
+            // его уже взял: ответ придет в конце этого цикла.
+            if (millis() - start >= timeout) {
+                uint32_t expected = request.id;
+                if (pendingId.compare_exchange_strong(expected, 0, std::memory_order_acq_rel)) break;
+            }
+            vTaskDelay(1);
+        }
+    } else {
+        pendingId.store(0, std::memory_order_relaxed);
+    }
+
+    timeouts++;
+    LOG_WARN("⚠️ Control task did not take request %u, cancelled", (unsigned)request.type);
+    result = ControlResult();
+    return false;
+}
+
+void ControlTask::execute(const ControlRequest& request, ControlResult& result) {
+    switch (request.type) {
+        case ControlRequest::Type::COMMANDS:
+            result.value = deviceManager.applyCommands(request.commands, request.count, request.cause,
+                                                       result.failedIndex, result.reason);
+            break;
+        case ControlRequest::Type::ACKNOWLEDGE:
+            result.value = alarmEngine.acknowledge(request.arg);
+            break;
+        case ControlRequest::Type::ACKNOWLEDGE_ALL:
+            result.value = alarmEngine.acknowledgeAll();
+            break;
+        case ControlRequest::Type::CALIBRATE_SOIL:
+            deviceManager.calibrateSoilSensor(request.arg != 0);
+            result.value = 1;
+            break;
+        case ControlRequest::Type::RESET_ENERGY:
+            energyMeter.reset();
+            result.value = 1;
+            break;
+        case ControlRequest::Type::CONFIGURE:
+            systemSettings = request.settings;
+            alarmEngine.configure(systemSettings);
+            ledMatrix.setGrowProfile((GrowProfile)systemSettings.growProfile);
+            result.value = 1;
+            break;
+    }
+}
+
+unsigned long ControlTask::getRequestTimeoutMs() const {
+    unsigned long worstCycleMs = statusView.cycleUs.max() / 1000 + 1;
+    if (worstCycleMs < Constants::CONTROL_WORST_CYCLE_MS) worstCycleMs = Constants::CONTROL_WORST_CYCLE_MS;
+    return periodMs + worstCycleMs;
+}
+
+void ControlTask::publishStatus() {
+    status.beginWrite().capture();
+    status.endWrite();
+    lastStatus = millis();
+}
+
+// Неизменные снимки не копируются: сетевой цикл идет чаще публикации
+void ControlTask::readSnapshots() {
+    sensors.read(sensorView, sensorsSeen);
+    status.read(statusView, statusSeen);
+}
+
+uint32_t ControlTask::getControlStackFree() const {
+    return controlHandle ? uxTaskGetStackHighWaterMark((TaskHandle_t)controlHandle) : 0;
+}
+
+uint32_t ControlTask::getNetworkStackFree() const {
+    return networkHandle ? uxTaskGetStackHighWaterMark((TaskHandle_t)networkHandle) : 0;
+}
@@ -0,0 +1,137 @@
+#ifndef CONTROL_TASK_H
+#define CONTROL_TASK_H
+
+#include <atomic>
+#include "Config.h"
+#include "ControlStatus.h"
+#include "DeviceManager.h"
+#include "LatencyHistogram.h"
+#include "Seqlock.h"
+#include "SpscQueue.h"
+
+// Действие, которое сетевая сторона поручает циклу управления
+struct ControlRequest {
+    enum class Type : uint8_t {
+        COMMANDS,           // пакет команд выходам
+        ACKNOWLEDGE,        // подтверждение тревоги arg
+        ACKNOWLEDGE_ALL,
+        CALIBRATE_SOIL,     // arg: 0 - воздух, 1 - вода
+        RESET_ENERGY,
+        CONFIGURE           // settings заменяют systemSettings, пороги тревог пересчитываются
+    };
+
+    Type type = Type::COMMANDS;
+    ControlCause cause = ControlCause::SYSTEM;
+    uint8_t arg = 0;
+    uint8_t count = 0;
+    uint32_t id = 0;
+    DeviceManager::ControlCommand commands[Constants::MAX_BATCH_COMMANDS];
+    // Копия по значению: запрос лежит в кольце, а не ссылается на обработчик
+    SystemSettings settings;
+};
+
+struct ControlResult {
+    uint32_t id = 0;
+    uint8_t value = 0;              // число подтвержденных тревог / признак успеха
+    uint8_t failedIndex = 0;
+    const char* reason = nullptr;   // строковый литерал; nullptr - успех
+};
+
+// Разделение работы по ядрам ESP32. Задача управления (ядро 1, высокий
+// приоритет) с периодом CONTROL_PERIOD_MS опрашивает датчики, ведет
+// автоматику, тревоги и выходы. Сетевая задача (ядро 0, рядом со стеком
+// Wi-Fi) обслуживает HTTP, MQTT, телеметрию и индикатор.
+//
+// Общего изменяемого состояния у сторон нет:
+//  - показания уходят в сеть снимком sensorData, состояние выходов,
+//    тревог, учета и устройств - снимком ControlStatus (seqlock, без
+//    ожидания писателя); сетевая сторона читает копии sensorView и statusView;
+//  - изменения состояния управления, включая systemSettings, приходят
+//    кольцом запросов, ответы возвращаются встречным кольцом (оба - один
+//    писатель, один читатель). Настройки сеть читает без блокировки:
+//    пишет их только цикл управления, пока отправитель ждет ответа.
+//    Запрос, которого не дождались, отменяется и не выполняется вовсе:
+//    его номер в pendingId забирает (CAS) либо цикл управления перед
+//    выполнением, либо отправитель при отказе - но не оба.
+//
+// При ENABLE_CONTROL_TASK == 0 оба цикла выполняет loop() через poll():
+// управление - с тем же периодом, что позволяет сравнить джиттер.
+//
+// В режиме пониженного потребления цикл управления ждет периода на
+// уведомлении задачи: прерывание двери будит его сразу, внеочередной
+// цикл в джиттер не попадает.
+class ControlTask {
+public:
+    using Cycle = void (*)();
+
+    static constexpr uint8_t QUEUE_SIZE = 4;    // степень двойки
+
+    void begin(Cycle control, Cycle network);
+    // Однопоточный режим: вызывать из loop()
+    void poll();
+
+    // Выполняет запрос в цикле управления и ждет ответа (сетевая сторона).
+    // К ответу statusView уже отражает результат. false - цикл управления
+    // не взял запрос за getRequestTimeoutMs(); запрос отменен и не будет
+    // выполнен. Взятый запрос дожидается ответа и после таймаута.
+    bool submit(ControlRequest& request, ControlResult& result);
+    // Запрос ждет окончания текущего цикла и начала следующего: период плюс
+    // худшая длительность цикла (наблюдаемая, но не меньше расчетной)
+    unsigned long getRequestTimeoutMs() const;
+
+    // Сброс статистики джиттера (выполнит сам цикл управления)
+    void resetStats() { resetRequested.store(true, std::memory_order_relaxed); }
+
+    bool isTasked() const { return tasked; }
+    unsigned long getPeriodMs() const { return periodMs; }
+    // Статистика цикла управления; сетевой стороне - через statusView
+    const LatencyHistogram<24>& getJitter() const { return jitterUs; }
+    const LatencyHistogram<24>& getCycleTime() const { return cycleUs; }
+    uint32_t getOverruns() const { return overruns; }
+    uint32_t getTimeouts() const { return timeouts; }
+    // Свободный стек задач в байтах (0 - задачи не созданы)
+    uint32_t getControlStackFree() const;
+    uint32_t getNetworkStackFree() const;
+
+private:
+    static void controlTaskMain(void* arg);
+    static void networkTaskMain(void* arg);
+
+    // scheduled == false - внеочередной цикл по двери
+    void runControl(bool scheduled = true);
+    void runNetwork();
+    void execute(const ControlRequest& request, ControlResult& result);
+    void publishStatus();
+    void readSnapshots();
+
+    Cycle controlCycle = nullptr;
+    Cycle networkCycle = nullptr;
+    bool tasked = false;
+    void* controlHandle = nullptr;
+    void* networkHandle = nullptr;
+    unsigned long periodMs = Constants::CONTROL_PERIOD_MS;
+    unsigned long lastPoll = 0;
+
+    SpscQueue<ControlRequest, QUEUE_SIZE> requests;     // сеть -> управление
+    SpscQueue<ControlResult, QUEUE_SIZE> results;       // управление -> сеть
+    uint32_t nextId = 0;
+    std::atomic<uint32_t> pendingId{0};     // ожидающий запрос; 0 - взят или отменен
+
+    Seqlock<SensorData> sensors;
+    Seqlock<ControlStatus> status;
+    uint32_t sensorsSeen = 0;           // версии, уже скопированные сетевой стороной
+    uint32_t statusSeen = 0;
+    unsigned long lastStatus = 0;
+
+    // Статистика пишется только циклом управления
+    LatencyHistogram<24> jitterUs;      // отклонение интервала между циклами от периода
+    LatencyHistogram<24> cycleUs;       // длительность цикла
+    uint32_t lastStart = 0;
+    uint32_t overruns = 0;              // цикл длиннее периода
+    uint32_t timeouts = 0;              // пишет сетевая сторона
+    std::atomic<bool> resetRequested{false};
+};
+
+extern ControlTask controlTask;
+
+#endif
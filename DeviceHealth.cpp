@@ -0,0 +1,100 @@
+#include "DeviceHealth.h"
+
+void DeviceHealth::reset() {
+    // Накопленный счетчик ошибок не сбрасывается - он нужен для мониторинга
+    current = State::HEALTHY;
+    history = 0;
+    samples = 0;
+    consecutiveErrors = 0;
+    recoveryReads = 0;
+    backoff = BASE_BACKOFF;
+}
+
+void DeviceHealth::markFailed(unsigned long now) {
+    reset();
+    enterFailed(now);
+}
+
+bool DeviceHealth::recordRead(bool success, unsigned long now) {
+    if (current == State::FAILED) return false;
+
+    State previous = current;
+    if (!success) errorTotal++;
+
+    history = (history << 1) | (success ? 0 : 1);
+    if (samples < WINDOW_SIZE) samples++;
+    consecutiveErrors = success ? 0 : consecutiveErrors + 1;
+
+    if (current == State::RECOVERING) {
+        // После повторной инициализации устройство должно подтвердить работу
+        if (!success) {
+            growBackoff();
+            enterFailed(now);
+        } else if (++recoveryReads >= RECOVERY_READS) {
+            current = State::HEALTHY;
+            backoff = BASE_BACKOFF;
+        }
+        return current != previous;
+    }
+
+    // Пока окно короткое, отказ определяют только ошибки подряд
+    uint8_t rate = samples >= MIN_RATE_SAMPLES ? errorRatePercent() : 0;
+    if (consecutiveErrors >= FAILED_CONSECUTIVE || rate >= FAILED_RATE) {
+        enterFailed(now);
+    } else if (rate >= DEGRADED_RATE) {
+        current = State::DEGRADED;
+    } else if (rate < DEGRADED_RATE / 2) {
+        // Гистерезис: возврат в HEALTHY только при заметно меньшей доле ошибок
+        current = State::HEALTHY;
+    }
+
+    return current != previous;
+}
+
+bool DeviceHealth::recordRecovery(bool success, unsigned long now) {
+    if (current != State::FAILED) return false;
+
+    lastAttempt = now;
+    if (!success) {
+        growBackoff();
+        return false;
+    }
+
+    current = State::RECOVERING;
+    history = 0;
+    samples = 0;
+    consecutiveErrors = 0;
+    recoveryReads = 0;
+    return true;
+}
+
+bool DeviceHealth::recoveryDue(unsigned long now) const {
+    return current == State::FAILED && now - lastAttempt >= backoff;
+}
+
+uint8_t DeviceHealth::errorRatePercent() const {
+    if (samples == 0) return 0;
+
+    uint16_t mask = (samples >= 16) ? 0xFFFF : ((1u << samples) - 1);
+    uint8_t errors = __builtin_popcount(history & mask);
+    return errors * 100 / samples;
+}
+
+const char* DeviceHealth::stateName(State state) {
+    switch (state) {
+        case State::HEALTHY: return "HEALTHY";
+        case State::DEGRADED: return "DEGRADED";
+        case State::FAILED: return "FAILED";
+        case State::RECOVERING: return "RECOVERING";
+    }
+    return "UNKNOWN";
+}
+
+void DeviceHealth::enterFailed(unsigned long now) {
+    current = State::FAILED;
+    lastAttempt = now;
+}
+
+void DeviceHealth::growBackoff() {
+    backoff = (backoff >= MAX_BACKOFF / 2) ? MAX_BACKOFF : backoff * 2;
+}
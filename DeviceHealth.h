@@ -0,0 +1,59 @@
+#ifndef DEVICE_HEALTH_H
+#define DEVICE_HEALTH_H
+
+#include <Arduino.h>
+
+// Конечный автомат здоровья устройства.
+// Состояние определяется долей ошибок в скользящем окне последних чтений,
+// повторная инициализация отказавшего устройства - с экспоненциальной задержкой.
+class DeviceHealth {
+public:
+    enum class State : uint8_t {
+        HEALTHY,
+        DEGRADED,
+        FAILED,
+        RECOVERING
+    };
+
+    void reset();
+    void markFailed(unsigned long now);
+
+    // Возвращают true, если состояние изменилось
+    bool recordRead(bool success, unsigned long now);
+    bool recordRecovery(bool success, unsigned long now);
+
+    bool recoveryDue(unsigned long now) const;
+    bool isUsable() const { return current != State::FAILED; }
+    State state() const { return current; }
+    uint8_t errorRatePercent() const;
+    uint32_t totalErrors() const { return errorTotal; }
+    unsigned long backoffMs() const { return backoff; }
+
+    static const char* stateName(State state);
+
+    static constexpr uint8_t WINDOW_SIZE = 16;
+    static constexpr uint8_t DEGRADED_RATE = 20;     // % ошибок
+    static constexpr uint8_t FAILED_RATE = 50;       // % ошибок
+    static constexpr uint8_t FAILED_CONSECUTIVE = 3;
+    // Доля ошибок учитывается только по заполненной наполовину истории:
+    // иначе первая же ошибка после сброса дает 100%
+    static constexpr uint8_t MIN_RATE_SAMPLES = WINDOW_SIZE / 2;
+    static constexpr uint8_t RECOVERY_READS = 3;
+    static constexpr unsigned long BASE_BACKOFF = 30000;    // 30 секунд
+    static constexpr unsigned long MAX_BACKOFF = 1800000;   // 30 минут
+
+private:
+    void enterFailed(unsigned long now);
+    void growBackoff();
+
+    State current = State::HEALTHY;
+    uint16_t history = 0;         // 1 - ошибка, младший бит - последнее чтение
+    uint8_t samples = 0;
+    uint8_t consecutiveErrors = 0;
+    uint8_t recoveryReads = 0;
+    uint32_t errorTotal = 0;
+    unsigned long backoff = BASE_BACKOFF;
+    unsigned long lastAttempt = 0;
+};
+
+#endif
@@ -1,33 +1,28 @@
 #include "DeviceManager.h"
-#include <Wire.h>
-#include <BH1750.h>
-#include <Adafruit_BME280.h>
 #include <ESP32Servo.h>
-#include <FastLED.h>
 #include "GlobalInstances.h"
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "Profiler.h"
+#include "SensorConversion.h"
+#include "TraceRecorder.h"
 
 // Драйверы устройств
-BH1750 lightMeter;
-Adafruit_BME280 bme;
 Servo doorServo;
-CRGB leds[Constants::NUM_LEDS];
 
 DeviceManager::DeviceManager() {
-    Serial.println("🔧 DeviceManager constructor");
 }
 
 void DeviceManager::begin() {
-    Serial.println("\n" + String(60, '='));
-    Serial.println("🔧 DEVICE MANAGER INITIALIZATION");
-    Serial.println(String(60, '='));
+    LOG_INFO("🔧 DEVICE MANAGER INITIALIZATION");
     
     // Инициализация пинов
     initializePins();
     
-    // Инициализация I2C
-    Wire.begin();
+    // Инициализация I2C (с восстановлением залипшей шины)
+    i2cBus.begin();
     delay(100);
-    Serial.println("✅ I2C initialized");
+    LOG_INFO("✅ I2C initialized");
     
     // Обнаружение устройств
     discoverI2CDevices();
@@ -35,19 +30,18 @@ void DeviceManager::begin() {
     
     // Инициализация GPIO устройств
     initializeSoilSensors();
-    initializeLEDMatrix();
     
     // Инициализация серво
     doorServo.attach(Pins::SERVO);
-    Serial.println("✅ Servo attached to pin " + String(Pins::SERVO));
-    controlDoor(90); // Нейтральное положение
+    LOG_INFO("✅ Servo attached to pin %d", Pins::SERVO);
+    controlDoor(Constants::DOOR_NEUTRAL_ANGLE, ControlCause::SYSTEM); // Нейтральное положение
     
     devicesInitialized = true;
-    Serial.println("✅ Device Manager initialized successfully");
+    LOG_INFO("✅ Device Manager initialized successfully");
 }
 
 void DeviceManager::initializePins() {
-    Serial.println("📌 Initializing GPIO pins...");
+    LOG_INFO("📌 Initializing GPIO pins...");
     
     // Настройка пинов реле
     int relayPins[] = {Pins::PUMP, Pins::FAN, Pins::HEATER, Pins::LIGHT, Pins::DOOR_LOCK};
@@ -56,325 +50,305 @@ void DeviceManager::initializePins() {
     for(int i = 0; i < 5; i++) {
         pinMode(relayPins[i], OUTPUT);
         digitalWrite(relayPins[i], LOW);
-        Serial.println("  " + String(relayNames[i]) + " -> GPIO " + String(relayPins[i]));
+        LOG_DEBUG("  %s -> GPIO %d", relayNames[i], relayPins[i]);
     }
     
     // Настройка пинов датчиков
     pinMode(Pins::DOOR_SENSOR, INPUT_PULLUP);
-    Serial.println("  DOOR_SENSOR -> GPIO " + String(Pins::DOOR_SENSOR) + " (INPUT_PULLUP)");
+    LOG_DEBUG("  DOOR_SENSOR -> GPIO %d (INPUT_PULLUP)", Pins::DOOR_SENSOR);
     
-    Serial.println("✅ GPIO pins initialized");
+    LOG_INFO("✅ GPIO pins initialized");
 }
 
 void DeviceManager::discoverI2CDevices() {
-    Serial.println("\n--- I2C Device Discovery ---");
-    
-    // База известных устройств
-    struct KnownDevice {
-        uint8_t address;
-        const char* name;
-        const char* description;
-    };
-    
-    KnownDevice knownDevices[] = {
-        {0x23, "BH1750", "Light Sensor"},
-        {0x27, "LCD1602", "LCD Display"},
-        {0x3C, "OLED", "OLED Display"},
-        {0x3D, "OLED", "OLED Display"},
-        {0x40, "SHT30", "Temperature/Humidity"},
-        {0x48, "ADS1115", "ADC Converter"},
-        {0x4E, "PCF8574", "I/O Expander"},   // Частый адрес для PCF8574
-        {0x50, "EEPROM", "EEPROM Memory"},
-        {0x68, "DS3231", "RTC Clock"},
-        {0x70, "PCA9685", "PWM Controller"}, // Частый адрес для PCA9685
-        {0x76, "BME280", "Environmental"},
-        {0x77, "BME280", "Environmental"},
-    };
-    
-    byte error, address;
-    int foundCount = 0;
-    
-    for(address = 1; address < 127; address++) {
-        Wire.beginTransmission(address);
-        error = Wire.endTransmission();
+    LOG_INFO("--- I2C Device Discovery ---");
+    
+    // Быстрый проход: только адреса-кандидаты драйверов с ограниченным таймаутом
+    i2cBus.setTimeout(Constants::I2C_PROBE_TIMEOUT_MS);
+    
+    for (size_t i = 0; i < SensorDrivers::count(); i++) {
+        const SensorDriver& driver = SensorDrivers::get(i);
+        if (!driver.init) continue;
         
-        if (error == 0) {
-            Serial.print("🔍 Found: 0x");
-            if (address < 16) Serial.print("0");
-            Serial.print(address, HEX);
+        for (uint8_t j = 0; j < driver.addressCount; j++) {
+            uint8_t address = driver.addresses[j];
+            if (isAttached(address) || !probeAddress(address)) continue;
+            if (driver.probe && !driver.probe(address)) continue;
             
-            // Поиск в базе известных устройств
-            bool known = false;
-            for(auto device : knownDevices) {
-                if(device.address == address) {
-                    Serial.print(" - ");
-                    Serial.print(device.name);
-                    Serial.print(" (");
-                    Serial.print(device.description);
-                    Serial.print(")");
-                    known = true;
-                    
-                    // Запоминаем важные устройства
-                    if (strcmp(device.name, "BME280") == 0) {
-                        deviceConfig.bme280Address = address;
-                        Serial.print(" [MAIN]");
-                    } else if (strcmp(device.name, "BH1750") == 0) {
-                        deviceConfig.bh1750Address = address;
-                        Serial.print(" [MAIN]");
-                    }
-                    break;
-                }
+            if (attachDevice(driver, address)) {
+                LOG_INFO("🔍 Found: 0x%02X - %s (%s)", address, driver.name, driver.description);
             }
-            
-            if (!known) {
-                Serial.print(" - Unknown I2C Device");
-                // Попытка идентификации
-                identifyUnknownDevice(address);
-            }
-            Serial.println();
-            foundCount++;
         }
     }
     
-    Serial.printf("📟 Found %d I2C device(s)\n", foundCount);
+    i2cBus.setTimeout(Constants::I2C_DEFAULT_TIMEOUT_MS);
+    LOG_INFO("📟 Found %d known I2C device(s), full scan continues in background", attachedCount);
+    
+    // Полное сканирование выполняется порциями из update()
+    scanAddress = 1;
+    scanFoundCount = 0;
 }
 
-void DeviceManager::identifyUnknownDevice(uint8_t address) {
-    // Попытка чтения регистра идентификации
-    Wire.beginTransmission(address);
-    Wire.write(0x00); // Частый регистр идентификации
-    if (Wire.endTransmission() == 0) {
-        Wire.requestFrom(address, (uint8_t)1);
-        if (Wire.available()) {
-            byte reg = Wire.read();
-            Serial.printf(" [ID: 0x%02X]", reg);
-        }
+void DeviceManager::update() {
+    updateTimers();
+    updateDoor();
+    
+    if (scanAddress != 0) {
+        scanStep();
     }
 }
 
-void DeviceManager::initializeDetectedDevices() {
-    Serial.println("\n--- Device Initialization ---");
-    
-    // BME280
-    if (deviceConfig.bme280Address != 0) {
-        Serial.print("🌡️  Initializing BME280 at 0x");
-        Serial.print(deviceConfig.bme280Address, HEX);
-        Serial.print("... ");
+void DeviceManager::scanStep() {
+    i2cBus.setTimeout(Constants::I2C_PROBE_TIMEOUT_MS);
+    
+    for (uint8_t n = 0; n < Constants::I2C_SCAN_BATCH && scanAddress < 127; n++, scanAddress++) {
+        uint8_t address = scanAddress;
+        if (isAttached(address)) {
+            scanFoundCount++;
+            continue;
+        }
+        if (!probeAddress(address)) continue;
+        scanFoundCount++;
         
-        deviceConfig.hasBME280 = bme.begin(deviceConfig.bme280Address);
-        deviceConfig.bme280Healthy = deviceConfig.hasBME280;
+        const SensorDriver* driver = matchDriver(address, true);
+        if (driver) {
+            AttachedDevice* device = attachDevice(*driver, address);
+            if (device) {
+                bool ok = initializeDevice(*device);
+                LOG_INFO("🔍 Found: 0x%02X - %s (%s), attaching... %s", address,
+                         driver->name, driver->description, ok ? "✅ OK" : "❌ FAILED");
+            } else {
+                LOG_INFO("🔍 Found: 0x%02X - %s (%s) [not attached]", address, driver->name, driver->description);
+            }
+            continue;
+        }
         
-        if (deviceConfig.hasBME280) {
-            bme.setSampling(Adafruit_BME280::MODE_NORMAL,
-                          Adafruit_BME280::SAMPLING_X1,
-                          Adafruit_BME280::SAMPLING_X1,
-                          Adafruit_BME280::SAMPLING_X1,
-                          Adafruit_BME280::FILTER_OFF);
-            Serial.println("✅ OK");
+        driver = matchDriver(address, false);
+        if (driver) {
+            LOG_INFO("🔍 Found: 0x%02X - %s (%s)", address, driver->name, driver->description);
         } else {
-            Serial.println("❌ FAILED");
+            // Попытка идентификации
+            identifyUnknownDevice(address);
         }
-    } else {
-        Serial.println("❌ BME280 not found");
     }
     
-    // BH1750
-    if (deviceConfig.bh1750Address != 0) {
-        Serial.print("💡 Initializing BH1750 at 0x");
-        Serial.print(deviceConfig.bh1750Address, HEX);
-        Serial.print("... ");
-        
-        deviceConfig.hasBH1750 = lightMeter.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, deviceConfig.bh1750Address);
-        deviceConfig.bh1750Healthy = deviceConfig.hasBH1750;
-        
-        if (deviceConfig.hasBH1750) {
-            Serial.println("✅ OK");
-        } else {
-            Serial.println("❌ FAILED");
-        }
+    i2cBus.setTimeout(Constants::I2C_DEFAULT_TIMEOUT_MS);
+    
+    if (scanAddress >= 127) {
+        LOG_INFO("📟 Background I2C scan complete: %d device(s) on bus", scanFoundCount);
+        scanAddress = 0;
+    }
+}
+
+bool DeviceManager::probeAddress(uint8_t address) {
+    return i2cBus.probe(address);
+}
+
+const SensorDriver* DeviceManager::matchDriver(uint8_t address, bool attachableOnly) {
+    for (size_t i = 0; i < SensorDrivers::count(); i++) {
+        const SensorDriver& driver = SensorDrivers::get(i);
+        if (attachableOnly != (driver.init != nullptr)) continue;
+        if (!SensorDrivers::hasCandidate(driver, address)) continue;
+        if (driver.probe && !driver.probe(address)) continue;
+        return &driver;
+    }
+    return nullptr;
+}
+
+DeviceManager::AttachedDevice* DeviceManager::attachDevice(const SensorDriver& driver, uint8_t address) {
+    if (attachedCount >= MAX_ATTACHED_DEVICES) {
+        LOG_WARN("⚠️ No free slot for %s at 0x%02X", driver.name, address);
+        return nullptr;
+    }
+    
+    // Один экземпляр основного датчика, связанного с DeviceConfig
+    if (driver.address && *driver.address != 0 && isAttached(*driver.address)) {
+        return nullptr;
+    }
+    
+    AttachedDevice& device = attachedDevices[attachedCount++];
+    device.driver = &driver;
+    device.address = address;
+    device.health.markFailed(millis());
+    
+    if (driver.address) *driver.address = address;
+    return &device;
+}
+
+bool DeviceManager::isAttached(uint8_t address) const {
+    for (uint8_t i = 0; i < attachedCount; i++) {
+        if (attachedDevices[i].address == address) return true;
+    }
+    return false;
+}
+
+void DeviceManager::syncHealthFlags(AttachedDevice& device) {
+    if (device.driver->healthy) *device.driver->healthy = device.health.isUsable();
+}
+
+void DeviceManager::logHealthChange(const char* name, const DeviceHealth& health) {
+    LOG_WARN("🩺 %s -> %s (errors %d%%, backoff %lus)", name,
+                  DeviceHealth::stateName(health.state()),
+                  health.errorRatePercent(), health.backoffMs() / 1000);
+}
+
+void DeviceManager::identifyUnknownDevice(uint8_t address) {
+    // Попытка чтения регистра идентификации
+    uint8_t reg = 0x00; // Частый регистр идентификации
+    uint8_t id = 0;
+    if (i2cBus.writeRead(address, &reg, 1, &id, 1)) {
+        LOG_INFO("🔍 Found: 0x%02X - Unknown I2C Device [ID: 0x%02X]", address, id);
     } else {
-        Serial.println("❌ BH1750 not found");
+        LOG_INFO("🔍 Found: 0x%02X - Unknown I2C Device", address);
     }
+}
+
+void DeviceManager::initializeDetectedDevices() {
+    LOG_INFO("--- Device Initialization ---");
     
-    Serial.printf("🎯 System capabilities: BME280:%d BH1750:%d Soil:%d\n",
+    for (uint8_t i = 0; i < attachedCount; i++) {
+        AttachedDevice& device = attachedDevices[i];
+        bool ok = initializeDevice(device);
+        LOG_INFO("🔧 Initializing %s at 0x%02X... %s", device.driver->name, device.address,
+                 ok ? "✅ OK" : "❌ FAILED");
+    }
+    
+    if (!deviceConfig.hasBME280) LOG_ERROR("❌ BME280 not found");
+    if (!deviceConfig.hasBH1750) LOG_ERROR("❌ BH1750 not found");
+    
+    LOG_INFO("🎯 System capabilities: BME280:%d BH1750:%d Soil:%d",
                   deviceConfig.hasBME280, deviceConfig.hasBH1750, deviceConfig.hasSoilSensors);
 }
 
-bool DeviceManager::initializeSoilSensors() {
-    Serial.print("🌱 Initializing soil sensors... ");
+bool DeviceManager::initializeDevice(AttachedDevice& device) {
+    I2CBus::Transaction transaction(i2cBus, device.address);
+    bool ok = device.driver->init(device.address);
+    transaction.finish(ok);
     
+    if (ok) {
+        device.health.reset();
+    } else {
+        device.health.markFailed(millis());
+    }
+    if (device.driver->present) *device.driver->present = ok;
+    syncHealthFlags(device);
+    return ok;
+}
+
+bool DeviceManager::initializeSoilSensors() {
     // Проверка подключения датчиков почвы
     int soilValue = analogRead(Pins::SOIL_MOISTURE);
-    deviceConfig.hasSoilSensors = (soilValue > 100 && soilValue < (Constants::SOIL_ADC_MAX - 100));
+    deviceConfig.hasSoilSensors = SensorConversion::soilReadingInRange(soilValue);
     deviceConfig.soilSensorsHealthy = deviceConfig.hasSoilSensors;
+    soilHealth.reset();
     
     if (deviceConfig.hasSoilSensors) {
-        Serial.println("✅ OK (Value: " + String(soilValue) + ")");
+        LOG_INFO("🌱 Initializing soil sensors... ✅ OK (Value: %d)", soilValue);
     } else {
-        Serial.println("❌ FAILED (Value: " + String(soilValue) + ")");
+        LOG_ERROR("🌱 Initializing soil sensors... ❌ FAILED (Value: %d)", soilValue);
     }
     
     return deviceConfig.hasSoilSensors;
 }
 
-void DeviceManager::initializeLEDMatrix() {
-    Serial.print("🌈 Initializing LED matrix... ");
-    
-    FastLED.addLeds<NEOPIXEL, Pins::LED_MATRIX>(leds, Constants::NUM_LEDS);
-    FastLED.setBrightness(50);
-    fill_solid(leds, Constants::NUM_LEDS, CRGB::Black);
-    FastLED.show();
-    
-    // Тест матрицы
-    fill_solid(leds, Constants::NUM_LEDS, CRGB::Red);
-    FastLED.show();
-    delay(200);
-    fill_solid(leds, Constants::NUM_LEDS, CRGB::Green);
-    FastLED.show();
-    delay(200);
-    fill_solid(leds, Constants::NUM_LEDS, CRGB::Blue);
-    FastLED.show();
-    delay(200);
-    fill_solid(leds, Constants::NUM_LEDS, CRGB::Black);
-    FastLED.show();
-    
-    Serial.println("✅ OK (" + String(Constants::NUM_LEDS) + " LEDs)");
-}
-
 void DeviceManager::readAllSensors() {
-    // Чтение BME280
-    if (deviceConfig.hasBME280 && deviceConfig.bme280Healthy) {
-        readBME280();
-    } else if (deviceConfig.hasBME280) {
-        Serial.println("⚠️ BME280 marked unhealthy, attempting recovery...");
-        deviceConfig.bme280Healthy = bme.begin(deviceConfig.bme280Address);
-    }
+    PROFILE_SCOPE(SENSORS);
+    HEAP_SCOPE(SENSORS);
     
-    // Чтение BH1750
-    if (deviceConfig.hasBH1750 && deviceConfig.bh1750Healthy) {
-        readBH1750();
-    } else if (deviceConfig.hasBH1750) {
-        Serial.println("⚠️ BH1750 marked unhealthy, attempting recovery...");
-        deviceConfig.bh1750Healthy = lightMeter.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, deviceConfig.bh1750Address);
+    // Чтение I2C датчиков
+    for (uint8_t i = 0; i < attachedCount; i++) {
+        readDevice(attachedDevices[i]);
     }
     
     // Чтение датчиков почвы
-    if (deviceConfig.hasSoilSensors && deviceConfig.soilSensorsHealthy) {
-        readSoilSensors();
+    if (deviceConfig.hasSoilSensors) {
+        unsigned long now = millis();
+        bool changed;
+        if (soilHealth.state() == DeviceHealth::State::FAILED) {
+            changed = soilHealth.recoveryDue(now) &&
+                      soilHealth.recordRecovery(SensorConversion::soilReadingInRange(analogRead(Pins::SOIL_MOISTURE)), now);
+        } else {
+            changed = soilHealth.recordRead(readSoilSensors(), now);
+        }
+        if (changed) logHealthChange("Soil sensors", soilHealth);
+        deviceConfig.soilSensorsHealthy = soilHealth.isUsable();
     }
     
-    // Чтение состояния двери
-    sensorData.doorState = digitalRead(Pins::DOOR_SENSOR) == LOW;
-    
     // Обновление статуса системы
     sensorData.systemHealthy = deviceConfig.bme280Healthy && 
                               deviceConfig.bh1750Healthy && 
                               deviceConfig.soilSensorsHealthy;
 }
 
-void DeviceManager::readBME280() {
-    float temp = bme.readTemperature();
-    float hum = bme.readHumidity();
-    float pres = bme.readPressure() / 100.0F;
-    
-    if (!isnan(temp) && !isnan(hum) && !isnan(pres)) {
-        sensorData.airTemperature = temp;
-        sensorData.airHumidity = hum;
-        sensorData.pressure = pres;
-        bme280ErrorCount = 0;
+void DeviceManager::readDevice(AttachedDevice& device) {
+    const SensorDriver& driver = *device.driver;
+    if (!driver.read) return;
+    
+    unsigned long now = millis();
+    bool changed;
+    
+    if (device.health.state() == DeviceHealth::State::FAILED) {
+        // Повторная инициализация только по истечении задержки
+        if (!device.health.recoveryDue(now)) return;
+        LOG_WARN("⚠️ %s recovery attempt...", driver.name);
+        I2CBus::Transaction transaction(i2cBus, device.address);
+        bool ok = driver.init(device.address);
+        transaction.finish(ok);
+        changed = device.health.recordRecovery(ok, now);
     } else {
-        bme280ErrorCount++;
-        Serial.println("⚠️ BME280 read error #" + String(bme280ErrorCount));
-        
-        if (bme280ErrorCount > 5) {
-            deviceConfig.bme280Healthy = false;
-            Serial.println("❌ BME280 marked as unhealthy");
-        }
+        // Библиотечные драйверы обращаются к Wire напрямую - замеряем вызов целиком
+        I2CBus::Transaction transaction(i2cBus, device.address);
+        bool ok = driver.read(device.address, sensorData);
+        transaction.finish(ok);
+        if (!ok) LOG_WARN("⚠️ %s read error", driver.name);
+        changed = device.health.recordRead(ok, now);
     }
-}
-
-void DeviceManager::readBH1750() {
-    float lux = lightMeter.readLightLevel();
     
-    if (!isnan(lux) && lux >= 0 && lux <= 65535) {
-        sensorData.lightLevel = lux;
-        bh1750ErrorCount = 0;
-    } else {
-        bh1750ErrorCount++;
-        Serial.println("⚠️ BH1750 read error #" + String(bh1750ErrorCount));
-        
-        if (bh1750ErrorCount > 5) {
-            deviceConfig.bh1750Healthy = false;
-            Serial.println("❌ BH1750 marked as unhealthy");
-        }
+    if (changed) {
+        logHealthChange(driver.name, device.health);
+        syncHealthFlags(device);
     }
 }
 
-void DeviceManager::readSoilSensors() {
+bool DeviceManager::readSoilSensors() {
+    bool ok = true;
+    
     // Влажность почвы
     int soilMoistureRaw = analogRead(Pins::SOIL_MOISTURE);
-    if (soilMoistureRaw > 100 && soilMoistureRaw < (Constants::SOIL_ADC_MAX - 100)) {
-        sensorData.soilMoisture = map(soilMoistureRaw, 
-                                     deviceConfig.soilAirValue, 
-                                     deviceConfig.soilWaterValue, 0, 100);
-        sensorData.soilMoisture = constrain(sensorData.soilMoisture, 0, 100);
-        soilSensorErrorCount = 0;
+    Percent moisture;
+    if (SensorConversion::soilMoisture(soilMoistureRaw, deviceConfig.soilAirValue, deviceConfig.soilWaterValue, moisture)) {
+        sensorData.soilMoisture = moisture;
     } else {
-        soilSensorErrorCount++;
-        Serial.println("⚠️ Soil moisture sensor reading out of range: " + String(soilMoistureRaw));
+        ok = false;
+        LOG_WARN("⚠️ Soil moisture sensor reading out of range: %d", soilMoistureRaw);
     }
     
     // Температура почвы
-    int soilTempRaw = analogRead(Pins::SOIL_TEMPERATURE);
-    if (soilTempRaw > 100 && soilTempRaw < (Constants::SOIL_ADC_MAX - 100)) {
-        sensorData.soilTemperature = ((soilTempRaw / (float)Constants::SOIL_ADC_MAX * 
-                                     Constants::SOIL_TEMP_CONVERSION) - 0.5) * 100.0;
+    Temperature temperature;
+    if (SensorConversion::soilTemperature(analogRead(Pins::SOIL_TEMPERATURE), temperature)) {
+        sensorData.soilTemperature = temperature;
     }
     
-    if (soilSensorErrorCount > 10) {
-        deviceConfig.soilSensorsHealthy = false;
-        Serial.println("❌ Soil sensors marked as unhealthy");
-    }
+    return ok;
 }
 
 void DeviceManager::checkDeviceHealth() {
-    bool needsRediscovery = false;
-    
-    // Проверка BME280
-    if (deviceConfig.hasBME280 && deviceConfig.bme280Healthy) {
-        float testTemp = bme.readTemperature();
-        if (isnan(testTemp)) {
-            Serial.println("⚠️ BME280 health check failed");
-            deviceConfig.bme280Healthy = false;
-            needsRediscovery = true;
+    // Состояние устройств обновляется при каждом чтении в readAllSensors(),
+    // здесь дополнительных обращений к датчикам нет
+    bool anyFailed = false;
+    for (uint8_t i = 0; i < attachedCount; i++) {
+        if (attachedDevices[i].health.state() == DeviceHealth::State::FAILED) {
+            anyFailed = true;
         }
     }
     
-    // Проверка BH1750
-    if (deviceConfig.hasBH1750 && deviceConfig.bh1750Healthy) {
-        float testLux = lightMeter.readLightLevel();
-        if (isnan(testLux)) {
-            Serial.println("⚠️ BH1750 health check failed");
-            deviceConfig.bh1750Healthy = false;
-            needsRediscovery = true;
-        }
-    }
-    
-    // Проверка датчиков почвы
-    if (deviceConfig.hasSoilSensors && deviceConfig.soilSensorsHealthy) {
-        int soilValue = analogRead(Pins::SOIL_MOISTURE);
-        if (soilValue < 100 || soilValue > (Constants::SOIL_ADC_MAX - 100)) {
-            Serial.println("⚠️ Soil sensors health check failed");
-            deviceConfig.soilSensorsHealthy = false;
-        }
-    }
-    
-    // Переобнаружение устройств при необходимости
-    static unsigned long lastRediscovery = 0;
-    if (needsRediscovery && (millis() - lastRediscovery > 300000)) {
-        Serial.println("🔄 Performing device rediscovery...");
-        rediscoverDevices();
-        lastRediscovery = millis();
+    // Отказавшее устройство могло переподключиться на другой адрес:
+    // запускаем фоновое сканирование шины, не чаще раза в 5 минут
+    if (anyFailed && scanAddress == 0 && millis() - lastRescan > Constants::I2C_RESCAN_INTERVAL) {
+        LOG_INFO("🔄 Starting background I2C rescan...");
+        scanAddress = 1;
+        scanFoundCount = 0;
+        lastRescan = millis();
     }
     
     // Обновление общего статуса системы
@@ -384,88 +358,246 @@ void DeviceManager::checkDeviceHealth() {
 }
 
 void DeviceManager::rediscoverDevices() {
-    Serial.println("🔄 Rediscovering devices...");
-    
-    // Сброс флагов
-    deviceConfig.hasBME280 = false;
-    deviceConfig.hasBH1750 = false;
-    deviceConfig.bme280Healthy = false;
-    deviceConfig.bh1750Healthy = false;
+    LOG_INFO("🔄 Rediscovering devices...");
+    
+    // Сброс флагов и списка подключенных устройств
+    for (uint8_t i = 0; i < attachedCount; i++) {
+        const SensorDriver& driver = *attachedDevices[i].driver;
+        if (driver.present) *driver.present = false;
+        if (driver.healthy) *driver.healthy = false;
+        if (driver.address) *driver.address = 0;
+    }
+    attachedCount = 0;
     
-    // Повторное сканирование I2C
+    // Повторное обнаружение и инициализация
     discoverI2CDevices();
-    
-    // Повторная инициализация
-    if (deviceConfig.bme280Address != 0) {
-        deviceConfig.hasBME280 = bme.begin(deviceConfig.bme280Address);
-        deviceConfig.bme280Healthy = deviceConfig.hasBME280;
-    }
-    if (deviceConfig.bh1750Address != 0) {
-        deviceConfig.hasBH1750 = lightMeter.begin(BH1750::CONTINUOUS_HIGH_RES_MODE, deviceConfig.bh1750Address);
-        deviceConfig.bh1750Healthy = deviceConfig.hasBH1750;
-    }
+    initializeDetectedDevices();
     
     // Повторная проверка датчиков почвы
     initializeSoilSensors();
     
-    Serial.println("✅ Device rediscovery completed");
+    LOG_INFO("✅ Device rediscovery completed");
 }
 
-void DeviceManager::controlPump(bool state, unsigned long duration) {
+void DeviceManager::controlPump(bool state, ControlCause cause, unsigned long duration) {
     digitalWrite(Pins::PUMP, state ? HIGH : LOW);
     sensorData.pumpState = state;
+    recordOutput(ControlDevice::PUMP, state, cause);
     
     if (state && duration > 0) {
-        pumpAutoStop = true;
-        pumpStartTime = millis();
-        pumpDuration = duration;
-        Serial.println("💧 Pump ON for " + String(duration) + "ms");
+        setTimer(ControlDevice::PUMP, duration);
+        LOG_INFO("💧 Pump ON for %lums", duration);
     } else {
-        pumpAutoStop = false;
-        Serial.println(state ? "💧 Pump ON" : "💧 Pump OFF");
+        setTimer(ControlDevice::PUMP, 0);
+        LOG_INFO(state ? "💧 Pump ON" : "💧 Pump OFF");
     }
 }
 
-void DeviceManager::controlFan(bool state) {
+void DeviceManager::controlFan(bool state, ControlCause cause) {
     digitalWrite(Pins::FAN, state ? HIGH : LOW);
     sensorData.fanState = state;
-    Serial.println(state ? "🌬️ Fan ON" : "🌬️ Fan OFF");
+    recordOutput(ControlDevice::FAN, state, cause);
+    LOG_INFO(state ? "🌬️ Fan ON" : "🌬️ Fan OFF");
 }
 
-void DeviceManager::controlHeater(bool state) {
+void DeviceManager::controlHeater(bool state, ControlCause cause) {
     digitalWrite(Pins::HEATER, state ? HIGH : LOW);
     sensorData.heaterState = state;
-    Serial.println(state ? "🔥 Heater ON" : "🔥 Heater OFF");
+    recordOutput(ControlDevice::HEATER, state, cause);
+    LOG_INFO(state ? "🔥 Heater ON" : "🔥 Heater OFF");
 }
 
-void DeviceManager::controlLight(bool state) {
+void DeviceManager::controlLight(bool state, ControlCause cause) {
     digitalWrite(Pins::LIGHT, state ? HIGH : LOW);
     sensorData.lightState = state;
+    recordOutput(ControlDevice::LIGHT, state ? lightBrightness : 0, cause);
     
-    // Также управляем LED матрицей
-    if (state) {
-        fill_solid(leds, Constants::NUM_LEDS, CRGB::White);
-        Serial.println("💡 Light ON + LED Matrix WHITE");
-    } else {
-        fill_solid(leds, Constants::NUM_LEDS, CRGB::Black);
-        Serial.println("💡 Light OFF + LED Matrix OFF");
-    }
-    FastLED.show();
+    // LED матрица - канал фитосвета; кадр выводится из ledMatrix.update()
+    ledMatrix.setGrowLight(state ? lightBrightness : 0);
+    LOG_INFO(state ? "💡 Light ON + grow light" : "💡 Light OFF");
 }
 
-void DeviceManager::controlDoor(bool angle) {
+void DeviceManager::controlDoor(uint8_t angle, ControlCause cause) {
     angle = constrain(angle, 0, 180);
+    doorAngle = angle;
+    recordOutput(ControlDevice::DOOR, angle, cause);
     doorServo.write(angle);
-    delay(Constants::SERVO_DELAY);
-    Serial.println("🚪 Door position: " + String(angle) + "°");
+    // Поворот идет сам; цикл управления не ждет его, окончание отмечает update()
+    doorMoveStart = millis();
+    doorMoving = true;
+    LOG_INFO("🚪 Door moving to %d°", angle);
+}
+
+void DeviceManager::updateDoor() {
+    if (!doorMoving || millis() - doorMoveStart < Constants::SERVO_DELAY) return;
+    doorMoving = false;
+    LOG_INFO("🚪 Door position: %d°", doorAngle);
+}
+
+// ===== Реестр выходов =====
+const DeviceManager::ControlChannel DeviceManager::CHANNELS[] = {
+    {ControlDevice::PUMP, Pins::PUMP, ChannelType::SWITCH, 0, 1,
+     Constants::PUMP_MAX_DURATION, &DeviceManager::applyPump},
+    {ControlDevice::FAN, Pins::FAN, ChannelType::SWITCH, 0, 1,
+     Constants::OUTPUT_MAX_DURATION, &DeviceManager::applyFan},
+    {ControlDevice::HEATER, Pins::HEATER, ChannelType::SWITCH, 0, 1,
+     Constants::OUTPUT_MAX_DURATION, &DeviceManager::applyHeater},
+    {ControlDevice::LIGHT, Pins::LIGHT, ChannelType::DIMMER, 0, 255,
+     Constants::OUTPUT_MAX_DURATION, &DeviceManager::applyLight},
+    {ControlDevice::DOOR, Pins::SERVO, ChannelType::SERVO, 0, 180,
+     0, &DeviceManager::applyDoor},
+};
+
+uint8_t DeviceManager::getChannelCount() {
+    static_assert(sizeof(CHANNELS) / sizeof(CHANNELS[0]) == (size_t)ControlDevice::UNKNOWN,
+                  "CHANNELS must list every ControlDevice in enum order");
+    return (uint8_t)ControlDevice::UNKNOWN;
+}
+
+const DeviceManager::ControlChannel& DeviceManager::getChannel(uint8_t index) {
+    return CHANNELS[index];
+}
+
+const DeviceManager::ControlChannel* DeviceManager::findChannel(ControlDevice device) {
+    if (device >= ControlDevice::UNKNOWN) return nullptr;
+    return &CHANNELS[(uint8_t)device];
+}
+
+const char* DeviceManager::channelTypeName(ChannelType type) {
+    switch (type) {
+        case ChannelType::SWITCH: return "switch";
+        case ChannelType::DIMMER: return "dimmer";
+        case ChannelType::SERVO: return "servo";
+    }
+    return "unknown";
+}
+
+int16_t DeviceManager::getChannelValue(ControlDevice device) const {
+    switch (device) {
+        case ControlDevice::PUMP: return sensorData.pumpState;
+        case ControlDevice::FAN: return sensorData.fanState;
+        case ControlDevice::HEATER: return sensorData.heaterState;
+        case ControlDevice::LIGHT: return sensorData.lightState ? lightBrightness : 0;
+        case ControlDevice::DOOR: return doorAngle;
+        case ControlDevice::UNKNOWN: break;
+    }
+    return 0;
+}
+
+unsigned long DeviceManager::getChannelRemainingMs(ControlDevice device) const {
+    if (device >= ControlDevice::UNKNOWN) return 0;
+    uint8_t index = (uint8_t)device;
+    if (timerDuration[index] == 0) return 0;
+    
+    unsigned long elapsed = millis() - timerStart[index];
+    return elapsed >= timerDuration[index] ? 0 : timerDuration[index] - elapsed;
+}
+
+bool DeviceManager::validateCommand(const ControlCommand& command, const char*& error) const {
+    const ControlChannel* channel = findChannel(command.device);
+    if (!channel) {
+        error = "unknown device";
+        return false;
+    }
+    if (command.value < channel->minValue || command.value > channel->maxValue) {
+        error = "value out of range";
+        return false;
+    }
+    if (command.durationMs > 0) {
+        if (channel->maxDurationMs == 0) {
+            error = "duration not supported";
+            return false;
+        }
+        if (command.durationMs > channel->maxDurationMs) {
+            error = "duration too long";
+            return false;
+        }
+        if (command.value == channel->minValue) {
+            error = "duration requires an on value";
+            return false;
+        }
+    }
+    return true;
+}
+
+bool DeviceManager::applyCommands(const ControlCommand* commands, uint8_t count, ControlCause cause,
+                                  uint8_t& failedIndex, const char*& error) {
+    // Сначала проверяется весь пакет, затем применяется без промежуточных ответов
+    for (uint8_t i = 0; i < count; i++) {
+        if (!validateCommand(commands[i], error)) {
+            failedIndex = i;
+            return false;
+        }
+    }
+    
+    for (uint8_t i = 0; i < count; i++) {
+        applyCommand(commands[i], cause);
+    }
+    return true;
+}
+
+void DeviceManager::applyCommand(const ControlCommand& command, ControlCause cause) {
+    const ControlChannel& channel = CHANNELS[(uint8_t)command.device];
+    (this->*channel.apply)(command.value, cause);
+    setTimer(command.device, command.durationMs);
+    
+    if (command.durationMs > 0) {
+        LOG_INFO("⏱️ %s off in %lums", DeviceNames::name(command.device), command.durationMs);
+    }
+}
+
+void DeviceManager::setTimer(ControlDevice device, unsigned long durationMs) {
+    uint8_t index = (uint8_t)device;
+    timerStart[index] = millis();
+    timerDuration[index] = durationMs;
+}
+
+void DeviceManager::updateTimers() {
+    unsigned long now = millis();
+    for (uint8_t i = 0; i < getChannelCount(); i++) {
+        if (timerDuration[i] == 0 || now - timerStart[i] < timerDuration[i]) continue;
+        
+        timerDuration[i] = 0;
+        LOG_INFO("⏱️ %s timer expired", DeviceNames::name(CHANNELS[i].id));
+        (this->*CHANNELS[i].apply)(CHANNELS[i].minValue, ControlCause::TIMER);
+    }
+}
+
+void DeviceManager::applyPump(int16_t value, ControlCause cause) {
+    controlPump(value != 0, cause);
+}
+
+void DeviceManager::applyFan(int16_t value, ControlCause cause) {
+    controlFan(value != 0, cause);
+}
+
+void DeviceManager::applyHeater(int16_t value, ControlCause cause) {
+    controlHeater(value != 0, cause);
+}
+
+void DeviceManager::applyLight(int16_t value, ControlCause cause) {
+    if (value > 0) {
+        lightBrightness = value;
+    }
+    controlLight(value > 0, cause);
+}
+
+void DeviceManager::applyDoor(int16_t value, ControlCause cause) {
+    controlDoor(value, cause);
+}
+
+void DeviceManager::recordOutput(ControlDevice device, int16_t value, ControlCause cause) {
+    if (history.record(device, value, value > CHANNELS[(uint8_t)device].minValue, cause)) {
+        traceRecorder.recordCommand(millis(), device, value, cause);
+    }
 }
 
 void DeviceManager::stopAllDevices() {
-    controlPump(false);
-    controlFan(false);
-    controlHeater(false);
-    controlLight(false);
-    Serial.println("🔴 All devices stopped");
+    controlPump(false, ControlCause::SYSTEM);
+    controlFan(false, ControlCause::SYSTEM);
+    controlHeater(false, ControlCause::SYSTEM);
+    controlLight(false, ControlCause::SYSTEM);
+    LOG_INFO("🔴 All devices stopped");
 }
 
 void DeviceManager::calibrateSoilSensor(bool inWater) {
@@ -473,26 +605,24 @@ void DeviceManager::calibrateSoilSensor(bool inWater) {
     
     if (inWater) {
         deviceConfig.soilWaterValue = rawValue;
-        Serial.println("💧 Water calibration: " + String(rawValue));
+        LOG_INFO("💧 Water calibration: %d", rawValue);
     } else {
         deviceConfig.soilAirValue = rawValue;
-        Serial.println("💨 Air calibration: " + String(rawValue));
+        LOG_INFO("💨 Air calibration: %d", rawValue);
     }
 }
 
-String DeviceManager::getDeviceSummary() const {
-    String summary = "=== Device Summary ===\n";
-    summary += "BME280: " + String(deviceConfig.hasBME280 ? "Present" : "Missing");
-    summary += " [" + String(deviceConfig.bme280Healthy ? "OK" : "ERROR") + "]\n";
-    summary += "BH1750: " + String(deviceConfig.hasBH1750 ? "Present" : "Missing");
-    summary += " [" + String(deviceConfig.bh1750Healthy ? "OK" : "ERROR") + "]\n";
-    summary += "Soil Sensors: " + String(deviceConfig.hasSoilSensors ? "Present" : "Missing");
-    summary += " [" + String(deviceConfig.soilSensorsHealthy ? "OK" : "ERROR") + "]\n";
-    summary += "TM1637: Present [OK]\n";
-    summary += "Relays: Present [OK]\n";
-    return summary;
-}
-
 bool DeviceManager::isSystemHealthy() const {
     return sensorData.systemHealthy;
+}
+
+uint8_t DeviceManager::getDeviceCount() const {
+    return attachedCount;
+}
+
+DeviceManager::DeviceStatus DeviceManager::getDeviceStatus(uint8_t index) const {
+    const AttachedDevice& device = attachedDevices[index];
+    return {device.driver->name, device.address,
+            device.health.state(), device.health.errorRatePercent(),
+            device.health.totalErrors()};
 }
\ No newline at end of file
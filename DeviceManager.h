@@ -2,48 +2,144 @@
 #define DEVICE_MANAGER_H
 
 #include "Config.h"
+#include "SensorDrivers.h"
+#include "DeviceHealth.h"
+#include "DeviceNames.h"
+#include "ActuatorHistory.h"
+#include "Actuators.h"
 
-class DeviceManager {
+class DeviceManager : public Actuators {
 public:
     DeviceManager();
     void begin();
+    void update();
     void readAllSensors();
     void checkDeviceHealth();
     void rediscoverDevices();
     
-    void controlPump(bool state, unsigned long duration = 0);
-    void controlFan(bool state);
-    void controlHeater(bool state);
-    void controlLight(bool state);
-    void controlDoor(bool angle);
+    void controlPump(bool state, ControlCause cause, unsigned long duration = 0) override;
+    void controlFan(bool state, ControlCause cause) override;
+    void controlHeater(bool state, ControlCause cause) override;
+    void controlLight(bool state, ControlCause cause) override;
+    void controlDoor(uint8_t angle, ControlCause cause);
     void stopAllDevices();
     
+    // Реестр управляемых выходов: одна запись на ControlDevice, в порядке enum
+    enum class ChannelType : uint8_t {
+        SWITCH,   // реле, 0/1
+        DIMMER,   // реле + яркость LED матрицы 0-255
+        SERVO     // угол 0-180
+    };
+    
+    struct ControlChannel {
+        ControlDevice id;
+        uint8_t pin;
+        ChannelType type;
+        int16_t minValue;
+        int16_t maxValue;
+        unsigned long maxDurationMs;   // 0 - таймер не поддерживается
+        void (DeviceManager::*apply)(int16_t value, ControlCause cause);
+    };
+    
+    struct ControlCommand {
+        ControlDevice device;
+        int16_t value;
+        unsigned long durationMs;      // 0 - без автоотключения
+    };
+    
+    static uint8_t getChannelCount();
+    static const ControlChannel& getChannel(uint8_t index);
+    static const ControlChannel* findChannel(ControlDevice device);
+    static const char* channelTypeName(ChannelType type);
+    int16_t getChannelValue(ControlDevice device) const;
+    unsigned long getChannelRemainingMs(ControlDevice device) const;
+    
+    // Пакет применяется целиком или не применяется вовсе.
+    // При ошибке возвращает false, номер команды и причину.
+    bool validateCommand(const ControlCommand& command, const char*& error) const;
+    bool applyCommands(const ControlCommand* commands, uint8_t count, ControlCause cause,
+                       uint8_t& failedIndex, const char*& error);
+    
     void calibrateSoilSensor(bool inWater);
-    String getDeviceSummary() const;
+    
     bool isSystemHealthy() const;
     
+    // Состояние подключенных устройств для API
+    struct DeviceStatus {
+        const char* name;
+        uint8_t address;
+        DeviceHealth::State state;
+        uint8_t errorRate;
+        uint32_t totalErrors;
+    };
+    static constexpr uint8_t MAX_ATTACHED_DEVICES = 8;
+    uint8_t getDeviceCount() const;
+    DeviceStatus getDeviceStatus(uint8_t index) const;
+    DeviceHealth::State getSoilState() const { return soilHealth.state(); }
+    
+    // Журнал переключений, наработка и число переключений выходов
+    const ActuatorHistory& getHistory() const { return history; }
+    
 private:
+    // Подключенное I2C устройство и его состояние
+    struct AttachedDevice {
+        const SensorDriver* driver;
+        uint8_t address;
+        DeviceHealth health;
+    };
+    
+    static const ControlChannel CHANNELS[];
+    
     void initializePins();
     void discoverI2CDevices();
     void initializeDetectedDevices();
-    bool initializeBME280(uint8_t address);
-    bool initializeBH1750(uint8_t address);
+    bool initializeDevice(AttachedDevice& device);
     bool initializeSoilSensors();
-    void initializeLEDMatrix();
     void identifyUnknownDevice(uint8_t address);
     
-    void readBME280();
-    void readBH1750();
-    void readSoilSensors();
+    bool probeAddress(uint8_t address);
+    const SensorDriver* matchDriver(uint8_t address, bool attachableOnly);
+    AttachedDevice* attachDevice(const SensorDriver& driver, uint8_t address);
+    bool isAttached(uint8_t address) const;
+    void syncHealthFlags(AttachedDevice& device);
+    void logHealthChange(const char* name, const DeviceHealth& health);
+    void scanStep();
+    
+    void readDevice(AttachedDevice& device);
+    void recordOutput(ControlDevice device, int16_t value, ControlCause cause);
+    void applyCommand(const ControlCommand& command, ControlCause cause);
+    void setTimer(ControlDevice device, unsigned long durationMs);
+    void updateTimers();
+    void updateDoor();
+    
+    void applyPump(int16_t value, ControlCause cause);
+    void applyFan(int16_t value, ControlCause cause);
+    void applyHeater(int16_t value, ControlCause cause);
+    void applyLight(int16_t value, ControlCause cause);
+    void applyDoor(int16_t value, ControlCause cause);
+    bool readSoilSensors();
     
     bool devicesInitialized = false;
-    unsigned long pumpStartTime = 0;
-    unsigned long pumpDuration = 0;
-    bool pumpAutoStop = false;
+    uint8_t doorAngle = Constants::DOOR_NEUTRAL_ANGLE;
+    bool doorMoving = false;
+    unsigned long doorMoveStart = 0;
+    uint8_t lightBrightness = Constants::LED_DEFAULT_BRIGHTNESS;
+    
+    // Таймеры автоотключения выходов (длительность 0 - таймер не активен)
+    unsigned long timerStart[(uint8_t)ControlDevice::UNKNOWN] = {};
+    unsigned long timerDuration[(uint8_t)ControlDevice::UNKNOWN] = {};
+    
+    AttachedDevice attachedDevices[MAX_ATTACHED_DEVICES];
+    uint8_t attachedCount = 0;
+    
+    // Фоновое полное сканирование шины (0 - не выполняется)
+    uint8_t scanAddress = 0;
+    uint8_t scanFoundCount = 0;
+    
+    DeviceHealth soilHealth;
+    unsigned long lastRescan = 0;
     
-    uint16_t bme280ErrorCount = 0;
-    uint16_t bh1750ErrorCount = 0;
-    uint16_t soilSensorErrorCount = 0;
+    ActuatorHistory history;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#ifndef DEVICE_NAMES_H
+#define DEVICE_NAMES_H
+
+#include "FixedString.h"
+
+// Управляемые через API устройства
+enum class ControlDevice : uint8_t {
+    PUMP,
+    FAN,
+    HEATER,
+    LIGHT,
+    DOOR,
+    UNKNOWN
+};
+
+// Имя устройства -> enum через совершенный хеш: одна проверка таблицы
+// и одно сравнение строк вместо цепочки сравнений.
+namespace DeviceNames {
+  struct Entry {
+    const char* name;
+    ControlDevice device;
+  };
+
+  constexpr uint8_t TABLE_SIZE = 8;
+
+  // (первый символ + 3 * длина) mod 8 не дает коллизий на наборе имен
+  constexpr uint8_t hash(StringView name) {
+    return name.empty() ? 0 : (uint8_t)(name[0] + 3 * name.length()) & (TABLE_SIZE - 1);
+  }
+
+  constexpr Entry TABLE[TABLE_SIZE] = {
+    {"door", ControlDevice::DOOR},       // 0
+    {nullptr, ControlDevice::UNKNOWN},   // 1
+    {"heater", ControlDevice::HEATER},   // 2
+    {"light", ControlDevice::LIGHT},     // 3
+    {"pump", ControlDevice::PUMP},       // 4
+    {nullptr, ControlDevice::UNKNOWN},   // 5
+    {nullptr, ControlDevice::UNKNOWN},   // 6
+    {"fan", ControlDevice::FAN},         // 7
+  };
+
+  constexpr bool tableIsPerfect(uint8_t slot = 0) {
+    return slot == TABLE_SIZE ||
+           ((!TABLE[slot].name || hash(TABLE[slot].name) == slot) && tableIsPerfect(slot + 1));
+  }
+  static_assert(tableIsPerfect(), "DeviceNames::TABLE does not match hash()");
+
+  constexpr ControlDevice parse(StringView name) {
+    return (TABLE[hash(name)].name && StringView(TABLE[hash(name)].name) == name)
+               ? TABLE[hash(name)].device
+               : ControlDevice::UNKNOWN;
+  }
+
+  constexpr const char* name(ControlDevice device) {
+    return device == ControlDevice::PUMP ? "pump" :
+           device == ControlDevice::FAN ? "fan" :
+           device == ControlDevice::HEATER ? "heater" :
+           device == ControlDevice::LIGHT ? "light" :
+           device == ControlDevice::DOOR ? "door" : "unknown";
+  }
+
+  static_assert(parse("pump") == ControlDevice::PUMP, "pump");
+  static_assert(parse("door") == ControlDevice::DOOR, "door");
+  static_assert(parse("dial") == ControlDevice::UNKNOWN, "unknown name");
+}
+
+#endif
@@ -1,220 +1,301 @@
 #include "DisplayManager.h"
-#include <TM1637Display.h>
 #include "Config.h"
+#include "ControlStatus.h"
 #include "GlobalInstances.h"
-
-// Создаем экземпляр дисплея
-TM1637Display display(Pins::TM1637_CLK, Pins::TM1637_DIO);
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "Profiler.h"
 
 void DisplayManager::begin() {
-    Serial.println("🔧 Initializing TM1637 Display...");
+    LOG_INFO("🔧 Initializing TM1637 Display...");
     
     // Тест 1: Проверка подключения
-    Serial.print("  Testing display connection... ");
-    display.setBrightness(7);
-    display.clear();
+    screen.setBrightness(7);
+    screen.clear();
+    screen.flush();
     
     // Простой тест - все сегменты
     uint8_t testSegments[] = {0xff, 0xff, 0xff, 0xff};
-    display.setSegments(testSegments);
+    screen.setAll(testSegments);
+    screen.flush();
     delay(500);
     
     // Тест 2: Числа
-    display.showNumberDec(8888, true);
+    screen.printNumber(8888, true);
+    screen.flush();
     delay(500);
     
     // Тест 3: Текст
-    uint8_t textSegments[] = {
-        SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,  // 0
-        SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,  // 0
-        SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F,  // 0
-        SEG_A | SEG_B | SEG_C | SEG_D | SEG_E | SEG_F   // 0
-    };
-    display.setSegments(textSegments);
+    screen.print("0000");
+    screen.flush();
     delay(500);
     
     // Очистка
-    display.clear();
+    screen.clear();
+    screen.flush();
     
-    Serial.println("✅ OK");
-    Serial.println("✅ TM1637 Display initialization complete");
-}
-
-void DisplayManager::updateDisplay(const SensorData& data, const SystemSettings& settings) {
-    // Смена режима каждые 3 секунды
-    if (millis() - lastModeChange > 3000) {
-        currentMode = (currentMode + 1) % displayModes;
-        lastModeChange = millis();
-        
-        Serial.print("🔄 Display mode changed to: ");
-        switch(currentMode) {
-            case 0: Serial.println("Temperature"); break;
-            case 1: Serial.println("Humidity"); break;
-            case 2: Serial.println("Soil Temperature"); break;
-            case 3: Serial.println("Soil Moisture"); break;
-        }
+    LOG_INFO("✅ TM1637 Display initialization complete");
+}
+
+// ===== Реестр страниц =====
+// render заполняет текст и возвращает false, если страницу сейчас
+// показывать нечего (нет данных, тревога неактивна)
+struct DisplayPage {
+    const char* name;
+    uint8_t priority;      // 0 - обычная страница, иначе тревога; старшая вытесняет младшие
+    bool (*render)(const SensorData& data, DisplayManager::PageText& text);
+};
+
+static void appendValue(DisplayManager::PageText& text, float value, const char* unit) {
+    text.appendf("%.1f", value);
+    text += unit;
+}
+
+// Неподтвержденные тревоги: "A05 HI A18 StUC"; подтвержденные не вытесняют страницы
+static bool alarmAlert(const SensorData& data, DisplayManager::PageText& text) {
+    static const char* const KIND_CODES[] = {"LO", "HI", "StALE", "StUC"};
+    for (uint8_t id = statusView.alarms.nextActive(AlarmEngine::NONE); id != AlarmEngine::NONE;
+         id = statusView.alarms.nextActive(id)) {
+        if (statusView.alarms.getState(id) == AlarmState::ACKNOWLEDGED) continue;
+        if (!text.empty()) text += ' ';
+        text.appendf("A%02u %s", id, KIND_CODES[(uint8_t)AlarmEngine::kindOf(id)]);
     }
-    
-    showNextMode(data, settings);
-}
-
-void DisplayManager::showNextMode(const SensorData& data, const SystemSettings& settings) {
-    switch(currentMode) {
-        case 0: // Температура воздуха
-            if (!isnan(data.airTemperature)) {
-                showTemperature(data.airTemperature);
-            } else {
-                showError("Err");
-            }
-            break;
-            
-        case 1: // Влажность воздуха
-            if (!isnan(data.airHumidity)) {
-                showHumidity(data.airHumidity);
-            } else {
-                showError("Err");
-            }
-            break;
-            
-        case 2: // Температура почвы
-            if (!isnan(data.soilTemperature)) {
-                showTemperature(data.soilTemperature);
-            } else {
-                showError("Err");
-            }
-            break;
-            
-        case 3: // Влажность почвы
-            if (!isnan(data.soilMoisture)) {
-                showHumidity(data.soilMoisture);
-            } else {
-                showError("Err");
-            }
-            break;
+    return !text.empty();
+}
+
+static bool sensorAlert(const SensorData& data, DisplayManager::PageText& text) {
+    if (data.systemHealthy) return false;
+    text = "E1";
+    if (statusView.devices.hasBME280 && !statusView.devices.bme280Healthy) text += " bME";
+    if (statusView.devices.hasBH1750 && !statusView.devices.bh1750Healthy) text += " LIGHt";
+    if (statusView.devices.hasSoilSensors && !statusView.devices.soilSensorsHealthy) text += " SoIL";
+    return true;
+}
+
+static bool crossCheckAlert(const SensorData& data, DisplayManager::PageText& text) {
+    if (!statusView.crossCheckFailed) return false;
+    text = "E2 tEMP";
+    return true;
+}
+
+static bool heapAlert(const SensorData& data, DisplayManager::PageText& text) {
+    if (!heapMonitor.isFragmenting()) return false;
+    text = "E3 HEAP";
+    return true;
+}
+
+static bool airTemperature(const SensorData& data, DisplayManager::PageText& text) {
+    if (!data.airTemperature.isValid()) return false;
+    appendValue(text, data.airTemperature.toFloat(), "*C");
+    return true;
+}
+
+static bool airHumidity(const SensorData& data, DisplayManager::PageText& text) {
+    if (!data.airHumidity.isValid()) return false;
+    text = "HU ";
+    appendValue(text, data.airHumidity.toFloat(), "");
+    return true;
+}
+
+static bool pressure(const SensorData& data, DisplayManager::PageText& text) {
+    if (!data.pressure.isValid()) return false;
+    text = "PrES ";
+    appendValue(text, data.pressure.toFloat(), "");
+    return true;
+}
+
+static bool soilTemperature(const SensorData& data, DisplayManager::PageText& text) {
+    if (!data.soilTemperature.isValid()) return false;
+    text = "SoIL ";
+    appendValue(text, data.soilTemperature.toFloat(), "*C");
+    return true;
+}
+
+static bool soilMoisture(const SensorData& data, DisplayManager::PageText& text) {
+    if (!data.soilMoisture.isValid()) return false;
+    text = "SoIL HU ";
+    appendValue(text, data.soilMoisture.toFloat(), "");
+    return true;
+}
+
+static bool lightLevel(const SensorData& data, DisplayManager::PageText& text) {
+    if (!data.lightLevel.isValid()) return false;
+    text.appendf("LUH %u", (unsigned)data.lightLevel.raw());
+    return true;
+}
+
+// Выходы по реестру каналов: первая буква имени и значение
+static bool outputs(const SensorData& data, DisplayManager::PageText& text) {
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        const DeviceManager::ControlChannel& channel = DeviceManager::getChannel(i);
+        if (i > 0) text += ' ';
+        text += DeviceNames::name(channel.id)[0];
+        text.appendf("%d", statusView.channelValue[(uint8_t)channel.id]);
     }
+    return true;
 }
 
-void DisplayManager::showTemperature(float temp) {
-    if (isnan(temp) || temp < -50 || temp > 100) {
-        showError("Err");
-        return;
+static bool energyToday(const SensorData& data, DisplayManager::PageText& text) {
+    text.appendf("En %.2f", statusView.energy.getTotalEnergyKWh(EnergyPeriod::DAY));
+    return true;
+}
+
+static bool waterToday(const SensorData& data, DisplayManager::PageText& text) {
+    text.appendf("H2O %d", (int)statusView.energy.getWaterLitres(EnergyPeriod::DAY));
+    return true;
+}
+
+static bool address(const SensorData& data, DisplayManager::PageText& text) {
+    IPAddress ip = WiFi.status() == WL_CONNECTED ? WiFi.localIP() : WiFi.softAPIP();
+    text.appendf("IP %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    return true;
+}
+
+static const DisplayPage PAGES[] = {
+    {"alarms",           4, alarmAlert},
+    {"sensor failure",   3, sensorAlert},
+    {"temp cross-check", 2, crossCheckAlert},
+    {"heap",             1, heapAlert},
+    {"air temperature",  0, airTemperature},
+    {"air humidity",     0, airHumidity},
+    {"pressure",         0, pressure},
+    {"soil temperature", 0, soilTemperature},
+    {"soil moisture",    0, soilMoisture},
+    {"light",            0, lightLevel},
+    {"outputs",          0, outputs},
+    {"energy today",     0, energyToday},
+    {"water today",      0, waterToday},
+    {"ip",               0, address},
+};
+
+static constexpr uint8_t PAGE_COUNT = sizeof(PAGES) / sizeof(PAGES[0]);
+
+// Следующая по кругу после after показываемая страница своего вида
+static uint8_t findPage(const SensorData& data, uint8_t after, bool alert, DisplayManager::PageText& text) {
+    uint8_t start = after < PAGE_COUNT ? after : PAGE_COUNT - 1;
+    for (uint8_t step = 1; step <= PAGE_COUNT; step++) {
+        uint8_t index = (start + step) % PAGE_COUNT;
+        if ((PAGES[index].priority > 0) != alert) continue;
+        text.clear();
+        if (PAGES[index].render(data, text)) return index;
     }
+    return PAGE_COUNT;
+}
+
+// ===== Движок страниц =====
+void DisplayManager::update(const SensorData& data) {
+    unsigned long now = millis();
+    if (now - lastFrame < Constants::DISPLAY_FRAME_INTERVAL) return;
+    lastFrame = now;
+    
+    PROFILE_SCOPE(DISPLAY);
+    HEAP_SCOPE(DISPLAY);
     
-    int tempInt = round(temp);
+    PageText text;
+    uint8_t current = currentPage < PAGE_COUNT ? currentPage : PAGE_COUNT;
     
-    if (tempInt >= 0 && tempInt < 100) {
-        // Положительная температура 0-99
-        display.showNumberDecEx(tempInt, 0b01100000, false, 2, 0);
-        
-        uint8_t segments[4];
-        if (tempInt >= 10) {
-            segments[0] = display.encodeDigit(tempInt / 10);
-            segments[1] = display.encodeDigit(tempInt % 10);
+    // Старшая активная тревога вытесняет текущую страницу сразу
+    uint8_t alert = findPage(data, NO_PAGE, true, text);
+    if (alert < PAGE_COUNT && (current == PAGE_COUNT || PAGES[alert].priority > PAGES[current].priority)) {
+        startPage(alert, text, now);
+    } else if (current == PAGE_COUNT || pageFinished(now)) {
+        // Пока есть тревоги, показываются только они
+        uint8_t next = alert < PAGE_COUNT ? findPage(data, current, true, text)
+                                          : findPage(data, rotationPage, false, text);
+        if (next == PAGE_COUNT) {
+            currentPage = NO_PAGE;
+            screen.clear();
+            screen.flush();
+            return;
+        }
+        if (alert == PAGE_COUNT) rotationPage = next;
+        startPage(next, text, now);
+    } else if (glyphCount <= SegmentDisplay::DIGITS &&
+               now - lastRender >= Constants::DISPLAY_REFRESH_INTERVAL) {
+        // Неподвижная страница обновляет значение; прокручиваемая - нет,
+        // иначе строка сдвинется под бегущим окном
+        text.clear();
+        if (!PAGES[current].render(data, text)) {
+            pageStart = now - Constants::DISPLAY_PAGE_DWELL;   // данные пропали - к следующей
         } else {
-            segments[0] = 0;
-            segments[1] = display.encodeDigit(tempInt);
+            glyphCount = SegmentFont::encode(text, glyphs, sizeof(glyphs));
         }
-        segments[2] = SEG_A | SEG_B | SEG_G | SEG_F;  // °
-        segments[3] = SEG_A | SEG_D | SEG_E | SEG_F;  // C
-        display.setSegments(segments);
-    } else if (tempInt < 0 && tempInt > -10) {
-        // Отрицательная температура -1 до -9
-        uint8_t segments[4];
-        segments[0] = 0b01000000; // Минус
-        segments[1] = display.encodeDigit(abs(tempInt));
-        segments[2] = SEG_A | SEG_B | SEG_G | SEG_F;  // °
-        segments[3] = SEG_A | SEG_D | SEG_E | SEG_F;  // C
-        display.setSegments(segments);
-    } else {
-        showError("OOR"); // Out Of Range
+        lastRender = now;
     }
+    
+    drawFrame(now);
 }
 
-void DisplayManager::showHumidity(float hum) {
-    if (isnan(hum) || hum < 0 || hum > 100) {
-        showError("Err");
-        return;
+void DisplayManager::startPage(uint8_t index, const PageText& text, unsigned long now) {
+    if (index != currentPage) {
+        LOG_DEBUG("🔄 Display page: %s", PAGES[index].name);
     }
-    
-    int humInt = round(hum);
-    
-    if (humInt >= 0 && humInt <= 100) {
-        if (humInt == 100) {
-            // 100%
-            uint8_t segments[4];
-            segments[0] = display.encodeDigit(1);
-            segments[1] = display.encodeDigit(0);
-            segments[2] = display.encodeDigit(0);
-            segments[3] = SEG_A | SEG_B | SEG_E | SEG_F | SEG_G;  // P
-            display.setSegments(segments);
-        } else if (humInt >= 10) {
-            // 10-99%
-            display.showNumberDecEx(humInt, 0b01000000, false, 2, 0);
-            
-            uint8_t segments[4];
-            segments[0] = display.encodeDigit(humInt / 10);
-            segments[1] = display.encodeDigit(humInt % 10);
-            segments[2] = SEG_A | SEG_B | SEG_E | SEG_F | SEG_G;  // P
-            segments[3] = 0;
-            display.setSegments(segments);
-        } else {
-            // 0-9%
-            uint8_t segments[4];
-            segments[0] = 0;
-            segments[1] = display.encodeDigit(humInt);
-            segments[2] = SEG_A | SEG_B | SEG_E | SEG_F | SEG_G;  // P
-            segments[3] = 0;
-            display.setSegments(segments);
-        }
-    } else {
-        showError("OOR");
+    currentPage = index;
+    pageStart = now;
+    lastRender = now;
+    glyphCount = SegmentFont::encode(text, glyphs, sizeof(glyphs));
+}
+
+bool DisplayManager::pageFinished(unsigned long now) const {
+    unsigned long duration = Constants::DISPLAY_PAGE_DWELL;
+    if (glyphCount > SegmentDisplay::DIGITS) {
+        // Пауза на первом кадре, прокрутка и пауза на последнем
+        unsigned long scroll = 2 * Constants::DISPLAY_SCROLL_HOLD +
+                               (glyphCount - SegmentDisplay::DIGITS) * Constants::DISPLAY_SCROLL_STEP;
+        if (scroll > duration) duration = scroll;
     }
+    return now - pageStart >= duration;
 }
 
-void DisplayManager::showMessage(const String& message) {
-    Serial.println("📟 Display message: " + message);
+// Кадр - окно из DIGITS знаков в готовом буфере; на шину уходят
+// только изменившиеся знакоместа
+void DisplayManager::drawFrame(unsigned long now) {
+    uint8_t offset = 0;
+    unsigned long elapsed = now - pageStart;
+    if (glyphCount > SegmentDisplay::DIGITS && elapsed > Constants::DISPLAY_SCROLL_HOLD) {
+        unsigned long steps = (elapsed - Constants::DISPLAY_SCROLL_HOLD) / Constants::DISPLAY_SCROLL_STEP;
+        uint8_t last = glyphCount - SegmentDisplay::DIGITS;
+        offset = steps < last ? steps : last;
+    }
     
-    if (message.length() == 4) {
-        uint8_t segments[4];
-        for (int i = 0; i < 4; i++) {
-            char c = message.charAt(i);
-            segments[i] = display.encodeDigit(c);
-        }
-        display.setSegments(segments);
-    } else {
-        showNumber(message.toInt());
+    for (uint8_t i = 0; i < SegmentDisplay::DIGITS; i++) {
+        uint8_t position = offset + i;
+        screen.set(i, position < glyphCount ? glyphs[position] : 0);
     }
+    screen.flush();
+}
+
+void DisplayManager::showMessage(StringView message) {
+    LOG_DEBUG("📟 Display message: %.*s", (int)message.length(), message.data());
+    screen.print(message);
+    screen.flush();
 }
 
 void DisplayManager::showNumber(int number, bool leadingZero) {
-    display.showNumberDec(number, leadingZero);
+    screen.printNumber(number, leadingZero);
+    screen.flush();
 }
 
 void DisplayManager::showLoading(uint8_t step) {
     uint8_t loading[4] = {0};
     uint8_t pos = step % 4;
-    loading[pos] = 0b01000000; // Мигающая точка
-    
-    display.setSegments(loading);
+    loading[pos] = SegmentFont::MINUS; // Бегущая черта
+    render(loading);
 }
 
 void DisplayManager::setBrightness(uint8_t brightness) {
     brightness = constrain(brightness, 0, 7);
-    display.setBrightness(brightness);
-    Serial.println("🔆 Display brightness: " + String(brightness));
+    screen.setBrightness(brightness);
+    screen.flush();
+    LOG_INFO("🔆 Display brightness: %d", brightness);
 }
 
 void DisplayManager::clear() {
-    display.clear();
+    screen.clear();
+    screen.flush();
 }
 
-void DisplayManager::showError(const String& error) {
-    Serial.println("❌ Display error: " + error);
-    
-    uint8_t segments[4];
-    for (int i = 0; i < 4 && i < error.length(); i++) {
-        char c = error.charAt(i);
-        segments[i] = display.encodeDigit(c);
-    }
-    display.setSegments(segments);
-}
\ No newline at end of file
+void DisplayManager::render(const uint8_t* segments) {
+    screen.setAll(segments);
+    screen.flush();
+}
@@ -2,30 +2,41 @@
 #define DISPLAY_MANAGER_H
 
 #include "Config.h"
+#include "SegmentDisplay.h"
 
+// Страницы индикатора: обычные сменяют друг друга по кругу, тревоги
+// (коды ошибок) вытесняют их, пока активны. Текст длиннее 4 знаков
+// прокручивается. update() вызывается на каждом проходе loop() и
+// рисует кадр не чаще DISPLAY_FRAME_INTERVAL.
 class DisplayManager {
 public:
+    using PageText = FixedString<32>;
+
     void begin();
-    void updateDisplay(const SensorData& data, const SystemSettings& settings);
-    void showMessage(const String& message);
+    void update(const SensorData& data);
+    void showMessage(StringView message);
     void showNumber(int number, bool leadingZero = true);
-    void showTemperature(float temp);
-    void showHumidity(float hum);
     void showLoading(uint8_t step);
     void setBrightness(uint8_t brightness);
     void clear();
-    
+
 private:
-    void showNextMode(const SensorData& data, const SystemSettings& settings);
-    void showError(const String& error);
-    
-    unsigned long lastModeChange = 0;
-    uint8_t currentMode = 0;
-    uint8_t displayModes = 4;
-    
-    // Используем другие имена для сегментов чтобы избежать конфликтов
-    static const uint8_t SEG_DEGREE[];
-    static const uint8_t SEG_CELSIUS[];
-    static const uint8_t SEG_PERCENT[];
+    void startPage(uint8_t index, const PageText& text, unsigned long now);
+    bool pageFinished(unsigned long now) const;
+    void drawFrame(unsigned long now);
+    void render(const uint8_t* segments);
+
+    SegmentDisplay screen{Pins::TM1637_CLK, Pins::TM1637_DIO};
+
+    // Сегменты всей строки текущей страницы; кадр прокрутки - окно в DIGITS знаков
+    uint8_t glyphs[32] = {};
+    uint8_t glyphCount = 0;
+
+    static constexpr uint8_t NO_PAGE = 0xFF;
+    uint8_t currentPage = NO_PAGE;
+    uint8_t rotationPage = NO_PAGE;
+    unsigned long pageStart = 0;
+    unsigned long lastFrame = 0;
+    unsigned long lastRender = 0;
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,85 @@
+#include "DoorMonitor.h"
+#include "GlobalInstances.h"
+#include "Logger.h"
+#include "PowerManager.h"
+
+void DoorMonitor::begin() {
+    bool level = readOpen();
+    isrOpen.store(level);
+    open = level;
+    openSince = millis();
+    sensorData.doorState = open;
+
+    attachInterrupt(digitalPinToInterrupt(Pins::DOOR_SENSOR), onEdge, CHANGE);
+    LOG_INFO("🚪 Door monitor on GPIO %d (interrupt), door %s", Pins::DOOR_SENSOR, open ? "open" : "closed");
+}
+
+void IRAM_ATTR DoorMonitor::onEdge() {
+    doorMonitor.capture();
+    powerManager.wakeFromISR();
+}
+
+bool IRAM_ATTR DoorMonitor::readOpen() {
+    return digitalRead(Pins::DOOR_SENSOR) == LOW;
+}
+
+// Фронты внутри окна антидребезга отбрасываются; если дребезг закончился
+// на отброшенном фронте, уровень досверяет update()
+void IRAM_ATTR DoorMonitor::capture() {
+    uint32_t now = millis();
+    lastEdge.store(now, std::memory_order_relaxed);
+    unsettled.store(true, std::memory_order_release);
+
+    bool level = readOpen();
+    if (level == isrOpen.load(std::memory_order_relaxed) || now - isrAccepted < Constants::DOOR_DEBOUNCE_MS) return;
+    isrOpen.store(level, std::memory_order_relaxed);
+    isrAccepted = now;
+    if (!queue.push({now, level})) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool DoorMonitor::update(SensorData& data) {
+    bool wasOpen = open;
+
+    DoorEvent event;
+    while (queue.pop(event)) {
+        apply(event);
+    }
+
+    uint32_t now = millis();
+    if (unsettled.load(std::memory_order_acquire) &&
+        now - lastEdge.load(std::memory_order_relaxed) >= Constants::DOOR_DEBOUNCE_MS) {
+        unsettled.store(false, std::memory_order_relaxed);
+        bool level = readOpen();
+        // Уровень ISR меняется, только если его не обновил новый фронт
+        bool expected = !level;
+        if (isrOpen.compare_exchange_strong(expected, level)) {
+            apply({now, level});
+        }
+    }
+
+    data.doorState = open;
+    return open != wasOpen;
+}
+
+void DoorMonitor::apply(const DoorEvent& event) {
+    if (event.open == open) return;
+    open = event.open;
+
+    if (open) {
+        openSince = event.timeMs;
+        openCount++;
+        LOG_INFO("🚪 Door opened");
+    } else {
+        uint32_t duration = event.timeMs - openSince;
+        totalOpenMs += duration;
+        lastOpenMs = duration;
+        if (duration > longestOpenMs) longestOpenMs = duration;
+        LOG_INFO("🚪 Door closed after %lu s", (unsigned long)(duration / 1000));
+    }
+}
+
+uint32_t DoorMonitor::getTotalOpenMs() const {
+    return open ? totalOpenMs + (millis() - openSince) : totalOpenMs;
+}
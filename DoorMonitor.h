@@ -0,0 +1,56 @@
+#ifndef DOOR_MONITOR_H
+#define DOOR_MONITOR_H
+
+#include <atomic>
+#include "Config.h"
+#include "SpscQueue.h"
+
+struct DoorEvent {
+    uint32_t timeMs;
+    bool open;
+};
+
+// Датчик двери на прерывании: обработчик фиксирует фронты с меткой времени
+// в кольцевой очереди без блокировок (один писатель - ISR, один читатель -
+// цикл управления). Пока дверь не трогают, update() только сравнивает два индекса.
+class DoorMonitor {
+public:
+    static constexpr uint8_t QUEUE_SIZE = 16;   // степень двойки
+
+    void begin();
+    // Разбирает накопленные события; true - состояние двери изменилось
+    bool update(SensorData& data);
+
+    bool isOpen() const { return open; }
+    uint32_t getOpenCount() const { return openCount; }
+    uint32_t getTotalOpenMs() const;
+    uint32_t getLastOpenMs() const { return lastOpenMs; }
+    uint32_t getLongestOpenMs() const { return longestOpenMs; }
+    uint32_t getDroppedEvents() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    static void onEdge();
+    void capture();
+    void apply(const DoorEvent& event);
+
+    static bool readOpen();
+
+    SpscQueue<DoorEvent, QUEUE_SIZE> queue; // пишет ISR, читает цикл управления
+    std::atomic<uint32_t> dropped{0};
+
+    // Состояние на стороне ISR: последний принятый уровень и время фронта
+    std::atomic<bool> isrOpen{false};
+    uint32_t isrAccepted = 0;
+    std::atomic<uint32_t> lastEdge{0};
+    std::atomic<bool> unsettled{false};
+
+    // Состояние на стороне loop
+    bool open = false;
+    uint32_t openSince = 0;
+    uint32_t openCount = 0;
+    uint32_t totalOpenMs = 0;
+    uint32_t lastOpenMs = 0;
+    uint32_t longestOpenMs = 0;
+};
+
+#endif
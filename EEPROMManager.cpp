@@ -1,38 +1,40 @@
 #include "EEPROMManager.h"
 #include "Config.h"
 #include "GlobalInstances.h"
+#include "Logger.h"
 
 void EEPROMManager::begin() {
     EEPROM.begin(EEPROM_SIZE);
-    Serial.println("✅ EEPROM Manager initialized");
+    LOG_INFO("✅ EEPROM Manager initialized");
 }
 
 bool EEPROMManager::loadSettings(SystemSettings& settings) {
-    Serial.println("📖 Loading settings from EEPROM...");
+    LOG_INFO("📖 Loading settings from EEPROM...");
     
     EEPROM.get(SETTINGS_ADDRESS, settings);
     
-    if (!validateSettings(settings)) {
-        Serial.println("❌ Invalid settings in EEPROM, using defaults");
-        return false;
+    // Миграция настроек при необходимости (до проверки - она требует текущую версию)
+    if (settings.version >= 1 && settings.version < CONFIG_VERSION) {
+        LOG_INFO("🔄 Migrating settings from version %d to %d", 
+                 settings.version, CONFIG_VERSION);
+        migrateSettings(settings, settings.version);
+        if (validateSettings(settings)) saveSettings(settings);
     }
     
-    // Миграция настроек при необходимости
-    if (settings.version != CONFIG_VERSION) {
-        Serial.printf("🔄 Migrating settings from version %d to %d\n", 
-                     settings.version, CONFIG_VERSION);
-        migrateSettings(settings, settings.version);
-        saveSettings(settings);
+    if (!validateSettings(settings)) {
+        LOG_ERROR("❌ Invalid settings in EEPROM, using defaults");
+        settings = SystemSettings();
+        return false;
     }
     
-    Serial.println("✅ Settings loaded successfully");
+    LOG_INFO("✅ Settings loaded successfully");
     printSettings(settings);
     return true;
 }
 
 bool EEPROMManager::saveSettings(const SystemSettings& settings) {
     if (!validateSettings(settings)) {
-        Serial.println("❌ Invalid settings, not saving");
+        LOG_ERROR("❌ Invalid settings, not saving");
         return false;
     }
     
@@ -40,9 +42,9 @@ bool EEPROMManager::saveSettings(const SystemSettings& settings) {
     bool success = EEPROM.commit();
     
     if (success) {
-        Serial.println("💾 Settings saved successfully");
+        LOG_INFO("💾 Settings saved successfully");
     } else {
-        Serial.println("❌ Failed to save settings to EEPROM");
+        LOG_ERROR("❌ Failed to save settings to EEPROM");
     }
     
     return success;
@@ -70,6 +72,32 @@ bool EEPROMManager::validateSettings(const SystemSettings& settings) {
         return false;
     }
     
+    if (settings.mqttPort == 0 || memchr(settings.mqttHost, '\0', sizeof(settings.mqttHost)) == nullptr) {
+        return false;
+    }
+    
+    if (settings.pumpPowerW > Constants::MAX_RATED_POWER || settings.fanPowerW > Constants::MAX_RATED_POWER ||
+        settings.heaterPowerW > Constants::MAX_RATED_POWER || settings.lightPowerW > Constants::MAX_RATED_POWER ||
+        settings.pumpFlowRate > Constants::MAX_PUMP_FLOW) {
+        return false;
+    }
+    
+    if (settings.growProfile >= (uint8_t)GrowProfile::COUNT) {
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        if (!AlarmEngine::thresholdInRange((SensorChannel)i, settings.alarmLow[i]) ||
+            !AlarmEngine::thresholdInRange((SensorChannel)i, settings.alarmHigh[i])) {
+            return false;
+        }
+    }
+    
+    if (settings.telemetryPort == 0 ||
+        settings.telemetryInterval < 1 || settings.telemetryInterval > 3600) {
+        return false;
+    }
+    
     return true;
 }
 
@@ -86,7 +114,64 @@ void EEPROMManager::migrateSettings(SystemSettings& settings, uint8_t fromVersio
             // Миграция с версии 2 на 3
             settings.soilMoistureSetpoint = 50.0;
             settings.version = 3;
+            // Продолжаем миграцию
+            
+        case 3: {
+            // Миграция с версии 3 на 4: новые поля телеметрии
+            SystemSettings defaults;
+            settings.telemetryEnabled = defaults.telemetryEnabled;
+            settings.telemetryPort = defaults.telemetryPort;
+            settings.telemetryInterval = defaults.telemetryInterval;
+            settings.version = 4;
+            // Продолжаем миграцию
+        }
+            
+        case 4: {
+            // Миграция с версии 4 на 5: настройки MQTT
+            SystemSettings defaults;
+            settings.mqttEnabled = defaults.mqttEnabled;
+            strlcpy(settings.mqttHost, defaults.mqttHost, sizeof(settings.mqttHost));
+            settings.mqttPort = defaults.mqttPort;
+            settings.version = 5;
+            // Продолжаем миграцию
+        }
+            
+        case 5: {
+            // Миграция с версии 5 на 6: мощности выходов для учета энергии
+            SystemSettings defaults;
+            settings.pumpPowerW = defaults.pumpPowerW;
+            settings.fanPowerW = defaults.fanPowerW;
+            settings.heaterPowerW = defaults.heaterPowerW;
+            settings.lightPowerW = defaults.lightPowerW;
+            settings.pumpFlowRate = defaults.pumpFlowRate;
+            settings.version = 6;
+            // Продолжаем миграцию
+        }
+            
+        case 6: {
+            // Миграция с версии 6 на 7: профиль фитосвета
+            SystemSettings defaults;
+            settings.growProfile = defaults.growProfile;
+            settings.version = 7;
+            // Продолжаем миграцию
+        }
+            
+        case 7: {
+            // Миграция с версии 7 на 8: пороги тревог
+            SystemSettings defaults;
+            memcpy(settings.alarmLow, defaults.alarmLow, sizeof(settings.alarmLow));
+            memcpy(settings.alarmHigh, defaults.alarmHigh, sizeof(settings.alarmHigh));
+            settings.version = 8;
+            // Продолжаем миграцию
+        }
+            
+        case 8: {
+            // Миграция с версии 8 на 9: режим пониженного потребления
+            SystemSettings defaults;
+            settings.lowPowerMode = defaults.lowPowerMode;
+            settings.version = 9;
             break;
+        }
             
         default:
             // Неизвестная версия - сброс к defaults
@@ -95,22 +180,66 @@ void EEPROMManager::migrateSettings(SystemSettings& settings, uint8_t fromVersio
     }
 }
 
+bool EEPROMManager::loadEnergy(EnergyRecord& record) {
+    EEPROM.get(ENERGY_ADDRESS, record);
+    
+    if (record.magic != ENERGY_MAGIC || record.checksum != energyChecksum(record)) {
+        LOG_WARN("⚠️ No valid energy record in EEPROM");
+        return false;
+    }
+    return true;
+}
+
+bool EEPROMManager::saveEnergy(EnergyRecord& record) {
+    record.magic = ENERGY_MAGIC;
+    record.checksum = energyChecksum(record);
+    
+    EEPROM.put(ENERGY_ADDRESS, record);
+    bool success = EEPROM.commit();
+    
+    if (success) {
+        LOG_DEBUG("💾 Energy counters saved");
+    } else {
+        LOG_ERROR("❌ Failed to save energy counters to EEPROM");
+    }
+    
+    return success;
+}
+
+// FNV-1a по всем байтам записи, кроме самой контрольной суммы
+uint32_t EEPROMManager::energyChecksum(const EnergyRecord& record) {
+    const uint8_t* bytes = (const uint8_t*)&record;
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(EnergyRecord, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
 void EEPROMManager::resetToDefaults() {
     SystemSettings defaults;
     saveSettings(defaults);
-    Serial.println("🔄 EEPROM reset to default values");
+    LOG_INFO("🔄 EEPROM reset to default values");
 }
 
 void EEPROMManager::printSettings(const SystemSettings& settings) {
-    Serial.println("\n=== Current Settings ===");
-    Serial.printf("Version: %d\n", settings.version);
-    Serial.printf("WiFi SSID: %s\n", settings.wifiSSID);
-    Serial.printf("Temperature Setpoint: %.1f°C\n", settings.tempSetpoint);
-    Serial.printf("Humidity Setpoint: %.1f%%\n", settings.humSetpoint);
-    Serial.printf("Soil Moisture Setpoint: %.1f%%\n", settings.soilMoistureSetpoint);
-    Serial.printf("Light Schedule: %02d:00 - %02d:00\n", 
-                  settings.lightOnHour, settings.lightOffHour);
-    Serial.printf("Automation: %s\n", settings.automationEnabled ? "Enabled" : "Disabled");
-    Serial.printf("Display Brightness: %d\n", settings.displayBrightness);
-    Serial.println("========================\n");
+    LOG_INFO("=== Current Settings ===");
+    LOG_INFO("Version: %d", settings.version);
+    LOG_INFO("WiFi SSID: %s", settings.wifiSSID);
+    LOG_INFO("Temperature Setpoint: %.1f°C", settings.tempSetpoint);
+    LOG_INFO("Humidity Setpoint: %.1f%%", settings.humSetpoint);
+    LOG_INFO("Soil Moisture Setpoint: %.1f%%", settings.soilMoistureSetpoint);
+    LOG_INFO("Light Schedule: %02d:00 - %02d:00", 
+             settings.lightOnHour, settings.lightOffHour);
+    LOG_INFO("Automation: %s", settings.automationEnabled ? "Enabled" : "Disabled");
+    LOG_INFO("Display Brightness: %d", settings.displayBrightness);
+    LOG_INFO("UDP Telemetry: %s, port %u, every %us", settings.telemetryEnabled ? "Enabled" : "Disabled",
+             settings.telemetryPort, (unsigned)settings.telemetryInterval);
+    LOG_INFO("MQTT: %s, %s:%u", settings.mqttEnabled ? "Enabled" : "Disabled",
+             settings.mqttHost, settings.mqttPort);
+    LOG_INFO("Rated power: pump %uW, fan %uW, heater %uW, light %uW; pump flow %u ml/min",
+             settings.pumpPowerW, settings.fanPowerW, settings.heaterPowerW,
+             settings.lightPowerW, settings.pumpFlowRate);
+    LOG_INFO("Low power mode: %s", settings.lowPowerMode ? "Enabled" : "Disabled");
+    LOG_INFO("Grow light profile: %s", LedMatrix::profileName((GrowProfile)settings.growProfile));
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 
 #include <EEPROM.h>
 #include "Config.h"
+#include "EnergyMeter.h"
 
 class EEPROMManager {
 public:
@@ -12,11 +13,21 @@ public:
     void resetToDefaults();
     void printSettings(const SystemSettings& settings);
     
+    // Счетчики энергии хранятся отдельно от настроек
+    bool loadEnergy(EnergyRecord& record);
+    bool saveEnergy(EnergyRecord& record);
+    
 private:
     bool validateSettings(const SystemSettings& settings);
     void migrateSettings(SystemSettings& settings, uint8_t fromVersion);
+    static uint32_t energyChecksum(const EnergyRecord& record);
     
     static constexpr int SETTINGS_ADDRESS = 0;
+    static constexpr int ENERGY_ADDRESS = 256;
+    static constexpr uint32_t ENERGY_MAGIC = 0x454E5247;  // "ENRG"
+    
+    static_assert(sizeof(SystemSettings) <= ENERGY_ADDRESS, "Settings overlap energy record");
+    static_assert(ENERGY_ADDRESS + sizeof(EnergyRecord) <= EEPROM_SIZE, "Energy record exceeds EEPROM");
 };
 
 #endif
\ No newline at end of file
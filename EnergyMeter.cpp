@@ -0,0 +1,146 @@
+#include "EnergyMeter.h"
+#include "GlobalInstances.h"
+#include "Logger.h"
+
+static constexpr double WMS_PER_KWH = 3600.0 * 1000.0 * 1000.0;
+
+void EnergyMeter::begin() {
+    if (eepromManager.loadEnergy(record)) {
+        LOG_INFO("⚡ Energy counters restored: day %u, %.3f kWh total",
+                 record.dayIndex, getTotalEnergyKWh(EnergyPeriod::TOTAL));
+    } else {
+        record = EnergyRecord();
+        LOG_INFO("⚡ Energy counters started from zero");
+    }
+    lastSample = millis();
+    lastSave = lastSample;
+}
+
+void EnergyMeter::update() {
+    unsigned long now = millis();
+    unsigned long elapsed = now - lastSample;
+    if (elapsed < Constants::ENERGY_SAMPLE_INTERVAL) return;
+    lastSample = now;
+
+    integrate(elapsed);
+
+    record.periodElapsedMs += elapsed;
+    if (record.periodElapsedMs >= Constants::ENERGY_DAY_MS) {
+        record.periodElapsedMs -= Constants::ENERGY_DAY_MS;
+        rollDay();
+        save();
+    } else if (now - lastSave >= Constants::ENERGY_SAVE_INTERVAL) {
+        save();
+    }
+}
+
+void EnergyMeter::integrate(unsigned long elapsedMs) {
+    EnergyTotals delta = {};
+
+    // Состояние на момент выборки считается действующим весь интервал
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        const DeviceManager::ControlChannel& channel = DeviceManager::getChannel(i);
+        uint16_t power = getRatedPower(channel.id);
+        if (power == 0) continue;
+
+        int16_t value = deviceManager.getChannelValue(channel.id);
+        if (value <= channel.minValue) continue;
+
+        uint64_t energy = (uint64_t)power * elapsedMs;
+        if (channel.type == DeviceManager::ChannelType::DIMMER) {
+            energy = energy * value / channel.maxValue;
+        }
+        delta.energyWms[(uint8_t)channel.id] = energy;
+    }
+
+    // мл/мин * мс / 60 = мкл
+    if (sensorData.pumpState) {
+        delta.waterUl = (uint64_t)systemSettings.pumpFlowRate * elapsedMs / 60;
+    }
+
+    for (uint8_t p = 0; p < (uint8_t)EnergyPeriod::COUNT; p++) {
+        EnergyTotals& target = record.current[p];
+        for (uint8_t d = 0; d < (uint8_t)ControlDevice::UNKNOWN; d++) {
+            target.energyWms[d] += delta.energyWms[d];
+        }
+        target.waterUl += delta.waterUl;
+    }
+}
+
+void EnergyMeter::rollDay() {
+    record.dayIndex++;
+
+    // Завершенный период сохраняется как "предыдущий", текущий начинается с нуля
+    record.previous[(uint8_t)EnergyPeriod::DAY] = record.current[(uint8_t)EnergyPeriod::DAY];
+    record.current[(uint8_t)EnergyPeriod::DAY] = EnergyTotals();
+
+    if (record.dayIndex % 7 == 0) {
+        record.previous[(uint8_t)EnergyPeriod::WEEK] = record.current[(uint8_t)EnergyPeriod::WEEK];
+        record.current[(uint8_t)EnergyPeriod::WEEK] = EnergyTotals();
+    }
+    if (record.dayIndex % 30 == 0) {
+        record.previous[(uint8_t)EnergyPeriod::MONTH] = record.current[(uint8_t)EnergyPeriod::MONTH];
+        record.current[(uint8_t)EnergyPeriod::MONTH] = EnergyTotals();
+    }
+
+    const EnergyTotals& day = record.previous[(uint8_t)EnergyPeriod::DAY];
+    LOG_INFO("⚡ Day %u closed: %.3f kWh, %.1f L",
+             record.dayIndex, getTotalEnergyKWh(EnergyPeriod::DAY, true), day.waterUl / 1e6);
+}
+
+void EnergyMeter::save() {
+    lastSave = millis();
+    eepromManager.saveEnergy(record);
+}
+
+void EnergyMeter::reset() {
+    record = EnergyRecord();
+    save();
+    LOG_INFO("🔄 Energy counters reset");
+}
+
+const EnergyTotals& EnergyMeter::totals(EnergyPeriod period, bool previous) const {
+    if (previous && period < EnergyPeriod::TOTAL) return record.previous[(uint8_t)period];
+    return record.current[(uint8_t)period];
+}
+
+double EnergyMeter::getEnergyKWh(ControlDevice device, EnergyPeriod period, bool previous) const {
+    if (device >= ControlDevice::UNKNOWN) return 0;
+    return totals(period, previous).energyWms[(uint8_t)device] / WMS_PER_KWH;
+}
+
+double EnergyMeter::getTotalEnergyKWh(EnergyPeriod period, bool previous) const {
+    const EnergyTotals& source = totals(period, previous);
+    uint64_t sum = 0;
+    for (uint8_t d = 0; d < (uint8_t)ControlDevice::UNKNOWN; d++) {
+        sum += source.energyWms[d];
+    }
+    return sum / WMS_PER_KWH;
+}
+
+double EnergyMeter::getWaterLitres(EnergyPeriod period, bool previous) const {
+    return totals(period, previous).waterUl / 1e6;
+}
+
+uint16_t EnergyMeter::getRatedPower(ControlDevice device) const {
+    switch (device) {
+        case ControlDevice::PUMP: return systemSettings.pumpPowerW;
+        case ControlDevice::FAN: return systemSettings.fanPowerW;
+        case ControlDevice::HEATER: return systemSettings.heaterPowerW;
+        case ControlDevice::LIGHT: return systemSettings.lightPowerW;
+        case ControlDevice::DOOR:
+        case ControlDevice::UNKNOWN: break;
+    }
+    return 0;
+}
+
+const char* EnergyMeter::periodName(EnergyPeriod period) {
+    switch (period) {
+        case EnergyPeriod::DAY: return "day";
+        case EnergyPeriod::WEEK: return "week";
+        case EnergyPeriod::MONTH: return "month";
+        case EnergyPeriod::TOTAL: return "total";
+        case EnergyPeriod::COUNT: break;
+    }
+    return "unknown";
+}
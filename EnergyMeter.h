@@ -0,0 +1,65 @@
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include "Config.h"
+#include "DeviceNames.h"
+
+// Периоды учета. Часов реального времени нет, поэтому сутки отсчитываются
+// по времени работы (24 часа наработки контроллера), неделя - 7 суток,
+// месяц - 30 суток. Незавершенные сутки переживают перезагрузку.
+enum class EnergyPeriod : uint8_t {
+    DAY,
+    WEEK,
+    MONTH,
+    TOTAL,
+    COUNT
+};
+
+// Накопленные значения за период в целых единицах - без потери точности
+// при сложении малых приращений с большими суммами
+struct EnergyTotals {
+    uint64_t energyWms[(uint8_t)ControlDevice::UNKNOWN];  // Вт*мс
+    uint64_t waterUl;                                     // микролитры
+};
+
+// Образ для EEPROM (magic и checksum заполняет EEPROMManager)
+struct EnergyRecord {
+    uint32_t magic;
+    uint32_t periodElapsedMs;   // прошло с начала текущих суток
+    uint16_t dayIndex;          // номер суток с момента сброса счетчиков
+    EnergyTotals current[(uint8_t)EnergyPeriod::COUNT];
+    EnergyTotals previous[(uint8_t)EnergyPeriod::TOTAL];  // последние завершенные периоды
+    uint32_t checksum;
+};
+
+// Интегратор энергопотребления и расхода воды по выходам.
+// Раз в секунду добавляет P * dt по каждому включенному выходу (для диммера -
+// пропорционально яркости) и расход насоса; стоимость шага не зависит от
+// длины истории. Номинальная мощность и расход насоса берутся из настроек.
+class EnergyMeter {
+public:
+    void begin();
+    void update();
+    void save();
+    void reset();
+
+    double getEnergyKWh(ControlDevice device, EnergyPeriod period, bool previous = false) const;
+    double getTotalEnergyKWh(EnergyPeriod period, bool previous = false) const;
+    double getWaterLitres(EnergyPeriod period, bool previous = false) const;
+    uint16_t getRatedPower(ControlDevice device) const;
+    uint16_t getDayIndex() const { return record.dayIndex; }
+    uint32_t getDayElapsedMs() const { return record.periodElapsedMs; }
+
+    static const char* periodName(EnergyPeriod period);
+
+private:
+    void integrate(unsigned long elapsedMs);
+    void rollDay();
+    const EnergyTotals& totals(EnergyPeriod period, bool previous) const;
+
+    EnergyRecord record = {};
+    unsigned long lastSample = 0;
+    unsigned long lastSave = 0;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <stdint.h>
+#include <math.h>
+#include <limits>
+
+// Величина с фиксированной точкой: целое T в единицах 1/SCALE.
+// Крайнее значение диапазона T зарезервировано как метка "нет данных"
+// (аналог NAN), арифметика насыщающая. Все вычисления целочисленные и
+// дают одинаковый результат на контроллере и на хосте.
+template <typename T, int32_t SCALE>
+class Fixed {
+public:
+    using Raw = T;
+    static constexpr int32_t scale = SCALE;
+
+    static constexpr T INVALID = std::numeric_limits<T>::is_signed ?
+                                 std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+    static constexpr int32_t MIN_RAW = std::numeric_limits<T>::is_signed ?
+                                       (int32_t)std::numeric_limits<T>::min() + 1 : 0;
+    static constexpr int32_t MAX_RAW = std::numeric_limits<T>::is_signed ?
+                                       (int32_t)std::numeric_limits<T>::max() :
+                                       (int32_t)std::numeric_limits<T>::max() - 1;
+
+    constexpr Fixed() : value(INVALID) {}
+
+    // Значение в единицах 1/SCALE с насыщением до допустимого диапазона
+    static constexpr Fixed fromRaw(int32_t raw) {
+        return Fixed(raw < MIN_RAW ? MIN_RAW : (raw > MAX_RAW ? MAX_RAW : raw));
+    }
+
+    // Преобразование на границе с библиотеками, возвращающими float
+    static constexpr Fixed fromFloat(float number) {
+        if (number != number) return Fixed();
+        float scaled = number * SCALE;
+        if (scaled <= MIN_RAW) return Fixed(MIN_RAW);
+        if (scaled >= MAX_RAW) return Fixed(MAX_RAW);
+        return Fixed((int32_t)(scaled >= 0 ? scaled + 0.5f : scaled - 0.5f));
+    }
+
+    constexpr T raw() const { return value; }
+    constexpr bool isValid() const { return value != INVALID; }
+    constexpr float toFloat() const { return isValid() ? (float)value / SCALE : NAN; }
+
+    constexpr Fixed operator+(Fixed other) const { return fromRaw((int32_t)value + other.value); }
+    constexpr Fixed operator-(Fixed other) const { return fromRaw((int32_t)value - other.value); }
+    constexpr Fixed distance(Fixed other) const {
+        return fromRaw(value > other.value ? (int32_t)value - other.value : (int32_t)other.value - value);
+    }
+
+    // Сравнение имеет смысл только для действительных значений
+    constexpr bool operator<(Fixed other) const { return value < other.value; }
+    constexpr bool operator>(Fixed other) const { return value > other.value; }
+    constexpr bool operator<=(Fixed other) const { return value <= other.value; }
+    constexpr bool operator>=(Fixed other) const { return value >= other.value; }
+    constexpr bool operator==(Fixed other) const { return value == other.value; }
+    constexpr bool operator!=(Fixed other) const { return value != other.value; }
+
+private:
+    constexpr explicit Fixed(int32_t raw) : value((T)raw) {}
+
+    T value;
+};
+
+// Величины датчиков: 2 байта вместо 4-байтового float
+using Temperature = Fixed<int16_t, 100>;   // 0.01 °C, -327.67..327.67
+using Percent = Fixed<int16_t, 100>;       // 0.01 %
+using Pressure = Fixed<int16_t, 10>;       // 0.1 гПа, до 3276.7
+using Illuminance = Fixed<uint16_t, 1>;    // 1 лк, 0..65534
+
+#endif
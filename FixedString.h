@@ -0,0 +1,143 @@
+#ifndef FIXED_STRING_H
+#define FIXED_STRING_H
+
+#include <Arduino.h>
+#include <stdarg.h>
+
+// Невладеющая ссылка на строку: указатель и длина, без копирования.
+// Используется вместо String там, где строка только читается.
+class StringView {
+public:
+    constexpr StringView() : ptr(""), len(0) {}
+    constexpr StringView(const char* text, size_t length) : ptr(text), len(length) {}
+    constexpr StringView(const char* text) : ptr(text ? text : ""), len(text ? lengthOf(text) : 0) {}
+
+    constexpr const char* data() const { return ptr; }
+    constexpr size_t length() const { return len; }
+    constexpr bool empty() const { return len == 0; }
+    constexpr char operator[](size_t index) const { return ptr[index]; }
+
+    constexpr bool operator==(StringView other) const {
+        return len == other.len && equalChars(ptr, other.ptr, len);
+    }
+    constexpr bool operator!=(StringView other) const { return !(*this == other); }
+
+private:
+    // В константном выражении GCC вычисляет длину сам, во время работы -
+    // обычный вызов strlen без рекурсии по строке
+    static constexpr size_t lengthOf(const char* text) {
+        return __builtin_strlen(text);
+    }
+
+    static constexpr bool equalChars(const char* a, const char* b, size_t count) {
+        return count == 0 || (*a == *b && equalChars(a + 1, b + 1, count - 1));
+    }
+
+    const char* ptr;
+    size_t len;
+};
+
+// Строка фиксированной емкости, хранится внутри объекта - без кучи.
+// Не помещающийся текст обрезается, строка всегда завершена нулем.
+template <size_t CAPACITY>
+class FixedString {
+public:
+    FixedString() { buffer[0] = '\0'; }
+    FixedString(StringView text) { assign(text); }
+
+    FixedString& operator=(StringView text) {
+        assign(text);
+        return *this;
+    }
+
+    void assign(StringView text) {
+        len = 0;
+        buffer[0] = '\0';
+        append(text);
+    }
+
+    FixedString& append(StringView text) {
+        size_t count = text.length();
+        if (count > CAPACITY - len) count = CAPACITY - len;
+        memcpy(buffer + len, text.data(), count);
+        len += count;
+        buffer[len] = '\0';
+        return *this;
+    }
+
+    FixedString& append(char c) {
+        if (len < CAPACITY) {
+            buffer[len++] = c;
+            buffer[len] = '\0';
+        }
+        return *this;
+    }
+
+    __attribute__((format(printf, 2, 3)))
+    FixedString& appendf(const char* format, ...) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer + len, CAPACITY - len + 1, format, args);
+        va_end(args);
+
+        if (written > 0) {
+            len += ((size_t)written > CAPACITY - len) ? CAPACITY - len : written;
+        }
+        return *this;
+    }
+
+    // Текст как строковое значение JSON, в кавычках и с экранированием.
+    // Не помещающийся хвост отбрасывается целыми символами, чтобы не
+    // разрезать escape-последовательность; reserve байт остаются свободными
+    // для того, что допишется после строки.
+    FixedString& appendJsonString(StringView text, size_t reserve = 0) {
+        size_t limit = CAPACITY > reserve + 1 ? CAPACITY - reserve - 1 : 0;
+        append('"');
+        for (size_t i = 0; i < text.length(); i++) {
+            char escaped[7];
+            unsigned char c = text[i];
+            if (c == '"' || c == '\\') {
+                escaped[0] = '\\';
+                escaped[1] = c;
+                escaped[2] = '\0';
+            } else if (c == '\n') {
+                memcpy(escaped, "\\n", 3);
+            } else if (c < 0x20) {
+                snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            } else {
+                escaped[0] = c;
+                escaped[1] = '\0';
+            }
+            size_t count = strlen(escaped);
+            if (len + count > limit) break;
+            append(StringView(escaped, count));
+        }
+        return append('"');
+    }
+
+    FixedString& operator+=(StringView text) { return append(text); }
+    FixedString& operator+=(char c) { return append(c); }
+
+    void clear() {
+        len = 0;
+        buffer[0] = '\0';
+    }
+
+    const char* c_str() const { return buffer; }
+    size_t length() const { return len; }
+    bool empty() const { return len == 0; }
+    bool full() const { return len == CAPACITY; }
+    static constexpr size_t capacity() { return CAPACITY; }
+
+    StringView view() const { return StringView(buffer, len); }
+    operator StringView() const { return view(); }
+
+    bool operator==(StringView other) const { return view() == other; }
+    bool operator!=(StringView other) const { return view() != other; }
+
+private:
+    char buffer[CAPACITY + 1];
+    size_t len = 0;
+};
+
+#endif
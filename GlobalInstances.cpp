@@ -5,4 +5,13 @@ DeviceManager deviceManager;
 DisplayManager displayManager;
 EEPROMManager eepromManager;
 WebInterface webInterface;
-Automation automation;
\ No newline at end of file
+Automation automation(sensorFusion);
+I2CBus i2cBus;
+MetricsExporter metricsExporter;
+TelemetryPublisher telemetryPublisher;
+MqttClient mqttClient;
+EnergyMeter energyMeter;
+SensorFusion sensorFusion;
+LedMatrix ledMatrix;
+AlarmEngine alarmEngine;
+DoorMonitor doorMonitor;
\ No newline at end of file
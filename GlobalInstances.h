@@ -7,6 +7,15 @@
 #include "EEPROMManager.h"
 #include "WebInterface.h"
 #include "Automation.h"
+#include "I2CBus.h"
+#include "MetricsExporter.h"
+#include "TelemetryPublisher.h"
+#include "MqttClient.h"
+#include "EnergyMeter.h"
+#include "SensorFusion.h"
+#include "LedMatrix.h"
+#include "AlarmEngine.h"
+#include "DoorMonitor.h"
 
 // Объявления extern
 extern DeviceManager deviceManager;
@@ -14,5 +23,14 @@ extern DisplayManager displayManager;
 extern EEPROMManager eepromManager;
 extern WebInterface webInterface;
 extern Automation automation;
+extern I2CBus i2cBus;
+extern MetricsExporter metricsExporter;
+extern TelemetryPublisher telemetryPublisher;
+extern MqttClient mqttClient;
+extern EnergyMeter energyMeter;
+extern SensorFusion sensorFusion;
+extern LedMatrix ledMatrix;
+extern AlarmEngine alarmEngine;
+extern DoorMonitor doorMonitor;
 
 #endif
\ No newline at end of file
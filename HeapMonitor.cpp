@@ -0,0 +1,95 @@
+#include "HeapMonitor.h"
+#include "Logger.h"
+
+HeapMonitor heapMonitor;
+
+void HeapMonitor::update() {
+    unsigned long now = millis();
+    if (sampled && now - lastSample < Constants::HEAP_SAMPLE_INTERVAL) return;
+    lastSample = now;
+    sample();
+}
+
+void HeapMonitor::sample() {
+    current.uptimeSeconds = millis() / 1000;
+    current.freeBytes = ESP.getFreeHeap();
+    current.largestBlock = ESP.getMaxAllocHeap();
+    sampled = true;
+    if (current.largestBlock < minLargestBlock) minLargestBlock = current.largestBlock;
+
+    // Интервал хранит время начала и минимумы за интервал
+    if (bucketSamples == 0) {
+        bucket = current;
+    } else {
+        if (current.freeBytes < bucket.freeBytes) bucket.freeBytes = current.freeBytes;
+        if (current.largestBlock < bucket.largestBlock) bucket.largestBlock = current.largestBlock;
+    }
+    if (++bucketSamples < Constants::HEAP_SAMPLES_PER_BUCKET) return;
+
+    samples[head] = bucket;
+    head = (head + 1) % SAMPLE_COUNT;
+    if (count < SAMPLE_COUNT) count++;
+    bucketSamples = 0;
+
+    // Решение только после суток наблюдений: короткие провалы после запросов не в счет
+    bool trendFalling = count >= Constants::HEAP_TREND_MIN_BUCKETS && largestBlockTrend() < -Constants::HEAP_TREND_WARN;
+    fragmenting.store(trendFalling, std::memory_order_relaxed);
+    if (trendFalling) {
+        LOG_WARN("⚠️ Heap fragmenting: largest block %u bytes, trend %.0f bytes/h",
+                 (unsigned)bucket.largestBlock, largestBlockTrend());
+    }
+}
+
+void HeapMonitor::record(HeapSubsystem subsystem, uint32_t freeBefore, uint32_t freeAfter) {
+    SubsystemStats& entry = stats[(uint8_t)subsystem];
+    entry.calls++;
+    entry.retainedBytes += (int32_t)(freeBefore - freeAfter);
+
+    if (freeAfter < freeBefore) {
+        uint32_t lost = freeBefore - freeAfter;
+        entry.growthEvents++;
+        if (lost > entry.maxRetained) entry.maxRetained = lost;
+    }
+}
+
+uint8_t HeapMonitor::fragmentationPercent() const {
+    if (!sampled || current.freeBytes == 0) return 0;
+    return 100 - (uint64_t)latest().largestBlock * 100 / latest().freeBytes;
+}
+
+float HeapMonitor::largestBlockTrend() const {
+    // Наклон по методу наименьших квадратов. Интервалы идут через равные
+    // промежутки, время берется по номеру интервала: millis() на устройстве
+    // переполняется через 49 суток, а окно может его захватить
+    if (count < 2) return 0;
+
+    uint8_t start = (head + SAMPLE_COUNT - count) % SAMPLE_COUNT;
+    const float bucketHours = (float)Constants::HEAP_SAMPLES_PER_BUCKET * Constants::HEAP_SAMPLE_INTERVAL / 3600000.0F;
+    float sumT = 0, sumB = 0, sumTT = 0, sumTB = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Sample& entry = samples[(start + i) % SAMPLE_COUNT];
+        float t = i * bucketHours;
+        float b = entry.largestBlock;
+        sumT += t;
+        sumB += b;
+        sumTT += t * t;
+        sumTB += t * b;
+    }
+
+    float denominator = count * sumTT - sumT * sumT;
+    if (denominator <= 0) return 0;
+    return (count * sumTB - sumT * sumB) / denominator;
+}
+
+const char* HeapMonitor::subsystemName(HeapSubsystem subsystem) {
+    switch (subsystem) {
+        case HeapSubsystem::SENSORS: return "sensors";
+        case HeapSubsystem::DISCOVERY: return "discovery";
+        case HeapSubsystem::AUTOMATION: return "automation";
+        case HeapSubsystem::DISPLAY: return "display";
+        case HeapSubsystem::HTTP: return "http";
+        case HeapSubsystem::COUNT: break;
+    }
+    return "unknown";
+}
@@ -0,0 +1,93 @@
+#ifndef HEAP_MONITOR_H
+#define HEAP_MONITOR_H
+
+#include <atomic>
+#include "Config.h"
+
+// Подсистемы, для которых считается изменение кучи
+enum class HeapSubsystem : uint8_t {
+  SENSORS,
+  DISCOVERY,
+  AUTOMATION,
+  DISPLAY,
+  HTTP,
+  COUNT
+};
+
+// Телеметрия кучи: периодические снимки свободной памяти и наибольшего
+// блока с трендом, плюс учет чистого изменения кучи по подсистемам.
+// Устойчивое уменьшение наибольшего блока - признак фрагментации.
+//
+// Для тренда снимки прореживаются: в окно попадает минимум за
+// HEAP_SAMPLES_PER_BUCKET снимков, так окно покрывает несколько суток,
+// а короткие провалы во время запросов не создают ложного тренда.
+//
+// Снимки и тренд ведет сетевая сторона; признак фрагментации читает и
+// индикатор в цикле управления, поэтому он публикуется атомарно.
+class HeapMonitor {
+public:
+    struct Sample {
+        uint32_t uptimeSeconds;
+        uint32_t freeBytes;
+        uint32_t largestBlock;
+    };
+
+    struct SubsystemStats {
+        uint32_t calls;
+        uint32_t growthEvents;    // вызовы, после которых куча уменьшилась
+        int32_t retainedBytes;    // суммарное чистое изменение
+        uint32_t maxRetained;     // наибольшая потеря за один вызов
+    };
+
+    void update();
+    void sample();
+
+    void record(HeapSubsystem subsystem, uint32_t freeBefore, uint32_t freeAfter);
+
+    const Sample& latest() const { return current; }
+    uint8_t getSampleCount() const { return count; }    // интервалов в окне тренда
+    uint32_t getMinLargestBlock() const { return minLargestBlock; }
+    uint8_t fragmentationPercent() const;
+    float largestBlockTrend() const;    // байт в час, по окну интервалов
+    bool isFragmenting() const { return fragmenting.load(std::memory_order_relaxed); }
+
+    const SubsystemStats& getStats(HeapSubsystem subsystem) const {
+        return stats[(uint8_t)subsystem];
+    }
+    static const char* subsystemName(HeapSubsystem subsystem);
+
+    static constexpr uint8_t SAMPLE_COUNT = 60;
+
+private:
+    Sample current = {};
+    Sample bucket = {};         // накапливаемый интервал
+    uint8_t bucketSamples = 0;
+    bool sampled = false;
+    Sample samples[SAMPLE_COUNT] = {};
+    uint8_t head = 0;
+    uint8_t count = 0;
+    uint32_t minLargestBlock = UINT32_MAX;
+    unsigned long lastSample = 0;
+    SubsystemStats stats[(uint8_t)HeapSubsystem::COUNT] = {};
+    std::atomic<bool> fragmenting{false};   // пересчитывается по окончании интервала
+};
+
+extern HeapMonitor heapMonitor;
+
+// Изменение свободной кучи от создания до выхода из области видимости.
+// Задачи на другом ядре тоже влияют на значение - это оценка, а не точный учет.
+class HeapScope {
+public:
+    explicit HeapScope(HeapSubsystem subsystem) : subsystem(subsystem), freeBefore(ESP.getFreeHeap()) {}
+    ~HeapScope() { heapMonitor.record(subsystem, freeBefore, ESP.getFreeHeap()); }
+
+private:
+    HeapSubsystem subsystem;
+    uint32_t freeBefore;
+};
+
+#define HEAP_CONCAT_(a, b) a##b
+#define HEAP_CONCAT(a, b) HEAP_CONCAT_(a, b)
+#define HEAP_SCOPE(subsystem) HeapScope HEAP_CONCAT(heapScope, __LINE__)(HeapSubsystem::subsystem)
+
+#endif
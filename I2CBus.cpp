@@ -0,0 +1,217 @@
+#include "I2CBus.h"
+#include <Wire.h>
+#include "Logger.h"
+
+// ===== Замер операций библиотечных драйверов =====
+I2CBus::Transaction::Transaction(I2CBus& bus, uint8_t address)
+    : bus(bus), address(address), startUs(micros()) {
+    if (bus.nesting++ == 0) bus.nestedFailure = Result::OK;
+}
+
+I2CBus::Transaction::~Transaction() {
+    if (!finished) finish(false);
+}
+
+void I2CBus::Transaction::finish(bool success) {
+    if (finished) return;
+    finished = true;
+    bus.nesting--;
+
+    unsigned long durationUs = micros() - startUs;
+    if (success) {
+        bus.record(address, durationUs, Result::OK);
+    } else if (bus.nestedFailure != Result::OK) {
+        // Общий счетчик таймаутов уже учел вложенную ошибку
+        bus.recordStats(address, durationUs, bus.nestedFailure);
+    } else {
+        Result result = bus.probeResult(address);
+        bus.record(address, durationUs, result == Result::OK ? Result::DATA_ERROR : result);
+    }
+}
+
+// ===== Шина =====
+void I2CBus::begin() {
+    // Устройство могло остаться в середине передачи после сброса ESP32
+    if (sdaStuck()) {
+        stuckCount++;
+        LOG_WARN("⚠️ I2C SDA stuck low at boot, recovering...");
+        releaseLines();
+    }
+    restartWire();
+}
+
+bool I2CBus::probe(uint8_t address) {
+    return probeResult(address) == Result::OK;
+}
+
+I2CBus::Result I2CBus::probeResult(uint8_t address) {
+    // Пробы не попадают в статистику: NACK при сканировании - норма
+    Wire.beginTransmission(address);
+    Result result = classify(Wire.endTransmission());
+    if (result == Result::TIMEOUT || result == Result::BUS_ERROR) {
+        handleFailure(result);
+    }
+    return result;
+}
+
+bool I2CBus::write(uint8_t address, const uint8_t* data, uint8_t length) {
+    unsigned long start = micros();
+
+    Wire.beginTransmission(address);
+    Wire.write(data, length);
+    Result result = classify(Wire.endTransmission());
+
+    record(address, micros() - start, result);
+    if (result != Result::OK) handleFailure(result);
+    return result == Result::OK;
+}
+
+bool I2CBus::read(uint8_t address, uint8_t* buffer, uint8_t length) {
+    return writeRead(address, nullptr, 0, buffer, length);
+}
+
+bool I2CBus::writeRead(uint8_t address, const uint8_t* data, uint8_t length,
+                       uint8_t* buffer, uint8_t readLength) {
+    unsigned long start = micros();
+    Result result = Result::OK;
+
+    if (length > 0) {
+        Wire.beginTransmission(address);
+        Wire.write(data, length);
+        result = classify(Wire.endTransmission(false));
+    }
+
+    if (result == Result::OK) {
+        uint8_t received = Wire.requestFrom(address, readLength);
+        if (received == readLength) {
+            for (uint8_t i = 0; i < readLength; i++) {
+                buffer[i] = Wire.read();
+            }
+        } else {
+            // Короткий ответ: отличаем таймаут от NACK по времени операции
+            bool timedOut = micros() - start >= (unsigned long)timeoutMs * 1000;
+            result = timedOut ? Result::TIMEOUT : Result::NACK;
+        }
+    }
+
+    record(address, micros() - start, result);
+    if (result != Result::OK) handleFailure(result);
+    return result == Result::OK;
+}
+
+void I2CBus::setTimeout(uint16_t timeout) {
+    timeoutMs = timeout;
+    Wire.setTimeOut(timeoutMs);
+}
+
+bool I2CBus::recoverBus() {
+    Wire.end();
+    bool released = releaseLines();
+    restartWire();
+    return released;
+}
+
+I2CBus::Result I2CBus::classify(uint8_t wireError) const {
+    switch (wireError) {
+        case 0: return Result::OK;
+        case 2:                         // NACK на адресе
+        case 3: return Result::NACK;    // NACK на данных
+        case 5: return Result::TIMEOUT;
+        default: return Result::BUS_ERROR;
+    }
+}
+
+void I2CBus::record(uint8_t address, unsigned long durationUs, Result result) {
+    if (result == Result::TIMEOUT) timeoutCount++;
+
+    // Транзакции внутри замеряемой операции драйвера учитываются один раз
+    if (nesting > 0) {
+        if (nestedFailure == Result::OK) nestedFailure = result;
+        return;
+    }
+    recordStats(address, durationUs, result);
+}
+
+void I2CBus::recordStats(uint8_t address, unsigned long durationUs, Result result) {
+    AddressStats* entry = statsFor(address);
+    if (!entry) return;
+
+    entry->latencyUs.record(durationUs);
+    switch (result) {
+        case Result::OK: entry->okCount++; break;
+        case Result::TIMEOUT: entry->timeoutCount++; break;
+        case Result::DATA_ERROR: entry->dataErrorCount++; break;
+        default: entry->errorCount++; break;
+    }
+}
+
+I2CBus::AddressStats* I2CBus::statsFor(uint8_t address) {
+    for (uint8_t i = 0; i < statsCount; i++) {
+        if (stats[i].address == address) return &stats[i];
+    }
+    if (statsCount >= MAX_TRACKED_ADDRESSES) return nullptr;
+
+    AddressStats& entry = stats[statsCount++];
+    entry.address = address;
+    entry.okCount = 0;
+    entry.errorCount = 0;
+    entry.timeoutCount = 0;
+    entry.dataErrorCount = 0;
+    entry.latencyUs.reset();
+    return &entry;
+}
+
+void I2CBus::handleFailure(Result result) {
+    if (result == Result::NACK || result == Result::DATA_ERROR) return;
+
+    // Таймаут или ошибка шины: проверяем, не удерживает ли ведомый SDA
+    Wire.end();
+    if (sdaStuck()) {
+        stuckCount++;
+        LOG_WARN("⚠️ I2C SDA stuck low, sending 9 clock pulses...");
+        if (releaseLines()) {
+            LOG_INFO("✅ I2C bus released");
+        } else {
+            LOG_ERROR("❌ I2C bus still stuck");
+        }
+    }
+    restartWire();
+}
+
+bool I2CBus::sdaStuck() {
+    pinMode(Pins::I2C_SDA, INPUT_PULLUP);
+    pinMode(Pins::I2C_SCL, INPUT_PULLUP);
+    delayMicroseconds(5);
+    return digitalRead(Pins::I2C_SDA) == LOW && digitalRead(Pins::I2C_SCL) == HIGH;
+}
+
+bool I2CBus::releaseLines() {
+    recoveryCount++;
+
+    // До 9 тактов SCL: ведомый досылает бит и отпускает SDA
+    pinMode(Pins::I2C_SDA, INPUT_PULLUP);
+    pinMode(Pins::I2C_SCL, OUTPUT_OPEN_DRAIN);
+    for (uint8_t i = 0; i < 9 && digitalRead(Pins::I2C_SDA) == LOW; i++) {
+        digitalWrite(Pins::I2C_SCL, LOW);
+        delayMicroseconds(5);
+        digitalWrite(Pins::I2C_SCL, HIGH);
+        delayMicroseconds(5);
+    }
+
+    // Условие STOP: SDA вверх при высоком SCL
+    pinMode(Pins::I2C_SDA, OUTPUT_OPEN_DRAIN);
+    digitalWrite(Pins::I2C_SDA, LOW);
+    delayMicroseconds(5);
+    digitalWrite(Pins::I2C_SCL, HIGH);
+    delayMicroseconds(5);
+    digitalWrite(Pins::I2C_SDA, HIGH);
+    delayMicroseconds(5);
+
+    pinMode(Pins::I2C_SDA, INPUT_PULLUP);
+    return digitalRead(Pins::I2C_SDA) == HIGH;
+}
+
+void I2CBus::restartWire() {
+    Wire.begin(Pins::I2C_SDA, Pins::I2C_SCL);
+    Wire.setTimeOut(timeoutMs);
+}
@@ -0,0 +1,88 @@
+#ifndef I2C_BUS_H
+#define I2C_BUS_H
+
+#include "Config.h"
+#include "LatencyHistogram.h"
+
+// Обертка над Wire: каждая транзакция замеряется и классифицируется,
+// при таймауте проверяется залипание SDA и шина восстанавливается
+// девятью тактами SCL и условием STOP. Неверные данные от отвечающего
+// устройства (CRC, NaN, вне диапазона) - DATA_ERROR, шина не трогается.
+class I2CBus {
+public:
+    enum class Result : uint8_t {
+        OK,
+        NACK,
+        TIMEOUT,
+        BUS_ERROR,
+        DATA_ERROR
+    };
+
+    struct AddressStats {
+        uint8_t address;
+        uint32_t okCount;
+        uint32_t errorCount;
+        uint32_t timeoutCount;
+        uint32_t dataErrorCount;
+        LatencyHistogram<24> latencyUs;
+    };
+
+    // Замер операции библиотечного драйвера (Adafruit, BH1750), которая
+    // обращается к Wire напрямую. Вложенные транзакции I2CBus не учитываются.
+    // Неудача классифицируется по вложенной ошибке шины, если она была
+    // (восстановление уже выполнено), иначе - пробой адреса: отвечает -
+    // DATA_ERROR, иначе ошибка пробы и ее обработка.
+    class Transaction {
+    public:
+        Transaction(I2CBus& bus, uint8_t address);
+        ~Transaction();
+        void finish(bool success);
+
+    private:
+        I2CBus& bus;
+        uint8_t address;
+        unsigned long startUs;
+        bool finished = false;
+    };
+
+    void begin();
+
+    bool probe(uint8_t address);
+    bool write(uint8_t address, const uint8_t* data, uint8_t length);
+    bool read(uint8_t address, uint8_t* buffer, uint8_t length);
+    bool writeRead(uint8_t address, const uint8_t* data, uint8_t length,
+                   uint8_t* buffer, uint8_t readLength);
+
+    void setTimeout(uint16_t timeoutMs);
+    bool recoverBus();
+
+    uint8_t getStatsCount() const { return statsCount; }
+    const AddressStats& getStats(uint8_t index) const { return stats[index]; }
+    uint32_t getStuckCount() const { return stuckCount; }
+    uint32_t getRecoveryCount() const { return recoveryCount; }
+    uint32_t getTimeoutCount() const { return timeoutCount; }
+
+    static constexpr uint8_t MAX_TRACKED_ADDRESSES = 12;
+
+private:
+    Result classify(uint8_t wireError) const;
+    Result probeResult(uint8_t address);
+    void record(uint8_t address, unsigned long durationUs, Result result);
+    void recordStats(uint8_t address, unsigned long durationUs, Result result);
+    AddressStats* statsFor(uint8_t address);
+    void handleFailure(Result result);
+    bool sdaStuck();
+    bool releaseLines();
+    void restartWire();
+
+    AddressStats stats[MAX_TRACKED_ADDRESSES];
+    uint8_t statsCount = 0;
+    uint8_t nesting = 0;
+    Result nestedFailure = Result::OK;  // первая ошибка внутри замеряемой операции
+    uint32_t stuckCount = 0;
+    uint32_t recoveryCount = 0;
+    uint32_t timeoutCount = 0;
+    uint16_t timeoutMs = Constants::I2C_DEFAULT_TIMEOUT_MS;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <Arduino.h>
+
+// Гистограмма задержек с логарифмическими корзинами (степени двойки).
+// Корзина b содержит значения [2^(b-1), 2^b), корзина 0 - только ноль.
+// Запись - O(1) без выделения памяти, перцентили - по верхней границе корзины.
+template <uint8_t BUCKETS>
+class LatencyHistogram {
+public:
+    void record(uint32_t value) {
+        uint8_t bucket = value ? 32 - __builtin_clz(value) : 0;
+        if (bucket >= BUCKETS) bucket = BUCKETS - 1;
+        buckets[bucket]++;
+        total++;
+        totalValue += value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    uint32_t percentile(uint8_t percent) const {
+        if (total == 0) return 0;
+
+        uint32_t target = ((uint64_t)total * percent + 99) / 100;
+        uint32_t seen = 0;
+        for (uint8_t b = 0; b < BUCKETS; b++) {
+            seen += buckets[b];
+            if (seen >= target) {
+                uint32_t upper = b ? ((b >= 32) ? UINT32_MAX : (uint32_t)((1ULL << b) - 1)) : 0;
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        total = 0;
+        totalValue = 0;
+        maxValue = 0;
+    }
+
+    uint32_t count() const { return total; }
+    // Сумма значений - для _sum сводки Prometheus
+    uint64_t sum() const { return totalValue; }
+    uint32_t max() const { return maxValue; }
+
+private:
+    uint32_t buckets[BUCKETS] = {};
+    uint32_t total = 0;
+    uint64_t totalValue = 0;
+    uint32_t maxValue = 0;
+};
+
+#endif
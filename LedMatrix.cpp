@@ -0,0 +1,246 @@
+#include "LedMatrix.h"
+#include "GlobalInstances.h"
+#include "HeapMonitor.h"
+#include "Logger.h"
+
+// Буфер WS2812: индекс = y * WIDTH + x, строки подключены последовательно
+static CRGB leds[LedMatrix::WIDTH * LedMatrix::HEIGHT];
+
+static_assert(LedMatrix::WIDTH * LedMatrix::HEIGHT == Constants::NUM_LEDS, "Matrix size mismatch");
+
+struct GrowProfileInfo {
+    const char* name;
+    CRGB color;
+    unsigned long rampMs;   // разгон от текущей яркости до заданной
+};
+
+static const GrowProfileInfo GROW_PROFILES[] = {
+    {"full",       CRGB(255, 255, 255), 2000},
+    {"vegetative", CRGB(96, 0, 255),    10000},
+    {"flowering",  CRGB(255, 0, 72),    10000},
+};
+
+static_assert(sizeof(GROW_PROFILES) / sizeof(GROW_PROFILES[0]) == (size_t)GrowProfile::COUNT,
+              "GROW_PROFILES must cover GrowProfile");
+
+// Значки тревог 8x8, старший бит - левый столбец
+static const uint8_t ICON_SENSOR[8] = {0x18, 0x18, 0x18, 0x18, 0x18, 0x00, 0x18, 0x18};  // !
+static const uint8_t ICON_CROSS_CHECK[8] = {0x10, 0x28, 0x28, 0x28, 0x38, 0x7C, 0x7C, 0x38};  // термометр
+static const uint8_t ICON_ALARM[8] = {0x18, 0x3C, 0x3C, 0x3C, 0x7E, 0xFF, 0x00, 0x18};  // колокол
+static const uint8_t ICON_HEAP[8] = {0x3C, 0x42, 0x81, 0x81, 0x81, 0x81, 0x42, 0x3C};  // пустой круг
+
+// 0 - холодный синий, 128 - зеленый, 255 - красный
+static CRGB heatColor(uint8_t level) {
+    if (level < 128) {
+        return CRGB(0, level * 2, 255 - level * 2);
+    }
+    return CRGB((level - 128) * 2, 255 - (level - 128) * 2, 0);
+}
+
+// Положение значения в допустимом диапазоне канала, 0-255
+template <typename Traits>
+static uint8_t channelLevel(typename Traits::Value value) {
+    int32_t span = (int32_t)Traits::MAX_VALUE.raw() - Traits::MIN_VALUE.raw();
+    int32_t offset = (int32_t)value.raw() - Traits::MIN_VALUE.raw();
+    return constrain(offset * 255 / span, 0, 255);
+}
+
+void LedMatrix::begin() {
+    FastLED.addLeds<NEOPIXEL, Pins::LED_MATRIX>(leds, Constants::NUM_LEDS);
+    // Яркость задается при отрисовке, чтобы сравнение кадров учитывало и ее
+    FastLED.setBrightness(255);
+    setGrowProfile((GrowProfile)systemSettings.growProfile);
+    clear();
+    show();
+
+    LOG_INFO("🌈 LED matrix initialized (%d LEDs)", Constants::NUM_LEDS);
+}
+
+void LedMatrix::update(const SensorData& data) {
+    unsigned long now = millis();
+    if (now - lastFrame < frameInterval) return;
+    lastFrame = now;
+
+    updateGrowRamp(now);
+    bool growLight = growTarget > 0 || growCurrent > 0;
+    if (!growLight) {
+        renderStatus(data, now);
+    } else {
+        renderGrowLight();
+        renderAlarmOverlay(data, now);
+    }
+    show();
+}
+
+void LedMatrix::setGrowLight(uint8_t brightness) {
+    if (brightness == growTarget) return;
+    growStart = growCurrent;
+    growTarget = brightness;
+    growChange = millis();
+}
+
+void LedMatrix::setGrowProfile(GrowProfile profile) {
+    if (profile >= GrowProfile::COUNT || profile == growProfile) return;
+    growProfile = profile;
+    LOG_INFO("🌱 Grow light profile: %s", profileName(profile));
+}
+
+const char* LedMatrix::profileName(GrowProfile profile) {
+    return profile < GrowProfile::COUNT ? GROW_PROFILES[(uint8_t)profile].name : "unknown";
+}
+
+GrowProfile LedMatrix::parseProfile(StringView name) {
+    for (uint8_t i = 0; i < (uint8_t)GrowProfile::COUNT; i++) {
+        if (name == GROW_PROFILES[i].name) return (GrowProfile)i;
+    }
+    return GrowProfile::COUNT;
+}
+
+// ===== Виджеты =====
+void LedMatrix::clear() {
+    for (CRGB& pixel : frame) pixel = CRGB::Black;
+}
+
+void LedMatrix::setPixel(uint8_t x, uint8_t y, CRGB color) {
+    if (x >= WIDTH || y >= HEIGHT) return;
+    frame[y * WIDTH + x] = color.nscale8(Constants::LED_STATUS_BRIGHTNESS);
+}
+
+// Столбец снизу вверх высотой level/255 от матрицы (минимум один пиксель)
+void LedMatrix::barGraph(uint8_t x, uint8_t level, CRGB color) {
+    uint8_t height = 1 + level * (HEIGHT - 1) / 255;
+    for (uint8_t i = 0; i < height; i++) {
+        setPixel(x, HEIGHT - 1 - i, color);
+    }
+}
+
+// Столбец ячеек сверху вниз, цвет ячейки - по ее уровню
+void LedMatrix::heatmap(uint8_t x, uint8_t y, uint8_t width, const uint8_t* levels, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+        setPixel(x + i % width, y + i / width, heatColor(levels[i]));
+    }
+}
+
+void LedMatrix::icon(const uint8_t* rows, CRGB color) {
+    for (uint8_t y = 0; y < HEIGHT; y++) {
+        for (uint8_t x = 0; x < WIDTH; x++) {
+            if (rows[y] & (0x80 >> x)) setPixel(x, y, color);
+        }
+    }
+}
+
+// ===== Каналы =====
+// Значок и цвет самой важной тревоги; nullptr - тревог нет
+const uint8_t* LedMatrix::activeAlarm(const SensorData& data, CRGB& color) const {
+    color = CRGB::Red;
+    if (alarmEngine.getUnacknowledgedCount() > 0) return ICON_ALARM;
+    if (!data.systemHealthy) return ICON_SENSOR;
+    if (sensorFusion.isCrossCheckFailed()) {
+        color = CRGB::Orange;
+        return ICON_CROSS_CHECK;
+    }
+    if (heapMonitor.isFragmenting()) {
+        color = CRGB::Purple;
+        return ICON_HEAP;
+    }
+    return nullptr;
+}
+
+// Столбцы 0-5 - показания датчиков, 6 - состояния выходов,
+// 7 - недостоверность каналов. Тревога чередуется со своим значком.
+void LedMatrix::renderStatus(const SensorData& data, unsigned long now) {
+    clear();
+
+    CRGB alarmColor;
+    const uint8_t* alarm = activeAlarm(data, alarmColor);
+    if (alarm && (now / Constants::LED_ALARM_BLINK) % 2 == 0) {
+        icon(alarm, alarmColor);
+        return;
+    }
+
+    const bool valid[] = {
+        data.airTemperature.isValid(), data.airHumidity.isValid(), data.pressure.isValid(),
+        data.soilTemperature.isValid(), data.soilMoisture.isValid(), data.lightLevel.isValid()
+    };
+    const uint8_t levels[] = {
+        channelLevel<AirTemperatureTraits>(data.airTemperature),
+        channelLevel<AirHumidityTraits>(data.airHumidity),
+        channelLevel<PressureTraits>(data.pressure),
+        channelLevel<SoilTemperatureTraits>(data.soilTemperature),
+        channelLevel<SoilMoistureTraits>(data.soilMoisture),
+        (uint8_t)constrain((uint32_t)data.lightLevel.raw() * 255 / Constants::LED_LIGHT_FULL_SCALE, 0u, 255u),
+    };
+
+    uint8_t doubt[(uint8_t)SensorChannel::COUNT];
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        if (valid[i]) {
+            barGraph(i, levels[i], heatColor(levels[i]));
+        } else {
+            setPixel(i, HEIGHT - 1, CRGB::DarkRed);
+        }
+        doubt[i] = 255 - sensorFusion.getConfidence((SensorChannel)i) * 255 / 100;
+    }
+
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        const DeviceManager::ControlChannel& channel = DeviceManager::getChannel(i);
+        if (deviceManager.getChannelValue(channel.id) != 0) {
+            setPixel(WIDTH - 2, i, CRGB::Cyan);
+        }
+    }
+
+    heatmap(WIDTH - 1, 0, 1, doubt, (uint8_t)SensorChannel::COUNT);
+}
+
+// Яркость фитосвета плавно идет к заданной
+void LedMatrix::updateGrowRamp(unsigned long now) {
+    unsigned long rampMs = GROW_PROFILES[(uint8_t)growProfile].rampMs;
+    unsigned long elapsed = now - growChange;
+    if (elapsed >= rampMs) {
+        growCurrent = growTarget;
+    } else {
+        growCurrent = growStart + ((int32_t)growTarget - growStart) * (int32_t)elapsed / (int32_t)rampMs;
+    }
+}
+
+// Вся матрица - цветом профиля
+void LedMatrix::renderGrowLight() {
+    CRGB color = GROW_PROFILES[(uint8_t)growProfile].color;
+    color.nscale8(growCurrent);
+    for (CRGB& pixel : frame) pixel = color;
+}
+
+// Мигающий квадрат цвета тревоги в правом верхнем углу. Яркость - как у
+// фитосвета, иначе на его фоне значок не виден
+void LedMatrix::renderAlarmOverlay(const SensorData& data, unsigned long now) {
+    CRGB color;
+    if (!activeAlarm(data, color) || (now / Constants::LED_ALARM_BLINK) % 2 != 0) return;
+
+    color.nscale8(growCurrent);
+    for (uint8_t y = 0; y < Constants::LED_ALARM_OVERLAY; y++) {
+        for (uint8_t x = WIDTH - Constants::LED_ALARM_OVERLAY; x < WIDTH; x++) {
+            frame[y * WIDTH + x] = color;
+        }
+    }
+}
+
+// Вывод только изменившегося кадра. Интервал кадров растет так, чтобы
+// вывод занимал не больше LED_MAX_DUTY_PERCENT времени цикла.
+bool LedMatrix::show() {
+    if (synced && memcmp(frame, shown, sizeof(frame)) == 0) {
+        skipped++;
+        return false;
+    }
+
+    memcpy(leds, frame, sizeof(frame));
+    uint32_t start = micros();
+    FastLED.show();
+    lastShowMicros = micros() - start;
+
+    memcpy(shown, frame, sizeof(frame));
+    synced = true;
+    shows++;
+
+    unsigned long budgetInterval = lastShowMicros * 100 / Constants::LED_MAX_DUTY_PERCENT / 1000;
+    frameInterval = budgetInterval > Constants::LED_FRAME_INTERVAL ? budgetInterval : Constants::LED_FRAME_INTERVAL;
+    return true;
+}
@@ -0,0 +1,75 @@
+#ifndef LED_MATRIX_H
+#define LED_MATRIX_H
+
+#include <FastLED.h>
+#include "Config.h"
+
+// Профили фитосвета: спектр и время плавного разгона яркости
+enum class GrowProfile : uint8_t {
+    FULL,         // белый, весь спектр
+    VEGETATIVE,   // синий с красным - рост зелени
+    FLOWERING,    // красный с синим - цветение
+    COUNT
+};
+
+// Матрица 8x8 WS2812. Два канала: фитосвет (выход LIGHT) и индикация
+// состояния. Пока фитосвет выключен, индикация занимает матрицу целиком.
+// Включенный фитосвет не прерывается: растения получают ровно тот свет,
+// который учитывают журнал выходов и EnergyMeter, а тревога показывается
+// мигающим угловым значком поверх него.
+// Кадр рисуется в буфер; FastLED.show() вызывается, только если кадр
+// отличается от выведенного, и не чаще, чем позволяет бюджет времени.
+class LedMatrix {
+public:
+    static constexpr uint8_t WIDTH = 8;
+    static constexpr uint8_t HEIGHT = 8;
+
+    void begin();
+    void update(const SensorData& data);
+
+    // Канал фитосвета: яркость 0 - выключен
+    void setGrowLight(uint8_t brightness);
+    void setGrowProfile(GrowProfile profile);
+    GrowProfile getGrowProfile() const { return growProfile; }
+    uint8_t getGrowBrightness() const { return growCurrent; }
+
+    uint32_t getShowCount() const { return shows; }
+    uint32_t getSkippedFrames() const { return skipped; }
+    uint32_t getLastShowMicros() const { return lastShowMicros; }
+
+    static const char* profileName(GrowProfile profile);
+    static GrowProfile parseProfile(StringView name);
+
+private:
+    // Виджеты
+    void clear();
+    void setPixel(uint8_t x, uint8_t y, CRGB color);
+    void barGraph(uint8_t x, uint8_t level, CRGB color);
+    void heatmap(uint8_t x, uint8_t y, uint8_t width, const uint8_t* levels, uint8_t count);
+    void icon(const uint8_t* rows, CRGB color);
+
+    const uint8_t* activeAlarm(const SensorData& data, CRGB& color) const;
+    void renderStatus(const SensorData& data, unsigned long now);
+    void updateGrowRamp(unsigned long now);
+    void renderGrowLight();
+    void renderAlarmOverlay(const SensorData& data, unsigned long now);
+    bool show();
+
+    CRGB frame[WIDTH * HEIGHT];
+    CRGB shown[WIDTH * HEIGHT];   // последний отправленный кадр
+
+    GrowProfile growProfile = GrowProfile::FULL;
+    uint8_t growTarget = 0;
+    uint8_t growCurrent = 0;
+    uint8_t growStart = 0;
+    unsigned long growChange = 0;
+
+    bool synced = false;
+    unsigned long lastFrame = 0;
+    unsigned long frameInterval = Constants::LED_FRAME_INTERVAL;
+    uint32_t lastShowMicros = 0;
+    uint32_t shows = 0;
+    uint32_t skipped = 0;
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "Logger.h"
+
+Logger logger;
+
+void Logger::begin() {
+    if (started) return;
+    started = true;
+
+    // Вывод в UART - на ядре 0 с низким приоритетом, чтобы не мешать циклу управления
+    xTaskCreatePinnedToCore(drainTask, "logger", 4096, this, 1, nullptr, 0);
+}
+
+void Logger::write(Level level, const char* format, ...) {
+    uint16_t suppressedBefore = 0;
+    if (!allow(format, suppressedBefore)) return;
+
+    uint32_t position;
+    Entry* entry = queue.reserve(position);
+    if (!entry) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    entry->timestamp = millis();
+    entry->level = level;
+
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(entry->text, sizeof(entry->text), format, args);
+    va_end(args);
+
+    if (suppressedBefore > 0 && length >= 0 && (size_t)length < sizeof(entry->text)) {
+        snprintf(entry->text + length, sizeof(entry->text) - length,
+                 " (+%u suppressed)", suppressedBefore);
+    }
+
+    // Публикация записи для фоновой задачи
+    queue.commit(position);
+}
+
+bool Logger::allow(const char* format, uint16_t& suppressedBefore) {
+    // Ограничение по месту вызова: строка формата уникальна для каждого LOG_*
+    unsigned long now = millis();
+    bool allowed = true;
+
+    portENTER_CRITICAL(&rateLock);
+
+    RateSlot* slot = nullptr;
+    RateSlot* oldest = &rateSlots[0];
+    for (uint8_t i = 0; i < RATE_SLOTS; i++) {
+        if (rateSlots[i].format == format) {
+            slot = &rateSlots[i];
+            break;
+        }
+        if (rateSlots[i].windowStart < oldest->windowStart) oldest = &rateSlots[i];
+    }
+
+    if (!slot) {
+        slot = oldest;
+        slot->format = format;
+        slot->windowStart = now;
+        slot->count = 0;
+        slot->suppressed = 0;
+    } else if (now - slot->windowStart >= RATE_WINDOW_MS) {
+        suppressedBefore = slot->suppressed;
+        slot->windowStart = now;
+        slot->count = 0;
+        slot->suppressed = 0;
+    }
+
+    if (++slot->count > RATE_BURST) {
+        slot->suppressed++;
+        suppressedTotal++;
+        allowed = false;
+    }
+
+    portEXIT_CRITICAL(&rateLock);
+    return allowed;
+}
+
+bool Logger::drainOne() {
+    const Entry* next = queue.front();
+    if (!next) return false;
+
+    const Entry& entry = *next;
+    Serial.printf("[%8lu][%c] %s\n", (unsigned long)entry.timestamp, levelChar(entry.level), entry.text);
+
+    portENTER_CRITICAL(&historyLock);
+    history[historyHead] = entry;
+    historyHead = (historyHead + 1) % HISTORY_SIZE;
+    if (historyCount < HISTORY_SIZE) historyCount++;
+    portEXIT_CRITICAL(&historyLock);
+
+    queue.release();
+    return true;
+}
+
+void Logger::drainTask(void* arg) {
+    Logger* self = static_cast<Logger*>(arg);
+    for (;;) {
+        while (self->drainOne()) {}
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+}
+
+uint8_t Logger::getRecentCount() const {
+    return historyCount;
+}
+
+bool Logger::getRecent(uint8_t index, Entry& entry) const {
+    bool found = false;
+
+    portENTER_CRITICAL(&historyLock);
+    if (index < historyCount) {
+        uint8_t start = (historyHead + HISTORY_SIZE - historyCount) % HISTORY_SIZE;
+        entry = history[(start + index) % HISTORY_SIZE];
+        found = true;
+    }
+    portEXIT_CRITICAL(&historyLock);
+
+    return found;
+}
+
+char Logger::levelChar(uint8_t level) {
+    switch (level) {
+        case LEVEL_ERROR: return 'E';
+        case LEVEL_WARN: return 'W';
+        case LEVEL_INFO: return 'I';
+        case LEVEL_DEBUG: return 'D';
+    }
+    return '?';
+}
@@ -0,0 +1,97 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <atomic>
+#include "Config.h"
+#include "MpscQueue.h"
+
+// Журнал с форматированием в кольцевой буфер без блокировок.
+// Вывод в Serial выполняет фоновая задача, поэтому вызов LOG_*
+// не ждет UART. Повторяющиеся сообщения из одного места ограничиваются.
+class Logger {
+public:
+    enum Level : uint8_t {
+        LEVEL_ERROR = LOG_LEVEL_ERROR,
+        LEVEL_WARN = LOG_LEVEL_WARN,
+        LEVEL_INFO = LOG_LEVEL_INFO,
+        LEVEL_DEBUG = LOG_LEVEL_DEBUG
+    };
+
+    struct Entry {
+        uint32_t timestamp;
+        uint8_t level;
+        char text[119];
+    };
+
+    void begin();
+    void write(Level level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    // Последние выведенные сообщения (0 - самое старое)
+    uint8_t getRecentCount() const;
+    bool getRecent(uint8_t index, Entry& entry) const;
+
+    uint32_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    uint32_t getSuppressedCount() const { return suppressedTotal; }
+
+    static char levelChar(uint8_t level);
+
+    static constexpr uint8_t QUEUE_SIZE = 32;      // степень двойки
+    static constexpr uint8_t HISTORY_SIZE = 24;
+    static constexpr uint8_t RATE_SLOTS = 8;
+    static constexpr uint8_t RATE_BURST = 5;
+    static constexpr unsigned long RATE_WINDOW_MS = 1000;
+
+private:
+    struct RateSlot {
+        const char* format;
+        unsigned long windowStart;
+        uint16_t count;
+        uint16_t suppressed;
+    };
+
+    bool allow(const char* format, uint16_t& suppressedBefore);
+    bool drainOne();
+    static void drainTask(void* arg);
+
+    MpscQueue<Entry, QUEUE_SIZE> queue;
+    std::atomic<uint32_t> dropped{0};
+
+    RateSlot rateSlots[RATE_SLOTS] = {};
+    uint32_t suppressedTotal = 0;
+    mutable portMUX_TYPE rateLock = portMUX_INITIALIZER_UNLOCKED;
+
+    Entry history[HISTORY_SIZE];
+    uint8_t historyHead = 0;
+    uint8_t historyCount = 0;
+    mutable portMUX_TYPE historyLock = portMUX_INITIALIZER_UNLOCKED;
+
+    bool started = false;
+};
+
+extern Logger logger;
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...) logger.write(Logger::LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(...) logger.write(Logger::LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...) logger.write(Logger::LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...) logger.write(Logger::LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+#endif
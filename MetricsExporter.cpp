@@ -0,0 +1,344 @@
+#include "MetricsExporter.h"
+#include "ControlStatus.h"
+#include "GlobalInstances.h"
+#include "HeapMonitor.h"
+#include "PowerManager.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
+
+// ===== Описание метрик =====
+// value   - одиночное значение без меток,
+// samples - семейство значений с метками (value == nullptr)
+struct MetricDescriptor {
+    const char* name;
+    const char* help;
+    const char* type;
+    double (*value)();
+    void (*samples)(MetricsExporter::Writer& out, const char* name);
+};
+
+static void actuatorStates(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice device = DeviceManager::getChannel(i).id;
+        snprintf(labels, sizeof(labels), "actuator=\"%s\"", DeviceNames::name(device));
+        out.sample(name, labels, (uint64_t)statusView.history.isActive(device));
+    }
+}
+
+static void actuatorOnTime(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice device = DeviceManager::getChannel(i).id;
+        snprintf(labels, sizeof(labels), "actuator=\"%s\"", DeviceNames::name(device));
+        out.sample(name, labels, statusView.history.getOnTimeMs(device) / 1000);
+    }
+}
+
+static void actuatorSwitches(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice device = DeviceManager::getChannel(i).id;
+        snprintf(labels, sizeof(labels), "actuator=\"%s\"", DeviceNames::name(device));
+        out.sample(name, labels, (uint64_t)statusView.history.getSwitchCount(device));
+    }
+}
+
+static void energyTotals(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice device = DeviceManager::getChannel(i).id;
+        if (statusView.energy.getRatedPower(device) == 0) continue;
+        snprintf(labels, sizeof(labels), "actuator=\"%s\"", DeviceNames::name(device));
+        out.sample(name, labels, statusView.energy.getEnergyKWh(device, EnergyPeriod::TOTAL) * 1000.0);
+    }
+}
+
+static void deviceStates(MetricsExporter::Writer& out, const char* name) {
+    char labels[48];
+    for (uint8_t i = 0; i < statusView.deviceCount; i++) {
+        const DeviceManager::DeviceStatus& status = statusView.deviceStatus[i];
+        snprintf(labels, sizeof(labels), "device=\"%s\",address=\"0x%02X\"", status.name, status.address);
+        out.sample(name, labels, (uint64_t)status.state);
+    }
+}
+
+static void sensorConfidence(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        snprintf(labels, sizeof(labels), "channel=\"%s\"", SensorFusion::channelName((SensorChannel)i));
+        out.sample(name, labels, (uint64_t)statusView.confidence[i]);
+    }
+}
+
+static void alarmStates(MetricsExporter::Writer& out, const char* name) {
+    char labels[48];
+    AlarmEngine::Name alarm;
+    for (uint8_t id = 0; id < AlarmEngine::ALARM_COUNT; id++) {
+        AlarmEngine::name(id, alarm);
+        snprintf(labels, sizeof(labels), "alarm=\"%s\"", alarm.c_str());
+        out.sample(name, labels, (uint64_t)statusView.alarms.getState(id));
+    }
+}
+
+static void alarmRaises(MetricsExporter::Writer& out, const char* name) {
+    char labels[48];
+    AlarmEngine::Name alarm;
+    for (uint8_t id = 0; id < AlarmEngine::ALARM_COUNT; id++) {
+        AlarmEngine::name(id, alarm);
+        snprintf(labels, sizeof(labels), "alarm=\"%s\"", alarm.c_str());
+        out.sample(name, labels, (uint64_t)statusView.alarms.getRaiseCount(id));
+    }
+}
+
+static void powerAwake(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < (uint8_t)PowerDomain::COUNT; i++) {
+        snprintf(labels, sizeof(labels), "subsystem=\"%s\"", PowerManager::domainName((PowerDomain)i));
+        out.sample(name, labels, statusView.awakeMicros((PowerDomain)i) / 1000000.0);
+    }
+}
+
+static void sensorRejected(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        snprintf(labels, sizeof(labels), "channel=\"%s\"", SensorFusion::channelName((SensorChannel)i));
+        out.sample(name, labels, (uint64_t)statusView.rejected[i]);
+    }
+}
+
+static void deviceErrors(MetricsExporter::Writer& out, const char* name) {
+    char labels[48];
+    for (uint8_t i = 0; i < statusView.deviceCount; i++) {
+        const DeviceManager::DeviceStatus& status = statusView.deviceStatus[i];
+        snprintf(labels, sizeof(labels), "device=\"%s\",address=\"0x%02X\"", status.name, status.address);
+        out.sample(name, labels, (uint64_t)status.totalErrors);
+    }
+}
+
+static void i2cTransactions(MetricsExporter::Writer& out, const char* name) {
+    char labels[40];
+    for (uint8_t i = 0; i < statusView.i2cStatsCount; i++) {
+        const I2CBus::AddressStats& stats = statusView.i2cStats[i];
+        snprintf(labels, sizeof(labels), "address=\"0x%02X\",result=\"ok\"", stats.address);
+        out.sample(name, labels, (uint64_t)stats.okCount);
+        snprintf(labels, sizeof(labels), "address=\"0x%02X\",result=\"error\"", stats.address);
+        out.sample(name, labels, (uint64_t)stats.errorCount);
+        snprintf(labels, sizeof(labels), "address=\"0x%02X\",result=\"timeout\"", stats.address);
+        out.sample(name, labels, (uint64_t)stats.timeoutCount);
+        snprintf(labels, sizeof(labels), "address=\"0x%02X\",result=\"data_error\"", stats.address);
+        out.sample(name, labels, (uint64_t)stats.dataErrorCount);
+    }
+}
+
+static void httpRequests(MetricsExporter::Writer& out, const char* name) {
+    char labels[40];
+    for (uint8_t i = 0; i < (uint8_t)HttpRoute::COUNT; i++) {
+        snprintf(labels, sizeof(labels), "path=\"%s\"", WebInterface::routePath((HttpRoute)i));
+        out.sample(name, labels, (uint64_t)webInterface.getRequestCount((HttpRoute)i));
+    }
+}
+
+static void heapRetained(MetricsExporter::Writer& out, const char* name) {
+    char labels[32];
+    for (uint8_t i = 0; i < (uint8_t)HeapSubsystem::COUNT; i++) {
+        snprintf(labels, sizeof(labels), "subsystem=\"%s\"", HeapMonitor::subsystemName((HeapSubsystem)i));
+        out.sample(name, labels, (double)heapMonitor.getStats((HeapSubsystem)i).retainedBytes);
+    }
+}
+
+static void controlJitter(MetricsExporter::Writer& out, const char* name) {
+    const LatencyHistogram<24>& jitter = statusView.jitterUs;
+    char totalName[64];
+
+    out.sample(name, "quantile=\"0.5\"", (uint64_t)jitter.percentile(50));
+    out.sample(name, "quantile=\"0.99\"", (uint64_t)jitter.percentile(99));
+    out.sample(name, "quantile=\"1\"", (uint64_t)jitter.max());
+    snprintf(totalName, sizeof(totalName), "%s_sum", name);
+    out.sample(totalName, nullptr, jitter.sum());
+    snprintf(totalName, sizeof(totalName), "%s_count", name);
+    out.sample(totalName, nullptr, (uint64_t)jitter.count());
+}
+
+#if ENABLE_PROFILING
+static void loopLatency(MetricsExporter::Writer& out, const char* name) {
+    const LatencyHistogram<32>& loop = profiler.get(ProfileStage::LOOP);
+    double cyclesPerUs = ESP.getCpuFreqMHz();
+    char totalName[64];
+
+    out.sample(name, "quantile=\"0.5\"", loop.percentile(50) / cyclesPerUs);
+    out.sample(name, "quantile=\"0.99\"", loop.percentile(99) / cyclesPerUs);
+    out.sample(name, "quantile=\"1\"", loop.max() / cyclesPerUs);
+    snprintf(totalName, sizeof(totalName), "%s_sum", name);
+    out.sample(totalName, nullptr, loop.sum() / cyclesPerUs);
+    snprintf(totalName, sizeof(totalName), "%s_count", name);
+    out.sample(totalName, nullptr, (uint64_t)loop.count());
+}
+#endif
+
+static const MetricDescriptor METRICS[] = {
+    {"greenhouse_air_temperature_celsius", "Air temperature", "gauge",
+     []() -> double { return sensorView.airTemperature.toFloat(); }, nullptr},
+    {"greenhouse_air_humidity_percent", "Air relative humidity", "gauge",
+     []() -> double { return sensorView.airHumidity.toFloat(); }, nullptr},
+    {"greenhouse_pressure_hpa", "Atmospheric pressure", "gauge",
+     []() -> double { return sensorView.pressure.toFloat(); }, nullptr},
+    {"greenhouse_soil_temperature_celsius", "Soil temperature", "gauge",
+     []() -> double { return sensorView.soilTemperature.toFloat(); }, nullptr},
+    {"greenhouse_soil_moisture_percent", "Soil moisture", "gauge",
+     []() -> double { return sensorView.soilMoisture.toFloat(); }, nullptr},
+    {"greenhouse_light_lux", "Illuminance", "gauge",
+     []() -> double { return sensorView.lightLevel.toFloat(); }, nullptr},
+    {"greenhouse_door_open", "Door sensor state (1 = open)", "gauge",
+     []() -> double { return sensorView.doorState; }, nullptr},
+    {"greenhouse_door_opens_total", "Door openings captured by the interrupt", "counter",
+     []() -> double { return statusView.door.openCount; }, nullptr},
+    {"greenhouse_door_open_seconds_total", "Cumulative time the door was open", "counter",
+     []() -> double { return statusView.door.totalOpenMs / 1000.0; }, nullptr},
+    {"greenhouse_system_healthy", "All required sensors healthy", "gauge",
+     []() -> double { return sensorView.systemHealthy; }, nullptr},
+
+    {"greenhouse_sensor_confidence", "Filtered channel confidence (0-100)", "gauge",
+     nullptr, sensorConfidence},
+    {"greenhouse_sensor_rejected_samples_total", "Samples rejected by range, rate or outlier checks", "counter",
+     nullptr, sensorRejected},
+
+    {"greenhouse_alarm_state", "Alarm state: 0 normal, 1 active, 2 acknowledged, 3 latched", "gauge",
+     nullptr, alarmStates},
+    {"greenhouse_alarm_raised_total", "Alarm condition onsets after debounce", "counter",
+     nullptr, alarmRaises},
+    {"greenhouse_trace_records_total", "Records appended to the automation trace", "counter",
+     []() -> double { return traceRecorder.getTotal(); }, nullptr},
+
+    {"greenhouse_actuator_state", "Actuator output state (1 = on)", "gauge",
+     nullptr, actuatorStates},
+    {"greenhouse_actuator_on_seconds_total", "Cumulative actuator on-time", "counter",
+     nullptr, actuatorOnTime},
+    {"greenhouse_actuator_switches_total", "Actuator off-to-on transitions", "counter",
+     nullptr, actuatorSwitches},
+    {"greenhouse_energy_wh_total", "Estimated actuator energy use from rated power", "counter",
+     nullptr, energyTotals},
+    {"greenhouse_water_litres_total", "Estimated pump water delivery", "counter",
+     []() -> double { return statusView.energy.getWaterLitres(EnergyPeriod::TOTAL); }, nullptr},
+
+    {"greenhouse_device_state", "Device health: 0 healthy, 1 degraded, 2 failed, 3 recovering", "gauge",
+     nullptr, deviceStates},
+    {"greenhouse_sensor_read_errors_total", "Failed sensor reads", "counter",
+     nullptr, deviceErrors},
+    {"greenhouse_i2c_transactions_total", "I2C transactions by outcome", "counter",
+     nullptr, i2cTransactions},
+    {"greenhouse_i2c_bus_recoveries_total", "I2C stuck-bus recoveries", "counter",
+     []() -> double { return statusView.i2cRecoveryCount; }, nullptr},
+
+    {"greenhouse_telemetry_frames_sent_total", "UDP telemetry frames sent", "counter",
+     []() -> double { return telemetryPublisher.getSentCount(); }, nullptr},
+    {"greenhouse_telemetry_send_errors_total", "UDP telemetry send failures", "counter",
+     []() -> double { return telemetryPublisher.getErrorCount(); }, nullptr},
+
+    {"greenhouse_mqtt_connected", "MQTT broker connection (1 = connected)", "gauge",
+     []() -> double { return mqttClient.isConnected(); }, nullptr},
+    {"greenhouse_mqtt_queued_messages", "Messages waiting in the MQTT offline queue", "gauge",
+     []() -> double { return mqttClient.getQueuedCount(); }, nullptr},
+    {"greenhouse_mqtt_published_total", "MQTT messages published", "counter",
+     []() -> double { return mqttClient.getPublishedCount(); }, nullptr},
+    {"greenhouse_mqtt_dropped_total", "MQTT messages dropped from a full queue", "counter",
+     []() -> double { return mqttClient.getDroppedCount(); }, nullptr},
+
+    {"greenhouse_power_awake_seconds_total", "Time spent awake per subsystem", "counter",
+     nullptr, powerAwake},
+    {"greenhouse_power_sleep_seconds_total", "Time spent in light sleep between cycles", "counter",
+     []() -> double { return powerManager.getSleepMicros() / 1000000.0; }, nullptr},
+    {"greenhouse_power_estimated_current_ma", "Average module current estimated from awake/sleep time", "gauge",
+     []() -> double { return powerManager.getAverageCurrentMa(); }, nullptr},
+
+    {"greenhouse_control_jitter_microseconds", "Deviation of the control cycle interval from its period", "summary",
+     nullptr, controlJitter},
+    {"greenhouse_control_overruns_total", "Control cycles longer than the period", "counter",
+     []() -> double { return statusView.overruns; }, nullptr},
+
+    {"greenhouse_heap_free_bytes", "Free heap", "gauge",
+     []() -> double { return ESP.getFreeHeap(); }, nullptr},
+    {"greenhouse_heap_largest_free_block_bytes", "Largest allocatable heap block", "gauge",
+     []() -> double { return ESP.getMaxAllocHeap(); }, nullptr},
+    {"greenhouse_heap_min_free_bytes", "Minimum free heap since boot", "gauge",
+     []() -> double { return ESP.getMinFreeHeap(); }, nullptr},
+    {"greenhouse_heap_fragmentation_percent", "1 - largest block / free heap", "gauge",
+     []() -> double { return heapMonitor.fragmentationPercent(); }, nullptr},
+    {"greenhouse_heap_largest_block_trend_bytes_per_hour", "Largest block slope over the sample window", "gauge",
+     []() -> double { return heapMonitor.largestBlockTrend(); }, nullptr},
+    {"greenhouse_heap_retained_bytes", "Net heap retained per subsystem", "gauge",
+     nullptr, heapRetained},
+    {"greenhouse_uptime_seconds", "Time since boot", "gauge",
+     []() -> double { return millis() / 1000; }, nullptr},
+
+#if ENABLE_PROFILING
+    {"greenhouse_loop_duration_microseconds", "Control cycle time", "summary",
+     nullptr, loopLatency},
+#endif
+    {"greenhouse_http_requests_total", "HTTP requests by route", "counter",
+     nullptr, httpRequests},
+};
+
+// ===== Вывод =====
+void MetricsExporter::render(WebServer& server) {
+    server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server.send(200, "text/plain; version=0.0.4; charset=utf-8", "");
+
+    Writer out(server);
+    for (const MetricDescriptor& metric : METRICS) {
+        out.header(metric.name, metric.help, metric.type);
+        if (metric.value) {
+            out.sample(metric.name, nullptr, metric.value());
+        } else {
+            metric.samples(out, metric.name);
+        }
+    }
+    out.flush();
+
+    // Пустой чанк завершает ответ
+    server.sendContent("", 0);
+}
+
+void MetricsExporter::Writer::header(const char* name, const char* help, const char* type) {
+    append("# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+void MetricsExporter::Writer::sample(const char* name, const char* labels, double value) {
+    if (isnan(value)) {
+        if (labels) append("%s{%s} NaN\n", name, labels);
+        else append("%s NaN\n", name);
+    } else {
+        if (labels) append("%s{%s} %.6g\n", name, labels, value);
+        else append("%s %.6g\n", name, value);
+    }
+}
+
+void MetricsExporter::Writer::sample(const char* name, const char* labels, uint64_t value) {
+    if (labels) append("%s{%s} %llu\n", name, labels, (unsigned long long)value);
+    else append("%s %llu\n", name, (unsigned long long)value);
+}
+
+void MetricsExporter::Writer::flush() {
+    if (length == 0) return;
+    server.sendContent(buffer, length);
+    length = 0;
+}
+
+void MetricsExporter::Writer::append(const char* format, ...) {
+    for (uint8_t attempt = 0; attempt < 2; attempt++) {
+        va_list args;
+        va_start(args, format);
+        int written = vsnprintf(buffer + length, sizeof(buffer) - length, format, args);
+        va_end(args);
+
+        if (written < 0) return;
+        if ((size_t)written < sizeof(buffer) - length) {
+            length += written;
+            return;
+        }
+
+        // Строка не поместилась: отправляем накопленное и повторяем
+        if (length == 0) return;
+        flush();
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef METRICS_EXPORTER_H
+#define METRICS_EXPORTER_H
+
+#include <WebServer.h>
+#include "Config.h"
+
+// Экспорт метрик в текстовом формате Prometheus.
+// Метрики описаны статической таблицей и выводятся блоками прямо в сокет
+// через фиксированный буфер, без построения String.
+class MetricsExporter {
+public:
+    // Буфер вывода: накапливает строки и отправляет их чанками
+    class Writer {
+    public:
+        explicit Writer(WebServer& server) : server(server) {}
+
+        void header(const char* name, const char* help, const char* type);
+        void sample(const char* name, const char* labels, double value);
+        void sample(const char* name, const char* labels, uint64_t value);
+        void flush();
+
+    private:
+        void append(const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+        WebServer& server;
+        char buffer[512];
+        size_t length = 0;
+    };
+
+    void render(WebServer& server);
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include "SpscQueue.h"
+
+// Ограниченная очередь для нескольких производителей и одного потребителя
+// (схема Вьюкова): ячейка хранит счетчик последовательности, производители
+// резервируют позиции через CAS. Без блокировок - можно звать из ISR и из
+// задач на обоих ядрах. Переполнение не ждет потребителя: push() -> false.
+//
+// Счетчик хранится со смещением на номер ячейки, чтобы нулевая
+// статическая инициализация была корректной до вызова конструкторов.
+template <typename T, uint32_t SIZE>
+class MpscQueue {
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "MpscQueue size must be a power of two");
+
+public:
+    // Производитель: ячейка заполняется на месте и публикуется commit().
+    // nullptr - очередь заполнена.
+    QUEUE_INLINE T* reserve(uint32_t& position) {
+        position = enqueuePosition.load(std::memory_order_relaxed);
+        for (;;) {
+            uint32_t index = position & (SIZE - 1);
+            Slot& slot = slots[index];
+            uint32_t sequence = slot.sequence.load(std::memory_order_acquire) + index;
+            int32_t diff = (int32_t)(sequence - position);
+
+            if (diff == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1,
+                                                          std::memory_order_relaxed)) {
+                    return &slot.item;
+                }
+            } else if (diff < 0) {
+                return nullptr;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    QUEUE_INLINE void commit(uint32_t position) {
+        uint32_t index = position & (SIZE - 1);
+        slots[index].sequence.store(position + 1 - index, std::memory_order_release);
+    }
+
+    QUEUE_INLINE bool push(const T& item) {
+        uint32_t position;
+        T* slot = reserve(position);
+        if (!slot) return false;
+        *slot = item;
+        commit(position);
+        return true;
+    }
+
+    // Потребитель: следующий опубликованный элемент или nullptr. Пока
+    // производитель не сделал commit() своей ячейки, следующие за ней ждут.
+    QUEUE_INLINE const T* front() const {
+        uint32_t index = dequeuePosition & (SIZE - 1);
+        uint32_t sequence = slots[index].sequence.load(std::memory_order_acquire) + index;
+        if ((int32_t)(sequence - (dequeuePosition + 1)) < 0) return nullptr;
+        return &slots[index].item;
+    }
+
+    QUEUE_INLINE void release() {
+        uint32_t index = dequeuePosition & (SIZE - 1);
+        slots[index].sequence.store(dequeuePosition + SIZE - index, std::memory_order_release);
+        dequeuePosition++;
+    }
+
+    QUEUE_INLINE bool pop(T& item) {
+        const T* next = front();
+        if (!next) return false;
+        item = *next;
+        release();
+        return true;
+    }
+
+    static constexpr uint32_t capacity() { return SIZE; }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> sequence;
+        T item;
+    };
+
+    Slot slots[SIZE];
+    alignas(QUEUE_CACHE_LINE) std::atomic<uint32_t> enqueuePosition{0};   // производители
+    alignas(QUEUE_CACHE_LINE) uint32_t dequeuePosition = 0;               // потребитель
+};
+
+#endif
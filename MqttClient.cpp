@@ -0,0 +1,225 @@
+#include "MqttClient.h"
+#include "ControlStatus.h"
+#include "GlobalInstances.h"
+#include "Logger.h"
+#include "PowerManager.h"
+
+MqttClient::MqttClient() : client(network) {
+}
+
+void MqttClient::begin() {
+    baseTopic.appendf("greenhouse/%08X", (unsigned)(uint32_t)ESP.getEfuseMac());
+    controlTopic.appendf("%s/control/set", baseTopic.c_str());
+    settingsTopic.appendf("%s/settings/set", baseTopic.c_str());
+    statusTopic.appendf("%s/status", baseTopic.c_str());
+
+    // Буфер PubSubClient вмещает заголовок, топик и полезную нагрузку
+    client.setBufferSize(PAYLOAD_SIZE + 64 + 8);
+    client.setSocketTimeout(Constants::MQTT_SOCKET_TIMEOUT);
+    client.setCallback([this](char* topic, uint8_t* payload, unsigned int length) {
+        handleMessage(topic, payload, length);
+    });
+    alarmEngine.addListener([](uint8_t id, AlarmState state) {
+        mqttClient.publishAlarm(id, state);
+    });
+
+    LOG_INFO("📡 MQTT %s, broker %s:%u, topic %s",
+             systemSettings.mqttEnabled ? "enabled" : "disabled",
+             systemSettings.mqttHost, systemSettings.mqttPort, baseTopic.c_str());
+}
+
+void MqttClient::update() {
+    if (!systemSettings.mqttEnabled || systemSettings.mqttHost[0] == '\0') {
+        if (wasConnected) {
+            client.disconnect();
+            wasConnected = false;
+        }
+        return;
+    }
+
+    unsigned long now = millis();
+
+    // Состояние ставится в очередь и без связи - отправится после переподключения
+    if (lastPublish == 0 || now - lastPublish >= Constants::MQTT_PUBLISH_INTERVAL) {
+        lastPublish = now;
+        enqueueState();
+    }
+    enqueueAlarms();
+
+    if (WiFi.status() != WL_CONNECTED) return;
+
+    if (!client.connected()) {
+        if (wasConnected) {
+            LOG_WARN("⚠️ MQTT connection lost (state %d)", client.state());
+            wasConnected = false;
+        }
+        // Попытки подключения блокируют цикл, поэтому разрежены с нарастающей паузой
+        if (lastAttempt != 0 && now - lastAttempt < backoff) return;
+        lastAttempt = now;
+
+        if (!connect()) {
+            backoff = (backoff >= Constants::MQTT_RECONNECT_MAX / 2) ? Constants::MQTT_RECONNECT_MAX : backoff * 2;
+            LOG_WARN("⚠️ MQTT connect to %s:%u failed (state %d), retry in %lus",
+                     systemSettings.mqttHost, systemSettings.mqttPort, client.state(), backoff / 1000);
+            return;
+        }
+        backoff = Constants::MQTT_RECONNECT_MIN;
+    }
+
+    client.loop();
+    flush(Constants::MQTT_FLUSH_BATCH);
+}
+
+bool MqttClient::connect() {
+    client.setServer(systemSettings.mqttHost, systemSettings.mqttPort);
+
+    FixedString<24> clientId;
+    clientId.appendf("greenhouse-%08X", (unsigned)(uint32_t)ESP.getEfuseMac());
+
+    if (!client.connect(clientId.c_str(), statusTopic.c_str(), 0, true, "offline")) {
+        return false;
+    }
+
+    client.publish(statusTopic.c_str(), "online", true);
+    client.subscribe(controlTopic.c_str());
+    client.subscribe(settingsTopic.c_str());
+
+    wasConnected = true;
+    reconnects++;
+    LOG_INFO("✅ MQTT connected, %u queued message(s) to flush", queueCount);
+    return true;
+}
+
+void MqttClient::flush(uint8_t limit) {
+    FixedString<64> topic;
+
+    for (uint8_t sent = 0; sent < limit && queueCount > 0; sent++) {
+        const Message& message = queue[queueHead];
+        topic.clear();
+        topic.appendf("%s/%s", baseTopic.c_str(), topicSuffix(message.topic));
+
+        if (!client.publish(topic.c_str(), (const uint8_t*)message.payload, message.length, false)) {
+            // Сообщение остается в очереди до следующей попытки
+            return;
+        }
+
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        queueCount--;
+        published++;
+    }
+}
+
+void MqttClient::enqueue(Topic topic, StringView payload) {
+    if (payload.length() > PAYLOAD_SIZE) {
+        LOG_ERROR("❌ MQTT payload too large: %u bytes", (unsigned)payload.length());
+        return;
+    }
+
+    // Очередь заполнена - вытесняем самое старое сообщение
+    if (queueCount == QUEUE_SIZE) {
+        queueHead = (queueHead + 1) % QUEUE_SIZE;
+        queueCount--;
+        dropped++;
+    }
+
+    Message& message = queue[(queueHead + queueCount) % QUEUE_SIZE];
+    message.topic = topic;
+    message.length = payload.length();
+    memcpy(message.payload, payload.data(), payload.length());
+    queueCount++;
+}
+
+// Значение датчика или null, если его нет
+template <size_t N>
+static void appendReading(FixedString<N>& out, const char* name, float value, uint8_t decimals) {
+    if (isnan(value)) {
+        out.appendf(",\"%s\":null", name);
+    } else {
+        out.appendf(",\"%s\":%.*f", name, decimals, value);
+    }
+}
+
+void MqttClient::enqueueState() {
+    unsigned long now = millis();
+
+    FixedString<PAYLOAD_SIZE> sensors;
+    sensors.appendf("{\"t\":%lu", now);
+    appendReading(sensors, "airTemperature", sensorView.airTemperature.toFloat(), 2);
+    appendReading(sensors, "airHumidity", sensorView.airHumidity.toFloat(), 2);
+    appendReading(sensors, "pressure", sensorView.pressure.toFloat(), 1);
+    appendReading(sensors, "soilTemperature", sensorView.soilTemperature.toFloat(), 2);
+    appendReading(sensors, "soilMoisture", sensorView.soilMoisture.toFloat(), 2);
+    appendReading(sensors, "lightLevel", sensorView.lightLevel.toFloat(), 1);
+    sensors.appendf(",\"healthy\":%d}", sensorView.systemHealthy);
+    enqueue(Topic::SENSORS, sensors);
+
+    FixedString<PAYLOAD_SIZE> actuators;
+    actuators.appendf("{\"t\":%lu", now);
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice device = DeviceManager::getChannel(i).id;
+        actuators.appendf(",\"%s\":%d", DeviceNames::name(device), statusView.channelValue[(uint8_t)device]);
+    }
+    actuators += '}';
+    enqueue(Topic::ACTUATORS, actuators);
+}
+
+// Тревоги идут в ту же очередь: без связи доставляются после переподключения
+void MqttClient::publishAlarm(uint8_t id, AlarmState state) {
+    if (!systemSettings.mqttEnabled) return;
+
+    if (!alarmEvents.push({(uint32_t)millis(), id, state})) {
+        LOG_WARN("⚠️ MQTT alarm event dropped: %u", id);
+    }
+}
+
+void MqttClient::enqueueAlarms() {
+    AlarmEvent event;
+    while (alarmEvents.pop(event)) {
+        AlarmEngine::Name name;
+        AlarmEngine::name(event.id, name);
+        FixedString<PAYLOAD_SIZE> payload;
+        payload.appendf("{\"t\":%lu,\"alarm\":\"%s\",\"state\":\"%s\"}",
+                        (unsigned long)event.timeMs, name.c_str(), AlarmEngine::stateName(event.state));
+        enqueue(Topic::ALARMS, payload);
+    }
+}
+
+void MqttClient::handleMessage(const char* topic, const uint8_t* payload, unsigned int length) {
+    bool isControl = controlTopic == topic;
+    if (!isControl && settingsTopic != topic) return;
+
+    LOG_INFO("📨 MQTT %s (%u bytes)", topic, length);
+    powerManager.noteNetworkActivity();
+
+    FixedString<64> message;
+    int code;
+    DeserializationError error = deserializeJson(commandDoc, (const char*)payload, length);
+
+    if (error) {
+        code = 400;
+        message.appendf("Invalid JSON: %s", error.c_str());
+    } else if (isControl) {
+        code = webInterface.executeControl(commandDoc.as<JsonVariantConst>(), message, ControlCause::MQTT);
+    } else {
+        code = webInterface.applySettings(commandDoc.as<JsonVariantConst>(), message);
+    }
+    commandDoc.clear();
+
+    // Ответ публикуется через ту же очередь, что и телеметрия
+    FixedString<PAYLOAD_SIZE> result;
+    result.appendf("{\"status\":%d,\"message\":", code);
+    result.appendJsonString(message, 1);
+    result += '}';
+    enqueue(isControl ? Topic::CONTROL_RESULT : Topic::SETTINGS_RESULT, result);
+}
+
+const char* MqttClient::topicSuffix(Topic topic) const {
+    switch (topic) {
+        case Topic::SENSORS: return "sensors";
+        case Topic::ACTUATORS: return "actuators";
+        case Topic::CONTROL_RESULT: return "control/result";
+        case Topic::SETTINGS_RESULT: return "settings/result";
+        case Topic::ALARMS: return "alarms";
+    }
+    return "unknown";
+}
@@ -0,0 +1,100 @@
+#ifndef MQTT_CLIENT_H
+#define MQTT_CLIENT_H
+
+#include <WiFi.h>
+#include <PubSubClient.h>
+#include <ArduinoJson.h>
+#include "Config.h"
+#include "AlarmEngine.h"
+#include "SpscQueue.h"
+
+// Интеграция с MQTT брокером.
+// Публикации проходят через ограниченную очередь: без связи сообщения
+// накапливаются (старые вытесняются), после переподключения отправляются
+// порциями из update(). Команды и настройки, пришедшие по MQTT,
+// обрабатываются той же логикой, что и HTTP API.
+//
+// Топики (<base> = greenhouse/<id устройства>):
+//   <base>/status             online/offline, retained, last will
+//   <base>/sensors            показания датчиков
+//   <base>/actuators          состояние выходов
+//   <base>/control/set        -> команды в формате /api/control
+//   <base>/settings/set       -> настройки в формате /api/settings
+//   <base>/control/result     ответы на команды
+//   <base>/settings/result    ответы на изменение настроек
+//   <base>/alarms             смена состояния тревог
+class MqttClient {
+public:
+    MqttClient();
+    void begin();
+    void update();
+    // Вызывается из цикла управления: событие ставится в кольцо и
+    // публикуется сетевой стороной из update()
+    void publishAlarm(uint8_t id, AlarmState state);
+
+    bool isConnected() { return client.connected(); }
+    uint8_t getQueuedCount() const { return queueCount; }
+    uint32_t getPublishedCount() const { return published; }
+    uint32_t getDroppedCount() const { return dropped; }
+    uint32_t getReconnectCount() const { return reconnects; }
+
+    static constexpr uint8_t QUEUE_SIZE = 16;
+    static constexpr uint8_t PAYLOAD_SIZE = 200;
+    static constexpr uint8_t ALARM_QUEUE_SIZE = 8;     // степень двойки
+
+private:
+    enum class Topic : uint8_t {
+        SENSORS,
+        ACTUATORS,
+        CONTROL_RESULT,
+        SETTINGS_RESULT,
+        ALARMS
+    };
+
+    struct AlarmEvent {
+        uint32_t timeMs;
+        uint8_t id;
+        AlarmState state;
+    };
+
+    struct Message {
+        Topic topic;
+        uint8_t length;
+        char payload[PAYLOAD_SIZE];
+    };
+
+    bool connect();
+    void flush(uint8_t limit);
+    void enqueue(Topic topic, StringView payload);
+    void enqueueState();
+    void enqueueAlarms();
+    void handleMessage(const char* topic, const uint8_t* payload, unsigned int length);
+    const char* topicSuffix(Topic topic) const;
+
+    WiFiClient network;
+    PubSubClient client;
+    StaticJsonDocument<512> commandDoc;
+
+    FixedString<32> baseTopic;
+    FixedString<48> controlTopic;
+    FixedString<48> settingsTopic;
+    FixedString<48> statusTopic;
+
+    Message queue[QUEUE_SIZE];
+    uint8_t queueHead = 0;
+    uint8_t queueCount = 0;
+
+    // Один писатель (цикл управления), один читатель (update())
+    SpscQueue<AlarmEvent, ALARM_QUEUE_SIZE> alarmEvents;
+
+    unsigned long lastPublish = 0;
+    unsigned long lastAttempt = 0;
+    unsigned long backoff = Constants::MQTT_RECONNECT_MIN;
+    bool wasConnected = false;
+
+    uint32_t published = 0;
+    uint32_t dropped = 0;
+    uint32_t reconnects = 0;
+};
+
+#endif
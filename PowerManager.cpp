@@ -0,0 +1,100 @@
+#include "PowerManager.h"
+#include <WiFi.h>
+#include <esp_sleep.h>
+#include <esp_pm.h>
+#include <driver/gpio.h>
+#include "DeviceManager.h"
+#include "Logger.h"
+
+PowerManager powerManager;
+
+void PowerManager::begin() {
+    if (!systemSettings.lowPowerMode) {
+        LOG_INFO("🔋 Power management: always on");
+        return;
+    }
+
+    // Модем спит между маяками точки доступа, соединение сохраняется
+    WiFi.setSleep(true);
+
+    // Выходы не переключаются на спящую конфигурацию пинов - реле и
+    // матрица сохраняют состояние на время сна
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        gpio_sleep_sel_dis((gpio_num_t)DeviceManager::getChannel(i).pin);
+    }
+    gpio_sleep_sel_dis((gpio_num_t)Pins::LED_MATRIX);
+
+#if CONFIG_PM_ENABLE && CONFIG_FREERTOS_USE_TICKLESS_IDLE
+    // Автоматический light sleep: чип засыпает, когда все задачи ждут,
+    // и просыпается по таймеру FreeRTOS, GPIO и приему Wi-Fi
+    esp_pm_config_esp32_t config = {
+        .max_freq_mhz = Constants::POWER_MAX_CPU_MHZ,
+        .min_freq_mhz = Constants::POWER_MIN_CPU_MHZ,
+        .light_sleep_enable = true
+    };
+    automaticLightSleep = esp_pm_configure(&config) == ESP_OK;
+#endif
+
+    if (automaticLightSleep) {
+        LOG_INFO("🔋 Power management: low power, automatic light sleep");
+    } else {
+        // Ручной esp_light_sleep_start() останавливает оба ядра и не
+        // сохраняет соединение Wi-Fi - без PM и tickless idle сна нет
+        LOG_WARN("⚠️ Power management: light sleep needs CONFIG_PM_ENABLE and tickless idle, modem sleep only");
+    }
+}
+
+bool PowerManager::idle(unsigned long sleepMs) {
+    if (!systemSettings.lowPowerMode || !automaticLightSleep) return false;
+    if (millis() - lastNetworkActivity < Constants::POWER_NETWORK_HOLD_MS) return false;
+    // Точка доступа обслуживает клиентов сама и спать не может
+    if (WiFi.getMode() == WIFI_AP || WiFi.getMode() == WIFI_AP_STA) return false;
+    if (sleepMs > Constants::POWER_MAX_SLEEP_MS) sleepMs = Constants::POWER_MAX_SLEEP_MS;
+    if (sleepMs < Constants::POWER_MIN_SLEEP_MS) return false;
+
+    // Пробуждение по двери: уровень, противоположный текущему
+    bool doorClosed = digitalRead(Pins::DOOR_SENSOR) == HIGH;
+    gpio_wakeup_enable((gpio_num_t)Pins::DOOR_SENSOR, doorClosed ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+
+    // Задача ждет уведомления, остальное делает idle-задача FreeRTOS: чип
+    // засыпает, только когда ждут задачи обоих ядер, и стек Wi-Fi просыпается
+    // к маякам точки доступа сам
+    uint32_t start = micros();
+    sleepingTask = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(sleepMs));
+    sleepingTask = nullptr;
+    sleepMicros += micros() - start;
+    sleeps++;
+    return true;
+}
+
+void IRAM_ATTR PowerManager::wakeFromISR() {
+    woken.store(true);
+    // Дверь обрабатывает цикл управления: будить сетевую задачу бесполезно
+    void* task = doorTask ? doorTask : sleepingTask;
+    if (!task) return;
+    BaseType_t yield = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t)task, &yield);
+    portYIELD_FROM_ISR(yield);
+}
+
+float PowerManager::getAverageCurrentMa() const {
+    uint64_t total = (uint64_t)millis() * 1000;
+    if (total == 0) return 0;
+    uint64_t sleep = sleepMicros < total ? sleepMicros : total;
+
+    float activeMa = systemSettings.lowPowerMode ? Constants::POWER_MODEM_SLEEP_MA : Constants::POWER_ACTIVE_MA;
+    return (activeMa * (total - sleep) + Constants::POWER_LIGHT_SLEEP_MA * sleep) / total;
+}
+
+const char* PowerManager::domainName(PowerDomain domain) {
+    switch (domain) {
+        case PowerDomain::NETWORK: return "network";
+        case PowerDomain::SENSORS: return "sensors";
+        case PowerDomain::CONTROL: return "control";
+        case PowerDomain::DISPLAY: return "display";
+        case PowerDomain::COUNT: break;
+    }
+    return "unknown";
+}
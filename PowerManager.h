@@ -0,0 +1,82 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <atomic>
+#include "Config.h"
+
+// Подсистемы для учета времени бодрствования
+enum class PowerDomain : uint8_t {
+    NETWORK,      // HTTP, MQTT, телеметрия
+    SENSORS,      // опрос и фильтрация датчиков
+    CONTROL,      // автоматика, тревоги, дверь, учет энергии
+    DISPLAY,      // индикатор и LED матрица
+    COUNT
+};
+
+// Режим пониженного потребления для питания от батареи/солнца.
+// Между циклами управления чип засыпает автоматическим light sleep
+// (сборка с CONFIG_PM_ENABLE и tickless idle): пробуждение по таймеру
+// FreeRTOS, по двери (GPIO) и по Wi-Fi, соединение сохраняется. В сборке
+// без этих опций остаются modem sleep и разовые измерения датчиков.
+// Выходы сохраняют уровни во сне. Потребление оценивается по времени
+// бодрствования и сна, а не измеряется.
+class PowerManager {
+public:
+    void begin();
+    // Сон не дольше sleepMs (или POWER_MAX_SLEEP_MS); в обычном режиме и без
+    // автоматического light sleep - сразу возврат. false - сна не было.
+    bool idle(unsigned long sleepMs);
+    // Дверь (из ISR): будит задачу управления, а без нее - ждущего в idle()
+    void wakeFromISR();
+    // Задача управления ждет уведомления вместо vTaskDelayUntil
+    void setDoorTask(void* task) { doorTask = task; }
+    // Было ли пробуждение по двери с прошлого вызова (для loop())
+    bool takeWake() { return woken.exchange(false); }
+    // После сетевого запроса чип некоторое время не засыпает
+    void noteNetworkActivity() { lastNetworkActivity = millis(); }
+
+    // Время бодрствования ведется по ядрам: строку ядра пишут только его
+    // задачи, 64-битные суммы не рвутся. Ядро управления публикует свою
+    // строку через ControlStatus, сеть читает на месте только свою.
+    void addAwakeMicros(PowerDomain domain, uint32_t micros) { awakeMicros[xPortGetCoreID()][(uint8_t)domain] += micros; }
+
+    bool isLowPower() const { return systemSettings.lowPowerMode; }
+    bool hasAutomaticLightSleep() const { return automaticLightSleep; }
+    uint64_t getAwakeMicros(PowerDomain domain, uint8_t core) const { return awakeMicros[core][(uint8_t)domain]; }
+    // Сон ведет idle() - сетевая задача или loop()
+    uint64_t getSleepMicros() const { return sleepMicros; }
+    uint32_t getSleepCount() const { return sleeps; }
+    float getAverageCurrentMa() const;
+
+    static const char* domainName(PowerDomain domain);
+
+private:
+    bool automaticLightSleep = false;
+    void* sleepingTask = nullptr;   // задача, ждущая в idle()
+    void* doorTask = nullptr;       // задача управления, обрабатывающая дверь
+    std::atomic<bool> woken{false};
+    unsigned long lastNetworkActivity = 0;
+
+    uint64_t awakeMicros[2][(uint8_t)PowerDomain::COUNT] = {};
+    uint64_t sleepMicros = 0;
+    uint32_t sleeps = 0;
+};
+
+extern PowerManager powerManager;
+
+// Время от создания до выхода из области видимости - бодрствование подсистемы
+class PowerScope {
+public:
+    explicit PowerScope(PowerDomain domain) : domain(domain), start(micros()) {}
+    ~PowerScope() { powerManager.addAwakeMicros(domain, micros() - start); }
+
+private:
+    PowerDomain domain;
+    uint32_t start;
+};
+
+#define POWER_CONCAT_(a, b) a##b
+#define POWER_CONCAT(a, b) POWER_CONCAT_(a, b)
+#define POWER_SCOPE(domain) PowerScope POWER_CONCAT(powerScope, __LINE__)(PowerDomain::domain)
+
+#endif
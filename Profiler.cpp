@@ -0,0 +1,40 @@
+#include "Profiler.h"
+
+#if ENABLE_PROFILING
+
+Profiler profiler;
+
+void Profiler::requestReset() {
+    for (auto& flag : resetRequested) {
+        flag.store(true, std::memory_order_relaxed);
+    }
+}
+
+const char* Profiler::stageName(ProfileStage stage) {
+    switch (stage) {
+        case ProfileStage::LOOP: return "loop";
+        case ProfileStage::SENSORS: return "readAllSensors";
+        case ProfileStage::AUTOMATION: return "automation";
+        case ProfileStage::DISPLAY: return "display";
+        case ProfileStage::HTTP_CLIENT: return "handleClient";
+        case ProfileStage::HTTP_ROOT: return "http_root";
+        case ProfileStage::HTTP_SENSORS: return "http_sensors";
+        case ProfileStage::HTTP_SETTINGS: return "http_settings";
+        case ProfileStage::HTTP_CONTROL: return "http_control";
+        case ProfileStage::HTTP_SYSTEM: return "http_system";
+        case ProfileStage::HTTP_CALIBRATE: return "http_calibrate";
+        case ProfileStage::HTTP_RESET: return "http_reset";
+        case ProfileStage::HTTP_METRICS: return "http_metrics";
+        case ProfileStage::HTTP_PROMETHEUS: return "http_prometheus";
+        case ProfileStage::HTTP_LOGS: return "http_logs";
+        case ProfileStage::HTTP_HISTORY: return "http_history";
+        case ProfileStage::HTTP_ENERGY: return "http_energy";
+        case ProfileStage::HTTP_ALARMS: return "http_alarms";
+        case ProfileStage::HTTP_TRACE: return "http_trace";
+        case ProfileStage::HTTP_STATIC: return "http_static";
+        case ProfileStage::COUNT: break;
+    }
+    return "unknown";
+}
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "Config.h"
+
+#if ENABLE_PROFILING
+
+#include <atomic>
+#include "LatencyHistogram.h"
+
+// Участки, время которых замеряется по счетчику тактов ESP32
+enum class ProfileStage : uint8_t {
+  LOOP,
+  SENSORS,
+  AUTOMATION,
+  DISPLAY,
+  HTTP_CLIENT,
+  HTTP_ROOT,
+  HTTP_SENSORS,
+  HTTP_SETTINGS,
+  HTTP_CONTROL,
+  HTTP_SYSTEM,
+  HTTP_CALIBRATE,
+  HTTP_RESET,
+  HTTP_METRICS,
+  HTTP_PROMETHEUS,
+  HTTP_LOGS,
+  HTTP_HISTORY,
+  HTTP_ENERGY,
+  HTTP_ALARMS,
+  HTTP_TRACE,
+  HTTP_STATIC,
+  COUNT
+};
+
+// Участок замеряется всегда на одном ядре (управление или сеть), поэтому
+// гистограмма пишется без блокировки. Сброс из сети только помечает
+// участки, очищает гистограмму ее же писатель при следующем замере.
+class Profiler {
+public:
+    void record(ProfileStage stage, uint32_t cycles) {
+        LatencyHistogram<32>& histogram = stages[(uint8_t)stage];
+        if (resetRequested[(uint8_t)stage].exchange(false, std::memory_order_relaxed)) histogram.reset();
+        histogram.record(cycles);
+    }
+
+    const LatencyHistogram<32>& get(ProfileStage stage) const {
+        return stages[(uint8_t)stage];
+    }
+
+    void requestReset();
+    static const char* stageName(ProfileStage stage);
+
+private:
+    LatencyHistogram<32> stages[(uint8_t)ProfileStage::COUNT];
+    std::atomic<bool> resetRequested[(uint8_t)ProfileStage::COUNT] = {};
+};
+
+extern Profiler profiler;
+
+// Замер времени от создания до выхода из области видимости
+class ScopedTimer {
+public:
+    explicit ScopedTimer(ProfileStage stage) : stage(stage), start(ESP.getCycleCount()) {}
+    ~ScopedTimer() { profiler.record(stage, ESP.getCycleCount() - start); }
+
+private:
+    ProfileStage stage;
+    uint32_t start;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(stage) ScopedTimer PROFILE_CONCAT(profileTimer, __LINE__)(ProfileStage::stage)
+
+#else
+
+#define PROFILE_SCOPE(stage)
+
+#endif
+
+#endif
@@ -0,0 +1,51 @@
+#include "SegmentDisplay.h"
+
+void SegmentDisplay::print(StringView text) {
+    uint8_t segments[DIGITS] = {};
+    SegmentFont::encode(text, segments, DIGITS);
+    setAll(segments);
+}
+
+void SegmentDisplay::printNumber(int number, bool leadingZero, uint8_t width, uint8_t position) {
+    if (position >= DIGITS) return;
+    if (width > DIGITS - position) width = DIGITS - position;
+
+    bool negative = number < 0;
+    unsigned value = negative ? -(long)number : number;
+
+    // Справа налево; знак минус занимает одно знакоместо перед старшей цифрой
+    int8_t pos = position + width - 1;
+    do {
+        set(pos--, SegmentFont::digit(value % 10));
+        value /= 10;
+    } while (value > 0 && pos >= position);
+
+    if (negative && pos >= position) set(pos--, SegmentFont::MINUS);
+    while (pos >= position) {
+        set(pos--, leadingZero && !negative ? SegmentFont::digit(0) : 0);
+    }
+}
+
+void SegmentDisplay::setBrightness(uint8_t brightness) {
+    driver.setBrightness(brightness);
+    dirty = (1 << DIGITS) - 1;
+}
+
+void SegmentDisplay::flush() {
+    if (dirty == 0) return;
+    flushes++;
+
+    for (uint8_t i = 0; i < DIGITS; ) {
+        if (!(dirty & (1 << i))) {
+            i++;
+            continue;
+        }
+        uint8_t end = i;
+        while (end < DIGITS && (dirty & (1 << end))) end++;
+
+        driver.setSegments(pending + i, end - i, i);
+        digitWrites += end - i;
+        i = end;
+    }
+    dirty = 0;
+}
@@ -0,0 +1,51 @@
+#ifndef SEGMENT_DISPLAY_H
+#define SEGMENT_DISPLAY_H
+
+#include <TM1637Display.h>
+#include "SegmentFont.h"
+
+// Кадровый буфер 4-разрядного TM1637 с отслеживанием изменений.
+// Отрисовка пишет только в буфер; flush() отправляет по шине лишь
+// изменившиеся знакоместа (соседние - одной посылкой).
+class SegmentDisplay {
+public:
+    static constexpr uint8_t DIGITS = 4;
+
+    SegmentDisplay(uint8_t clkPin, uint8_t dioPin) : driver(clkPin, dioPin) {}
+
+    void set(uint8_t position, uint8_t segments) {
+        if (position >= DIGITS || pending[position] == segments) return;
+        pending[position] = segments;
+        dirty |= 1 << position;
+    }
+
+    void setAll(const uint8_t* segments) {
+        for (uint8_t i = 0; i < DIGITS; i++) set(i, segments[i]);
+    }
+
+    void clear() {
+        for (uint8_t i = 0; i < DIGITS; i++) set(i, 0);
+    }
+
+    // Текст с выравниванием влево, остаток строки гасится
+    void print(StringView text);
+    // Число с выравниванием вправо в поле [position, position + width)
+    void printNumber(int number, bool leadingZero = false, uint8_t width = DIGITS, uint8_t position = 0);
+
+    // Яркость передается вместе с данными - весь кадр переотправляется
+    void setBrightness(uint8_t brightness);
+    void flush();
+
+    const uint8_t* frame() const { return pending; }
+    uint32_t getFlushCount() const { return flushes; }
+    uint32_t getDigitWrites() const { return digitWrites; }
+
+private:
+    TM1637Display driver;
+    uint8_t pending[DIGITS] = {};
+    uint8_t dirty = (1 << DIGITS) - 1;   // первый flush синхронизирует индикатор
+    uint32_t flushes = 0;
+    uint32_t digitWrites = 0;
+};
+
+#endif
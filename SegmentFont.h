@@ -0,0 +1,52 @@
+#ifndef SEGMENT_FONT_H
+#define SEGMENT_FONT_H
+
+#include <stdint.h>
+#include "FixedString.h"
+
+// Знакогенератор 7-сегментного индикатора.
+// Бит 0 - сегмент A (верх), далее по часовой B..F, бит 6 - G (середина),
+// бит 7 - точка/двоеточие. Буквы - ближайшие начертания (M, W, V условные).
+namespace SegmentFont {
+  constexpr uint8_t SEGMENT_DP = 0x80;
+  constexpr uint8_t DEGREE = 0x63;
+  constexpr uint8_t MINUS = 0x40;
+
+  // ASCII 0x20-0x7F; неотображаемые символы - пустое знакоместо
+  constexpr uint8_t ASCII[96] = {
+    0x00, 0x82, 0x22, 0x00, 0x00, 0x24, 0x00, 0x02, 0x39, 0x0F, 0x63, 0x46, 0x04, 0x40, 0x80, 0x52,  // 0x20-0x2F
+    0x3F, 0x06, 0x5B, 0x4F, 0x66, 0x6D, 0x7D, 0x07, 0x7F, 0x6F, 0x00, 0x00, 0x58, 0x48, 0x4C, 0x53,  // 0-9 : ; < = > ?
+    0x00, 0x77, 0x7C, 0x39, 0x5E, 0x79, 0x71, 0x3D, 0x76, 0x06, 0x1E, 0x75, 0x38, 0x37, 0x37, 0x3F,  // @ A-O
+    0x73, 0x67, 0x50, 0x6D, 0x78, 0x3E, 0x3E, 0x3E, 0x76, 0x6E, 0x5B, 0x39, 0x64, 0x0F, 0x23, 0x08,  // P-Z [ \ ] ^ _
+    0x00, 0x5F, 0x7C, 0x58, 0x5E, 0x7B, 0x71, 0x6F, 0x74, 0x04, 0x0E, 0x75, 0x30, 0x54, 0x54, 0x5C,  // ` a-o
+    0x73, 0x67, 0x50, 0x6D, 0x78, 0x1C, 0x1C, 0x1C, 0x76, 0x6E, 0x5B, 0x00, 0x30, 0x00, 0x00, 0x00   // p-z { | } ~
+  };
+
+  constexpr uint8_t glyph(char c) {
+    return (c >= 0x20 && (uint8_t)c < 0x80) ? ASCII[c - 0x20] : 0;
+  }
+
+  constexpr uint8_t digit(uint8_t value) {
+    return ASCII['0' - 0x20 + value % 10];
+  }
+
+  static_assert(glyph('E') == 0x79 && glyph('r') == 0x50, "Glyph table out of order");
+
+  // Текст -> сегменты. Точка присоединяется к предыдущему знаку, а не занимает
+  // отдельное знакоместо. Возвращает число записанных знакомест.
+  inline size_t encode(StringView text, uint8_t* out, size_t capacity) {
+    size_t count = 0;
+    for (size_t i = 0; i < text.length(); i++) {
+      char c = text[i];
+      if (c == '.' && count > 0 && !(out[count - 1] & SEGMENT_DP)) {
+        out[count - 1] |= SEGMENT_DP;
+        continue;
+      }
+      if (count == capacity) break;
+      out[count++] = glyph(c);
+    }
+    return count;
+  }
+}
+
+#endif
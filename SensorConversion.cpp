@@ -0,0 +1,30 @@
+#include "SensorConversion.h"
+
+bool SensorConversion::airReading(float temperature, float humidity, float pressure, SensorData& data) {
+    if (isnan(temperature) || isnan(humidity) || isnan(pressure)) return false;
+
+    data.airTemperature = Temperature::fromFloat(temperature);
+    data.airHumidity = Percent::fromFloat(humidity);
+    data.pressure = Pressure::fromFloat(pressure);
+    return true;
+}
+
+bool SensorConversion::soilReadingInRange(int raw) {
+    return raw > 100 && raw < (Constants::SOIL_ADC_MAX - 100);
+}
+
+bool SensorConversion::soilMoisture(int raw, uint16_t airValue, uint16_t waterValue, Percent& moisture) {
+    int32_t span = (int32_t)waterValue - airValue;
+    if (!soilReadingInRange(raw) || span == 0) return false;
+    // Линейная шкала "воздух = 0%, вода = 100%" в сотых долях процента
+    int32_t value = (raw - (int32_t)airValue) * 10000 / span;
+    moisture = Percent::fromRaw(constrain(value, 0, 10000));
+    return true;
+}
+
+bool SensorConversion::soilTemperature(int raw, Temperature& temperature) {
+    if (!soilReadingInRange(raw)) return false;
+    temperature = Temperature::fromRaw(
+        raw * Constants::SOIL_TEMP_FULL_SCALE / Constants::SOIL_ADC_MAX - Constants::SOIL_TEMP_OFFSET);
+    return true;
+}
@@ -0,0 +1,19 @@
+#ifndef SENSOR_CONVERSION_H
+#define SENSOR_CONVERSION_H
+
+#include "Config.h"
+
+// Пересчет отсчетов датчиков в SensorData без обращения к оборудованию -
+// общий для опроса на устройстве и модели теплицы на ПК (test/).
+namespace SensorConversion {
+  // Показания BME280. false - хотя бы одно значение не получено.
+  bool airReading(float temperature, float humidity, float pressure, SensorData& data);
+
+  // Отсчеты АЦП датчиков почвы. false - отсчет вне рабочего диапазона
+  // (обрыв или замыкание).
+  bool soilReadingInRange(int raw);
+  bool soilMoisture(int raw, uint16_t airValue, uint16_t waterValue, Percent& moisture);
+  bool soilTemperature(int raw, Temperature& temperature);
+}
+
+#endif
@@ -0,0 +1,204 @@
+#include "SensorDrivers.h"
+#include <BH1750.h>
+#include <Adafruit_BME280.h>
+#include "GlobalInstances.h"
+#include "SensorConversion.h"
+
+// Экземпляры библиотечных драйверов
+BH1750 lightMeter;
+Adafruit_BME280 bme;
+
+// ===== Вспомогательные функции шины =====
+static bool readRegisters(uint8_t address, uint8_t reg, uint8_t* buffer, uint8_t length) {
+    return i2cBus.writeRead(address, &reg, 1, buffer, length);
+}
+
+static bool writeCommand16(uint8_t address, uint16_t command) {
+    uint8_t bytes[2] = {(uint8_t)(command >> 8), (uint8_t)(command & 0xFF)};
+    return i2cBus.write(address, bytes, 2);
+}
+
+static bool readBytes(uint8_t address, uint8_t* buffer, uint8_t length) {
+    return i2cBus.read(address, buffer, length);
+}
+
+// CRC-8 Sensirion (полином 0x31, начальное значение 0xFF)
+static uint8_t sensirionCrc(const uint8_t* data, uint8_t length) {
+    uint8_t crc = 0xFF;
+    for (uint8_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0x31 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ===== BME280 =====
+static bool probeBME280(uint8_t address) {
+    uint8_t chipId = 0;
+    return readRegisters(address, 0xD0, &chipId, 1) && chipId == 0x60;
+}
+
+// В режиме пониженного потребления датчики спят между разовыми измерениями
+static bool forcedBME280 = false;
+static bool oneShotBH1750 = false;
+
+static bool initBME280(uint8_t address) {
+    if (!bme.begin(address)) return false;
+    forcedBME280 = systemSettings.lowPowerMode;
+    bme.setSampling(forcedBME280 ? Adafruit_BME280::MODE_FORCED : Adafruit_BME280::MODE_NORMAL,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::SAMPLING_X1,
+                    Adafruit_BME280::FILTER_OFF);
+    return true;
+}
+
+static bool readBME280(uint8_t address, SensorData& data) {
+    // Разовое измерение при X1 занимает около 10 мс
+    if (forcedBME280 && !bme.takeForcedMeasurement()) return false;
+    float temp = bme.readTemperature();
+    float hum = bme.readHumidity();
+    float pres = bme.readPressure() / 100.0F;
+    return SensorConversion::airReading(temp, hum, pres, data);
+}
+
+// ===== BH1750 =====
+static bool probeBH1750(uint8_t address) {
+    // У BH1750 нет ID-регистра: проверяем, что команда Power On принимается
+    uint8_t powerOn = 0x01;
+    return i2cBus.write(address, &powerOn, 1);
+}
+
+static bool initBH1750(uint8_t address) {
+    oneShotBH1750 = systemSettings.lowPowerMode;
+    return lightMeter.begin(oneShotBH1750 ? BH1750::ONE_TIME_HIGH_RES_MODE : BH1750::CONTINUOUS_HIGH_RES_MODE,
+                            address);
+}
+
+static bool readBH1750(uint8_t address, SensorData& data) {
+    float lux = lightMeter.readLightLevel();
+    // Следующее разовое измерение (120-180 мс) запускается сразу и готово
+    // к очередному опросу; после него датчик сам засыпает
+    if (oneShotBH1750) lightMeter.configure(BH1750::ONE_TIME_HIGH_RES_MODE);
+    if (isnan(lux) || lux < 0 || lux > 65535) return false;
+
+    data.lightLevel = Illuminance::fromFloat(lux);
+    return true;
+}
+
+// ===== SHT30 =====
+static bool probeSHT30(uint8_t address) {
+    // Чтение регистра статуса, ответ защищен CRC
+    uint8_t status[3];
+    if (!writeCommand16(address, 0xF32D)) return false;
+    if (!readBytes(address, status, 3)) return false;
+    return sensirionCrc(status, 2) == status[2];
+}
+
+static bool initSHT30(uint8_t address) {
+    bool ok = writeCommand16(address, 0x30A2); // Soft reset
+    delay(2);
+    return ok;
+}
+
+static bool readSHT30(uint8_t address, SensorData& data) {
+    // Одиночное измерение, высокая повторяемость, без clock stretching
+    if (!writeCommand16(address, 0x2400)) return false;
+    delay(16);
+
+    uint8_t raw[6];
+    if (!readBytes(address, raw, 6)) return false;
+    if (sensirionCrc(raw, 2) != raw[2] || sensirionCrc(raw + 3, 2) != raw[5]) return false;
+
+    // BME280 остается основным датчиком воздуха, SHT30 - резервный
+    if (!deviceConfig.hasBME280) {
+        uint16_t rawTemp = (raw[0] << 8) | raw[1];
+        uint16_t rawHum = (raw[3] << 8) | raw[4];
+        // Формулы из даташита сразу в сотых долях
+        data.airTemperature = Temperature::fromRaw(-4500 + (int32_t)(17500L * rawTemp / 65535));
+        data.airHumidity = Percent::fromRaw((int32_t)(10000L * rawHum / 65535));
+    }
+    return true;
+}
+
+// ===== ADS1115 =====
+static bool probeADS1115(uint8_t address) {
+    // Регистр конфигурации: биты COMP_QUE после сброса равны 0b11
+    uint8_t config[2];
+    return readRegisters(address, 0x01, config, 2) && (config[1] & 0x03) == 0x03;
+}
+
+// ===== DS3231 =====
+static bool probeDS3231(uint8_t address) {
+    // Секунды в BCD и нулевые биты 4-6 регистра статуса
+    uint8_t seconds = 0;
+    uint8_t status = 0;
+    if (!readRegisters(address, 0x00, &seconds, 1)) return false;
+    if (!readRegisters(address, 0x0F, &status, 1)) return false;
+    return (seconds & 0x0F) < 10 && (seconds >> 4) < 6 && (status & 0x70) == 0;
+}
+
+// ===== Реестр драйверов =====
+// Чтобы подключить новый датчик, достаточно добавить запись в таблицу.
+// Порядок записей задает приоритет при совпадении адресов.
+static const uint8_t BME280_ADDRESSES[] = {0x76, 0x77};
+static const uint8_t BH1750_ADDRESSES[] = {0x23, 0x5C};
+static const uint8_t SHT30_ADDRESSES[] = {0x44, 0x45};
+static const uint8_t ADS1115_ADDRESSES[] = {0x48, 0x49, 0x4A, 0x4B};
+static const uint8_t DS3231_ADDRESSES[] = {0x68};
+static const uint8_t LCD1602_ADDRESSES[] = {0x27};
+static const uint8_t OLED_ADDRESSES[] = {0x3C, 0x3D};
+static const uint8_t EEPROM_ADDRESSES[] = {0x50};
+static const uint8_t PCA9685_ADDRESSES[] = {0x70};
+
+#define DRIVER_ADDRESSES(list) list, sizeof(list)
+
+static const SensorDriver DRIVERS[] = {
+    {"BME280", "Environmental", DRIVER_ADDRESSES(BME280_ADDRESSES),
+     DriverCaps::TEMPERATURE | DriverCaps::HUMIDITY | DriverCaps::PRESSURE,
+     probeBME280, initBME280, readBME280,
+     &deviceConfig.hasBME280, &deviceConfig.bme280Healthy, &deviceConfig.bme280Address},
+    {"BH1750", "Light Sensor", DRIVER_ADDRESSES(BH1750_ADDRESSES),
+     DriverCaps::LIGHT,
+     probeBH1750, initBH1750, readBH1750,
+     &deviceConfig.hasBH1750, &deviceConfig.bh1750Healthy, &deviceConfig.bh1750Address},
+    {"SHT30", "Temperature/Humidity", DRIVER_ADDRESSES(SHT30_ADDRESSES),
+     DriverCaps::TEMPERATURE | DriverCaps::HUMIDITY,
+     probeSHT30, initSHT30, readSHT30,
+     nullptr, nullptr, nullptr},
+
+    // Устройства без драйвера - только опознаются при полном сканировании.
+    // ADS1115 и DS3231 проверяются по регистрам, но не подключаются:
+    // их данные пока некуда записать в SensorData.
+    {"ADS1115", "ADC Converter", DRIVER_ADDRESSES(ADS1115_ADDRESSES),
+     DriverCaps::ADC, probeADS1115, nullptr, nullptr, nullptr, nullptr, nullptr},
+    {"DS3231", "RTC Clock", DRIVER_ADDRESSES(DS3231_ADDRESSES),
+     DriverCaps::CLOCK, probeDS3231, nullptr, nullptr, nullptr, nullptr, nullptr},
+    {"LCD1602", "LCD Display", DRIVER_ADDRESSES(LCD1602_ADDRESSES),
+     DriverCaps::NONE, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
+    {"OLED", "OLED Display", DRIVER_ADDRESSES(OLED_ADDRESSES),
+     DriverCaps::NONE, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
+    {"EEPROM", "EEPROM Memory", DRIVER_ADDRESSES(EEPROM_ADDRESSES),
+     DriverCaps::NONE, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
+    {"PCA9685", "PWM Controller", DRIVER_ADDRESSES(PCA9685_ADDRESSES),
+     DriverCaps::NONE, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+#undef DRIVER_ADDRESSES
+
+size_t SensorDrivers::count() {
+    return sizeof(DRIVERS) / sizeof(DRIVERS[0]);
+}
+
+const SensorDriver& SensorDrivers::get(size_t index) {
+    return DRIVERS[index];
+}
+
+bool SensorDrivers::hasCandidate(const SensorDriver& driver, uint8_t address) {
+    for (uint8_t i = 0; i < driver.addressCount; i++) {
+        if (driver.addresses[i] == address) return true;
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef SENSOR_DRIVERS_H
+#define SENSOR_DRIVERS_H
+
+#include "Config.h"
+
+// ===== Возможности драйверов =====
+namespace DriverCaps {
+  constexpr uint8_t NONE = 0;
+  constexpr uint8_t TEMPERATURE = 1 << 0;
+  constexpr uint8_t HUMIDITY = 1 << 1;
+  constexpr uint8_t PRESSURE = 1 << 2;
+  constexpr uint8_t LIGHT = 1 << 3;
+  constexpr uint8_t ADC = 1 << 4;
+  constexpr uint8_t CLOCK = 1 << 5;
+}
+
+// Описание драйвера I2C устройства.
+// probe - проверка ID-регистра (nullptr: достаточно ACK на адресе),
+// init  - инициализация (nullptr: устройство только опознается),
+// read  - чтение в SensorData (nullptr: данных в SensorData не дает).
+// present/healthy/address - необязательные поля DeviceConfig,
+// которые драйвер поддерживает для совместимости с API.
+struct SensorDriver {
+  const char* name;
+  const char* description;
+  const uint8_t* addresses;
+  uint8_t addressCount;
+  uint8_t capabilities;
+  bool (*probe)(uint8_t address);
+  bool (*init)(uint8_t address);
+  bool (*read)(uint8_t address, SensorData& data);
+  bool* present;
+  bool* healthy;
+  uint8_t* address;
+};
+
+namespace SensorDrivers {
+  size_t count();
+  const SensorDriver& get(size_t index);
+
+  // Проверка, что адрес входит в список кандидатов драйвера
+  bool hasCandidate(const SensorDriver& driver, uint8_t address);
+}
+
+#endif
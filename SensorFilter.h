@@ -0,0 +1,195 @@
+#ifndef SENSOR_FILTER_H
+#define SENSOR_FILTER_H
+
+#include <Arduino.h>
+#include "FixedPoint.h"
+
+// Фильтры каналов датчиков: фиксированный размер состояния, без виртуальных
+// вызовов, только целочисленная арифметика над значениями Fixed.
+// Параметры канала задаются структурой свойств (Traits):
+//   Value - тип величины, WINDOW, MIN_VALUE, MAX_VALUE, MAX_RATE (за минуту),
+//   HAMPEL_K, MIN_DEVIATION и Filter - тип фильтра (MedianFilter или HampelFilter).
+
+// Скользящее окно последних N отсчетов с медианой и MAD (в единицах Raw)
+template <typename Raw, uint8_t N>
+class SampleWindow {
+public:
+    void push(Raw value) {
+        values[head] = value;
+        head = (head + 1) % N;
+        if (count < N) count++;
+    }
+
+    void reset() {
+        head = 0;
+        count = 0;
+    }
+
+    uint8_t size() const { return count; }
+
+    int32_t median() const {
+        int32_t sorted[N];
+        for (uint8_t i = 0; i < count; i++) {
+            sorted[i] = values[i];
+        }
+        return sortedMedian(sorted, count);
+    }
+
+    // Медиана абсолютных отклонений от center
+    int32_t mad(int32_t center) const {
+        int32_t deviations[N];
+        for (uint8_t i = 0; i < count; i++) {
+            deviations[i] = abs((int32_t)values[i] - center);
+        }
+        return sortedMedian(deviations, count);
+    }
+
+private:
+    // Вставками: для окон в 3-7 отсчетов быстрее любой общей сортировки
+    static int32_t sortedMedian(int32_t* data, uint8_t length) {
+        for (uint8_t i = 1; i < length; i++) {
+            int32_t key = data[i];
+            int8_t j = i - 1;
+            while (j >= 0 && data[j] > key) {
+                data[j + 1] = data[j];
+                j--;
+            }
+            data[j + 1] = key;
+        }
+        if (length == 0) return 0;
+        uint8_t mid = length / 2;
+        return (length % 2) ? data[mid] : (data[mid - 1] + data[mid]) / 2;
+    }
+
+    Raw values[N];
+    uint8_t head = 0;
+    uint8_t count = 0;
+};
+
+// Медианный фильтр: сглаживает одиночные выбросы, ничего не отбрасывает
+template <typename Value, uint8_t N>
+class MedianFilter {
+public:
+    template <typename Traits>
+    Value apply(Value value, bool& outlier) {
+        window.push(value.raw());
+        outlier = false;
+        return Value::fromRaw(window.median());
+    }
+
+    void reset() { window.reset(); }
+
+private:
+    SampleWindow<typename Value::Raw, N> window;
+};
+
+// Фильтр Хампеля: отсчет дальше K * 1.4826 * MAD от медианы окна
+// считается выбросом и заменяется медианой
+template <typename Value, uint8_t N>
+class HampelFilter {
+public:
+    template <typename Traits>
+    Value apply(Value value, bool& outlier) {
+        outlier = false;
+        if (window.size() >= 3) {
+            int32_t center = window.median();
+            int32_t sigma = window.mad(center) * 14826 / 10000;
+            if (sigma < Traits::MIN_DEVIATION.raw()) sigma = Traits::MIN_DEVIATION.raw();
+            outlier = abs((int32_t)value.raw() - center) > Traits::HAMPEL_K * sigma;
+        }
+        window.push(value.raw());
+        return outlier ? Value::fromRaw(window.median()) : value;
+    }
+
+    void reset() { window.reset(); }
+
+private:
+    SampleWindow<typename Value::Raw, N> window;
+};
+
+// Канал датчика: проверка диапазона и скорости изменения, затем фильтр.
+// Доля отброшенных отсчетов дает оценку достоверности 0-100.
+template <typename Traits>
+class FilteredChannel {
+public:
+    using Value = typename Traits::Value;
+
+    // Возвращает отфильтрованное значение (недействительное, пока нет принятых отсчетов)
+    Value update(Value raw, unsigned long now) {
+        lastRaw = raw;
+        if (!raw.isValid()) return value;
+
+        bool inRange = raw >= Traits::MIN_VALUE && raw <= Traits::MAX_VALUE;
+        bool plausible = inRange;
+        if (plausible && hasReference) {
+            // |изменение| / (мс / 60000) <= MAX_RATE, без деления
+            int64_t change = raw.distance(reference).raw();
+            plausible = change * 60000 <= (int64_t)Traits::MAX_RATE.raw() * (int64_t)(now - referenceTime);
+        }
+
+        if (!plausible) {
+            consecutiveRejects++;
+            // Устойчивый скачок - реальное изменение среды: принимаем новый уровень
+            if (!inRange || consecutiveRejects < REANCHOR_COUNT) {
+                recordSample(true);
+                return value;
+            }
+            filter.reset();
+        }
+
+        bool outlier;
+        Value filtered = filter.template apply<Traits>(raw, outlier);
+        recordSample(outlier);
+        if (!outlier) {
+            reference = raw;
+            referenceTime = now;
+            hasReference = true;
+            consecutiveRejects = 0;
+        }
+        value = filtered;
+        return value;
+    }
+
+    void setAvailable(bool state) { available = state; }
+
+    uint8_t confidence() const {
+        if (!available || samples == 0) return 0;
+
+        uint8_t recent = (samples < HISTORY_SIZE) ? samples : HISTORY_SIZE;
+        uint16_t mask = (recent >= 16) ? 0xFFFF : (uint16_t)((1u << recent) - 1);
+        uint8_t rejectedRecent = __builtin_popcount(rejectHistory & mask);
+        uint16_t score = 100 - rejectedRecent * 100 / recent;
+
+        // Пока окно фильтра не заполнено, доверие ниже
+        uint8_t warm = (samples < Traits::WINDOW) ? samples : Traits::WINDOW;
+        return score * warm / Traits::WINDOW;
+    }
+
+    Value getValue() const { return value; }
+    Value getRaw() const { return lastRaw; }
+    uint32_t getRejectedCount() const { return rejectedTotal; }
+
+private:
+    void recordSample(bool rejected) {
+        rejectHistory = (rejectHistory << 1) | (rejected ? 1 : 0);
+        if (samples < 255) samples++;
+        if (rejected) rejectedTotal++;
+    }
+
+    static constexpr uint8_t HISTORY_SIZE = 16;
+    static constexpr uint8_t REANCHOR_COUNT = 3;
+
+    typename Traits::Filter filter;
+    Value value;
+    Value lastRaw;
+    Value reference;
+    unsigned long referenceTime = 0;
+    bool hasReference = false;
+    bool available = true;
+    uint8_t consecutiveRejects = 0;
+    uint8_t samples = 0;
+    uint16_t rejectHistory = 0;    // 1 - отсчет отброшен, младший бит - последний
+    uint32_t rejectedTotal = 0;
+};
+
+#endif
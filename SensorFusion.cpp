@@ -0,0 +1,87 @@
+#include "SensorFusion.h"
+#include "Logger.h"
+
+void SensorFusion::process(SensorData& data, unsigned long now, bool airAvailable, bool soilAvailable, bool lightAvailable) {
+    airTemperature.setAvailable(airAvailable);
+    airHumidity.setAvailable(airAvailable);
+    pressure.setAvailable(airAvailable);
+    soilTemperature.setAvailable(soilAvailable);
+    soilMoisture.setAvailable(soilAvailable);
+    lightLevel.setAvailable(lightAvailable);
+
+    if (airAvailable) {
+        data.airTemperature = airTemperature.update(data.airTemperature, now);
+        data.airHumidity = airHumidity.update(data.airHumidity, now);
+        data.pressure = pressure.update(data.pressure, now);
+    }
+    if (soilAvailable) {
+        data.soilTemperature = soilTemperature.update(data.soilTemperature, now);
+        data.soilMoisture = soilMoisture.update(data.soilMoisture, now);
+    }
+    if (lightAvailable) {
+        data.lightLevel = lightLevel.update(data.lightLevel, now);
+    }
+
+    // Воздух и почва в теплице не расходятся сильнее порога: иначе неисправен
+    // один из датчиков, и какой именно - неизвестно
+    bool failed = data.airTemperature.isValid() && data.soilTemperature.isValid() &&
+                  data.airTemperature.distance(data.soilTemperature) > Constants::FUSION_MAX_AIR_SOIL_DELTA;
+    if (failed != crossCheckFailed && logging) {
+        if (failed) {
+            LOG_WARN("⚠️ Air/soil temperature mismatch: %.1f°C vs %.1f°C",
+                     data.airTemperature.toFloat(), data.soilTemperature.toFloat());
+        } else {
+            LOG_INFO("✅ Air/soil temperature cross-check passed");
+        }
+    }
+    crossCheckFailed = failed;
+}
+
+// Расхождение не говорит, какой из датчиков неисправен: оба канала
+// опускаются ниже порога автоматики, как бы хорошо ни шли их отсчеты
+static_assert(Constants::FUSION_CROSS_CHECK_CONFIDENCE < Constants::FUSION_MIN_CONFIDENCE,
+              "Cross-check failure must disable automation on both channels");
+
+uint8_t SensorFusion::crossChecked(uint8_t confidence) const {
+    if (!crossCheckFailed) return confidence;
+    return confidence < Constants::FUSION_CROSS_CHECK_CONFIDENCE ? confidence : Constants::FUSION_CROSS_CHECK_CONFIDENCE;
+}
+
+uint8_t SensorFusion::getConfidence(SensorChannel channel) const {
+    switch (channel) {
+        case SensorChannel::AIR_TEMPERATURE: return crossChecked(airTemperature.confidence());
+        case SensorChannel::AIR_HUMIDITY: return airHumidity.confidence();
+        case SensorChannel::PRESSURE: return pressure.confidence();
+        case SensorChannel::SOIL_TEMPERATURE: return crossChecked(soilTemperature.confidence());
+        case SensorChannel::SOIL_MOISTURE: return soilMoisture.confidence();
+        case SensorChannel::LIGHT_LEVEL: return lightLevel.confidence();
+        case SensorChannel::COUNT: break;
+    }
+    return 0;
+}
+
+uint32_t SensorFusion::getRejectedCount(SensorChannel channel) const {
+    switch (channel) {
+        case SensorChannel::AIR_TEMPERATURE: return airTemperature.getRejectedCount();
+        case SensorChannel::AIR_HUMIDITY: return airHumidity.getRejectedCount();
+        case SensorChannel::PRESSURE: return pressure.getRejectedCount();
+        case SensorChannel::SOIL_TEMPERATURE: return soilTemperature.getRejectedCount();
+        case SensorChannel::SOIL_MOISTURE: return soilMoisture.getRejectedCount();
+        case SensorChannel::LIGHT_LEVEL: return lightLevel.getRejectedCount();
+        case SensorChannel::COUNT: break;
+    }
+    return 0;
+}
+
+const char* SensorFusion::channelName(SensorChannel channel) {
+    switch (channel) {
+        case SensorChannel::AIR_TEMPERATURE: return "airTemperature";
+        case SensorChannel::AIR_HUMIDITY: return "airHumidity";
+        case SensorChannel::PRESSURE: return "pressure";
+        case SensorChannel::SOIL_TEMPERATURE: return "soilTemperature";
+        case SensorChannel::SOIL_MOISTURE: return "soilMoisture";
+        case SensorChannel::LIGHT_LEVEL: return "lightLevel";
+        case SensorChannel::COUNT: break;
+    }
+    return "unknown";
+}
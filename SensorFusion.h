@@ -0,0 +1,110 @@
+#ifndef SENSOR_FUSION_H
+#define SENSOR_FUSION_H
+
+#include "Config.h"
+#include "SensorFilter.h"
+
+enum class SensorChannel : uint8_t {
+    AIR_TEMPERATURE,
+    AIR_HUMIDITY,
+    PRESSURE,
+    SOIL_TEMPERATURE,
+    SOIL_MOISTURE,
+    LIGHT_LEVEL,
+    COUNT
+};
+
+// Свойства каналов: допустимый диапазон, скорость изменения и фильтр
+struct AirTemperatureTraits {
+    using Value = Temperature;
+    static constexpr uint8_t WINDOW = 5;
+    static constexpr Value MIN_VALUE = Value::fromFloat(-40), MAX_VALUE = Value::fromFloat(85);
+    static constexpr Value MAX_RATE = Value::fromFloat(3.0);       // °C/мин
+    static constexpr int32_t HAMPEL_K = 3;
+    static constexpr Value MIN_DEVIATION = Value::fromFloat(0.3);
+    using Filter = HampelFilter<Value, WINDOW>;
+};
+
+struct AirHumidityTraits {
+    using Value = Percent;
+    static constexpr uint8_t WINDOW = 5;
+    static constexpr Value MIN_VALUE = Value::fromFloat(0), MAX_VALUE = Value::fromFloat(100);
+    static constexpr Value MAX_RATE = Value::fromFloat(10.0);      // %/мин
+    static constexpr int32_t HAMPEL_K = 3;
+    static constexpr Value MIN_DEVIATION = Value::fromFloat(1.0);
+    using Filter = HampelFilter<Value, WINDOW>;
+};
+
+struct PressureTraits {
+    using Value = Pressure;
+    static constexpr uint8_t WINDOW = 5;
+    static constexpr Value MIN_VALUE = Value::fromFloat(300), MAX_VALUE = Value::fromFloat(1100);
+    static constexpr Value MAX_RATE = Value::fromFloat(1.0);       // гПа/мин
+    static constexpr int32_t HAMPEL_K = 3;
+    static constexpr Value MIN_DEVIATION = Value::fromFloat(0.2);
+    using Filter = HampelFilter<Value, WINDOW>;
+};
+
+struct SoilTemperatureTraits {
+    using Value = Temperature;
+    static constexpr uint8_t WINDOW = 5;
+    static constexpr Value MIN_VALUE = Value::fromFloat(-20), MAX_VALUE = Value::fromFloat(60);
+    static constexpr Value MAX_RATE = Value::fromFloat(1.0);       // почва инертна
+    static constexpr int32_t HAMPEL_K = 3;
+    static constexpr Value MIN_DEVIATION = Value::fromFloat(0.3);
+    using Filter = HampelFilter<Value, WINDOW>;
+};
+
+struct SoilMoistureTraits {
+    using Value = Percent;
+    static constexpr uint8_t WINDOW = 5;
+    static constexpr Value MIN_VALUE = Value::fromFloat(0), MAX_VALUE = Value::fromFloat(100);
+    static constexpr Value MAX_RATE = Value::fromFloat(20.0);      // полив поднимает быстро
+    static constexpr int32_t HAMPEL_K = 3;
+    static constexpr Value MIN_DEVIATION = Value::fromFloat(1.0);
+    using Filter = HampelFilter<Value, WINDOW>;
+};
+
+struct LightLevelTraits {
+    using Value = Illuminance;
+    static constexpr uint8_t WINDOW = 3;
+    static constexpr Value MIN_VALUE = Value::fromRaw(Value::MIN_RAW), MAX_VALUE = Value::fromRaw(Value::MAX_RAW);
+    static constexpr Value MAX_RATE = Value::fromRaw(Value::MAX_RAW);  // освещенность меняется скачками
+    static constexpr int32_t HAMPEL_K = 0;
+    static constexpr Value MIN_DEVIATION = Value::fromRaw(0);
+    using Filter = MedianFilter<Value, WINDOW>;
+};
+
+// Этап обработки между опросом датчиков и автоматикой.
+// Сырые значения в SensorData заменяются отфильтрованными, для каждого
+// канала считается достоверность 0-100; при расхождении температур воздуха
+// и почвы достоверность обоих каналов опускается ниже порога автоматики.
+class SensorFusion {
+public:
+    // Доступность источников передается явно: на устройстве - по состоянию
+    // датчиков, при воспроизведении - из записи трассы, в симуляторе - всегда
+    void process(SensorData& data, unsigned long now, bool airAvailable, bool soilAvailable, bool lightAvailable);
+
+    uint8_t getConfidence(SensorChannel channel) const;
+    uint32_t getRejectedCount(SensorChannel channel) const;
+    bool isCrossCheckFailed() const { return crossCheckFailed; }
+    // Воспроизведение трассы не засоряет журнал
+    void setLogging(bool enabled) { logging = enabled; }
+
+    static const char* channelName(SensorChannel channel);
+
+private:
+    uint8_t crossChecked(uint8_t confidence) const;
+
+    FilteredChannel<AirTemperatureTraits> airTemperature;
+    FilteredChannel<AirHumidityTraits> airHumidity;
+    FilteredChannel<PressureTraits> pressure;
+    FilteredChannel<SoilTemperatureTraits> soilTemperature;
+    FilteredChannel<SoilMoistureTraits> soilMoisture;
+    FilteredChannel<LightLevelTraits> lightLevel;
+
+    bool crossCheckFailed = false;
+    bool logging = true;
+};
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <stdint.h>
+
+// Снимок для одного писателя и читателей на другом ядре. Писатель не ждет
+// читателя; читатель повторяет копирование, если во время него снимок
+// менялся (нечетный номер - идет запись). Значение копируется побайтно,
+// поэтому T - простая структура без указателей на собственные данные.
+template <typename T>
+class Seqlock {
+public:
+    // Писатель: запись на месте, без промежуточной копии
+    T& beginWrite() {
+        uint32_t sequence = sequenceNumber.load(std::memory_order_relaxed);
+        sequenceNumber.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        return value;
+    }
+
+    void endWrite() {
+        sequenceNumber.store(sequenceNumber.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    void publish(const T& data) {
+        beginWrite() = data;
+        endWrite();
+    }
+
+    // Читатель. seen - номер последней прочитанной версии: неизменный снимок
+    // не копируется повторно (false). Копирование повторяется до целого
+    // снимка: запись короткая и идет на другом ядре, а в однопоточном режиме
+    // писатель и читатель не пересекаются вовсе.
+    bool read(T& out, uint32_t& seen) const {
+        for (;;) {
+            uint32_t before = sequenceNumber.load(std::memory_order_acquire);
+            if (before == seen) return false;
+            if (before & 1) continue;
+            out = value;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequenceNumber.load(std::memory_order_relaxed) == before) {
+                seen = before;
+                return true;
+            }
+        }
+    }
+
+private:
+    T value;
+    std::atomic<uint32_t> sequenceNumber{0};
+};
+
+#endif
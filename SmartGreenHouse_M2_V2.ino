@@ -17,107 +17,209 @@
 
 // ТОЛЬКО GlobalInstances.h - он включит все остальное
 #include "GlobalInstances.h"
+#include "ControlTask.h"
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "PowerManager.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
 
 WebServer server(80);
 
 // Глобальные структуры данных
 SystemSettings systemSettings;
 SensorData sensorData;
+SensorData sensorView;
+ControlStatus statusView;
 DeviceConfig deviceConfig;
 
 // Таймеры
 unsigned long previousSensorRead = 0;
-unsigned long previousDisplayUpdate = 0;
 unsigned long previousHealthCheck = 0;
 
 const unsigned long SENSOR_READ_INTERVAL = 30000;
-const unsigned long DISPLAY_UPDATE_INTERVAL = 2000;
 const unsigned long HEALTH_CHECK_INTERVAL = 60000;
 
 void setup() {
   Serial.begin(115200);
+  logger.begin();
   delay(1000);
   
-  Serial.println("\n\nSMART GREENHOUSE M2 - INITIALIZATION");
+  LOG_INFO("SMART GREENHOUSE M2 - INITIALIZATION");
   
   // Инициализация EEPROM и загрузка настроек
   eepromManager.begin();
   if (!eepromManager.loadSettings(systemSettings)) {
-    Serial.println("Using default settings");
+    LOG_WARN("Using default settings");
     strcpy(systemSettings.wifiSSID, "PATT");
     strcpy(systemSettings.wifiPassword, "89396A1F61");
   }
   
+  // Пороги тревог из настроек
+  alarmEngine.configure(systemSettings);
+  
   // Инициализация дисплея
   displayManager.begin();
   
   // Инициализация устройств
   deviceManager.begin();
+  doorMonitor.begin();
+  ledMatrix.begin();
+  
+  // Счетчики энергии и воды продолжают накопление с сохраненных значений
+  energyMeter.begin();
   
   // Подключение к WiFi
   setupWiFi();
   
+  // Режим питания: modem sleep и light sleep между плановыми делами
+  powerManager.begin();
+  
   // Инициализация веб-сервера
   webInterface.begin(server);
   
-  Serial.println("SYSTEM INITIALIZATION COMPLETE");
+  // Рассылка телеметрии по UDP (если включена в настройках)
+  telemetryPublisher.begin();
+  
+  // Подключение к MQTT брокеру выполняется из сетевого цикла без блокировки старта
+  mqttClient.begin();
+  
+  // Управление - на ядре 1, сеть и индикатор - на ядре 0
+  controlTask.begin(runControlCycle, runNetworkCycle);
+  
+  LOG_INFO("SYSTEM INITIALIZATION COMPLETE");
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("IP: " + WiFi.localIP().toString());
+    LOG_INFO("IP: %s", WiFi.localIP().toString().c_str());
   }
 }
 
 void loop() {
-  server.handleClient();
+  // Работу ведут задачи управления и сети, loopTask больше не нужен
+  if (controlTask.isTasked()) {
+    vTaskDelete(NULL);
+  }
+  controlTask.poll();
+}
+
+// Задача управления: датчики, автоматика, тревоги, выходы
+void runControlCycle() {
+  PROFILE_SCOPE(LOOP);
+  
+  {
+    HEAP_SCOPE(DISCOVERY);
+    POWER_SCOPE(SENSORS);
+    deviceManager.update();
+  }
   
   unsigned long currentMillis = millis();
   
+  {
+    POWER_SCOPE(CONTROL);
+    energyMeter.update();
+    
+    // События двери из прерывания; открытая дверь приостанавливает климат
+    if (doorMonitor.update(sensorData)) {
+      if (systemSettings.automationEnabled) {
+        automation.onDoorChanged(sensorData.doorState, deviceManager);
+      }
+      traceRecorder.recordDoor(currentMillis, sensorData, systemSettings.automationEnabled);
+    }
+  }
+  
   // Чтение датчиков
   if (currentMillis - previousSensorRead >= SENSOR_READ_INTERVAL) {
     previousSensorRead = currentMillis;
-    deviceManager.readAllSensors();
+    SensorData raw;
+    bool airAvailable, soilAvailable, lightAvailable;
+    {
+      POWER_SCOPE(SENSORS);
+      deviceManager.readAllSensors();
+      raw = sensorData;
+      
+      // Канал отказавшего устройства не получает новых отсчетов и теряет доверие
+      airAvailable = deviceConfig.bme280Healthy;
+      soilAvailable = deviceConfig.hasSoilSensors && deviceConfig.soilSensorsHealthy;
+      lightAvailable = deviceConfig.bh1750Healthy;
+      
+      // Фильтрация выбросов и оценка достоверности до автоматики
+      sensorFusion.process(sensorData, currentMillis, airAvailable, soilAvailable, lightAvailable);
+    }
     
     if (systemSettings.automationEnabled) {
-      automation.process(sensorData, systemSettings, deviceManager);
+      PROFILE_SCOPE(AUTOMATION);
+      HEAP_SCOPE(AUTOMATION);
+      POWER_SCOPE(CONTROL);
+      automation.process(sensorData, systemSettings, deviceManager, currentMillis);
     }
     
+    // Сырые показания и решения автоматики - для воспроизведения на стенде
+    traceRecorder.recordSample(currentMillis, raw, sensorData, airAvailable, soilAvailable, lightAvailable,
+                               systemSettings.automationEnabled);
+    
     // Логирование данных
-    Serial.println("SYSTEM STATUS");
-    Serial.printf("Air: %.1fC %.1f%%\n", sensorData.airTemperature, sensorData.airHumidity);
-    Serial.printf("Soil: %.1fC %.1f%%\n", sensorData.soilTemperature, sensorData.soilMoisture);
-    Serial.printf("Light: %.0f lux\n", sensorData.lightLevel);
+    LOG_INFO("SYSTEM STATUS - Air: %.1fC %.1f%%, Soil: %.1fC %.1f%%, Light: %.0f lux",
+             sensorData.airTemperature.toFloat(), sensorData.airHumidity.toFloat(),
+             sensorData.soilTemperature.toFloat(), sensorData.soilMoisture.toFloat(),
+             sensorData.lightLevel.toFloat());
   }
   
-  // Обновление дисплея
-  if (currentMillis - previousDisplayUpdate >= DISPLAY_UPDATE_INTERVAL) {
-    previousDisplayUpdate = currentMillis;
-    displayManager.updateDisplay(sensorData, systemSettings);
+  {
+    // Тревоги: пороги, устаревшие каналы, залипшие выходы
+    POWER_SCOPE(CONTROL);
+    alarmEngine.update(sensorData);
+  }
+  {
+    // Матрица - еще и фитосветильник, поэтому выводится из цикла управления
+    POWER_SCOPE(DISPLAY);
+    ledMatrix.update(sensorData);
   }
   
   // Проверка здоровья системы
   if (currentMillis - previousHealthCheck >= HEALTH_CHECK_INTERVAL) {
     previousHealthCheck = currentMillis;
+    POWER_SCOPE(SENSORS);
     deviceManager.checkDeviceHealth();
   }
 }
 
+// Сетевая задача: HTTP, MQTT, телеметрия, индикатор. Показания - из sensorView,
+// состояние управления - из statusView.
+void runNetworkCycle() {
+  {
+    PROFILE_SCOPE(HTTP_CLIENT);
+    HEAP_SCOPE(HTTP);
+    POWER_SCOPE(NETWORK);
+    server.handleClient();
+  }
+  {
+    POWER_SCOPE(NETWORK);
+    telemetryPublisher.update();
+    mqttClient.update();
+  }
+  heapMonitor.update();
+  {
+    // Дисплей: кадр по собственному таймеру
+    POWER_SCOPE(DISPLAY);
+    displayManager.update(sensorView);
+  }
+}
+
 void setupWiFi() {
-  Serial.print("Connecting to ");
-  Serial.println(systemSettings.wifiSSID);
+  LOG_INFO("Connecting to %s", systemSettings.wifiSSID);
   
   WiFi.begin(systemSettings.wifiSSID, systemSettings.wifiPassword);
   
   int attempts = 0;
   while (WiFi.status() != WL_CONNECTED && attempts < 20) {
     delay(1000);
-    Serial.print(".");
     attempts++;
   }
   
   if (WiFi.status() == WL_CONNECTED) {
-    Serial.println("\nConnected! IP: " + WiFi.localIP().toString());
+    LOG_INFO("Connected! IP: %s", WiFi.localIP().toString().c_str());
   } else {
-    Serial.println("\nStarting AP mode...");
+    LOG_WARN("Starting AP mode...");
     WiFi.softAP("SmartGreenhouse-M2", "12345678");
-    Serial.println("AP IP: " + WiFi.softAPIP().toString());
+    LOG_INFO("AP IP: %s", WiFi.softAPIP().toString().c_str());
   }
 }
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+// Размер строки кэша для разнесения индексов производителя и потребителя.
+// Внутренняя SRAM ESP32 не кэшируется, выравнивание важно для PSRAM и
+// сборки на ПК (стресс-тесты), а на плате стоит не больше пары байт.
+#ifndef QUEUE_CACHE_LINE
+#define QUEUE_CACHE_LINE 32
+#endif
+
+// Встраивание обязательно: вызов из IRAM_ATTR обработчика прерывания не
+// должен уходить в функцию во flash
+#define QUEUE_INLINE inline __attribute__((always_inline))
+
+// Кольцо фиксированной емкости для одного производителя и одного
+// потребителя. Без блокировок и выделения памяти, годится для ISR -> задача
+// и для задач на разных ядрах. Индексы растут непрерывно, переполнение
+// uint32_t корректно при емкости - степени двойки.
+template <typename T, uint32_t SIZE>
+class SpscQueue {
+    static_assert(SIZE > 0 && (SIZE & (SIZE - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    // Производитель. false - очередь заполнена, элемент не добавлен.
+    QUEUE_INLINE bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == SIZE) return false;
+        items[h & (SIZE - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Потребитель. false - очередь пуста.
+    QUEUE_INLINE bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = items[t & (SIZE - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Потребитель: разбор на месте, без копирования (nullptr - пусто).
+    // Элемент остается занятым до release().
+    QUEUE_INLINE const T* front() const {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return nullptr;
+        return &items[t & (SIZE - 1)];
+    }
+
+    QUEUE_INLINE void release() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Потребитель: отбросить все накопленное
+    void clear() {
+        tail.store(head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    // Приблизительно, если вызывать не из потребителя или производителя
+    uint32_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    bool empty() const { return size() == 0; }
+    static constexpr uint32_t capacity() { return SIZE; }
+
+private:
+    alignas(QUEUE_CACHE_LINE) std::atomic<uint32_t> head{0};   // пишет производитель
+    alignas(QUEUE_CACHE_LINE) std::atomic<uint32_t> tail{0};   // пишет потребитель
+    alignas(QUEUE_CACHE_LINE) T items[SIZE];
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "TelemetryPublisher.h"
+#include <WiFi.h>
+#include "Logger.h"
+
+// ===== Упаковка полей =====
+static uint8_t* putU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+static uint8_t* putU32(uint8_t* out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = value >> 24;
+    return out + 4;
+}
+
+// Показания уже в фиксированной точке с масштабом кадра; метки отсутствия
+// знаковых полей совпадают (INT16_MIN), беззнаковые поля кадра используют максимум
+static uint16_t unsignedField(Percent value) {
+    return (value.isValid() && value.raw() >= 0) ? value.raw() : UINT16_MAX;
+}
+
+static uint16_t unsignedField(Pressure value) {
+    return (value.isValid() && value.raw() >= 0) ? value.raw() : UINT16_MAX;
+}
+
+// ===== Кадр =====
+size_t TelemetryPublisher::encodeFrame(const SensorData& data, uint32_t deviceId, uint32_t sequence,
+                                       uint32_t timestamp, uint8_t* buffer) {
+    uint8_t* out = buffer;
+    out = putU16(out, MAGIC);
+    *out++ = FORMAT_VERSION;
+    *out++ = FRAME_SENSOR_DATA;
+    out = putU32(out, deviceId);
+    out = putU32(out, sequence);
+    out = putU32(out, timestamp);
+
+    static_assert(Temperature::scale == 100 && Percent::scale == 100 && Pressure::scale == 10,
+                  "Frame field scales must match SensorData");
+    out = putU16(out, (uint16_t)data.airTemperature.raw());
+    out = putU16(out, unsignedField(data.airHumidity));
+    out = putU16(out, unsignedField(data.pressure));
+    out = putU16(out, (uint16_t)data.soilTemperature.raw());
+    out = putU16(out, unsignedField(data.soilMoisture));
+    out = putU32(out, data.lightLevel.isValid() ? (uint32_t)data.lightLevel.raw() * 10 : UINT32_MAX);
+
+    *out++ = (data.pumpState ? 0x01 : 0) |
+             (data.fanState ? 0x02 : 0) |
+             (data.heaterState ? 0x04 : 0) |
+             (data.lightState ? 0x08 : 0) |
+             (data.doorState ? 0x10 : 0) |
+             (data.systemHealthy ? 0x20 : 0);
+
+    out = putU16(out, crc16(buffer, out - buffer));
+    return out - buffer;
+}
+
+uint16_t TelemetryPublisher::crc16(const uint8_t* data, size_t length) {
+    // CRC-16/CCITT-FALSE: полином 0x1021, начальное значение 0xFFFF
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+// ===== Отправка =====
+void TelemetryPublisher::begin() {
+    // Локальный порт не нужен: сокет создается при первой отправке
+    deviceId = (uint32_t)ESP.getEfuseMac();
+    LOG_INFO("📡 UDP telemetry %s, port %u, every %us",
+             systemSettings.telemetryEnabled ? "enabled" : "disabled",
+             systemSettings.telemetryPort, (unsigned)systemSettings.telemetryInterval);
+}
+
+void TelemetryPublisher::update() {
+    if (!systemSettings.telemetryEnabled || WiFi.status() != WL_CONNECTED) return;
+
+    unsigned long now = millis();
+    if (now - lastSend < systemSettings.telemetryInterval * 1000UL) return;
+    lastSend = now;
+
+    uint8_t frame[FRAME_SIZE];
+    size_t length = encodeFrame(sensorView, deviceId, sequence, now, frame);
+
+    // Ограниченная широковещательная рассылка: сборщику не нужен адрес устройства
+    bool sent = udp.beginPacket(IPAddress(255, 255, 255, 255), systemSettings.telemetryPort) &&
+                udp.write(frame, length) == length &&
+                udp.endPacket();
+    if (sent) {
+        sequence++;
+    } else {
+        errors++;
+        LOG_WARN("⚠️ UDP telemetry send failed");
+    }
+}
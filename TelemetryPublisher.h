@@ -0,0 +1,50 @@
+#ifndef TELEMETRY_PUBLISHER_H
+#define TELEMETRY_PUBLISHER_H
+
+#include <WiFiUdp.h>
+#include "Config.h"
+
+// Рассылка телеметрии двоичными кадрами по UDP (широковещательно).
+//
+// Формат кадра, little-endian, 33 байта:
+//   0  u16  магическое число 0x4847 ("GH")
+//   2  u8   версия формата
+//   3  u8   тип кадра (1 - данные датчиков)
+//   4  u32  идентификатор устройства (младшие 4 байта MAC)
+//   8  u32  номер кадра
+//   12 u32  время работы, мс
+//   16 i16  температура воздуха, 0.01 °C
+//   18 u16  влажность воздуха, 0.01 %
+//   20 u16  давление, 0.1 гПа
+//   22 i16  температура почвы, 0.01 °C
+//   24 u16  влажность почвы, 0.01 %
+//   26 u32  освещенность, 0.1 лк
+//   30 u8   биты: 0 насос, 1 вентилятор, 2 обогрев, 3 свет, 4 дверь, 5 система исправна
+//   31 u16  CRC-16/CCITT-FALSE по байтам 0-30
+// Отсутствующее значение кодируется максимумом типа (INT16_MIN для знаковых).
+class TelemetryPublisher {
+public:
+    static constexpr uint16_t MAGIC = 0x4847;
+    static constexpr uint8_t FORMAT_VERSION = 1;
+    static constexpr uint8_t FRAME_SENSOR_DATA = 1;
+    static constexpr size_t FRAME_SIZE = 33;
+
+    void begin();
+    void update();
+
+    static size_t encodeFrame(const SensorData& data, uint32_t deviceId, uint32_t sequence,
+                              uint32_t timestamp, uint8_t* buffer);
+    static uint16_t crc16(const uint8_t* data, size_t length);
+
+    uint32_t getSentCount() const { return sequence; }
+    uint32_t getErrorCount() const { return errors; }
+
+private:
+    WiFiUDP udp;
+    uint32_t deviceId = 0;
+    uint32_t sequence = 0;
+    uint32_t errors = 0;
+    unsigned long lastSend = 0;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "TraceRecorder.h"
+#include "SensorFusion.h"
+
+TraceRecorder traceRecorder;
+
+static_assert(sizeof(TraceRecord::values) / sizeof(uint16_t) == (size_t)SensorChannel::COUNT,
+              "Trace samples must cover SensorChannel");
+
+// Значения переносятся битами: метка "нет данных" сохраняется как есть
+template <typename Value>
+static uint16_t encodeValue(Value value) {
+    return (uint16_t)value.raw();
+}
+
+template <typename Value>
+static Value decodeValue(uint16_t bits) {
+    typename Value::Raw raw = (typename Value::Raw)bits;
+    return raw == Value::INVALID ? Value() : Value::fromRaw(raw);
+}
+
+void TraceRecorder::recordSample(uint32_t now, const SensorData& raw, const SensorData& after,
+                                 bool airAvailable, bool soilAvailable, bool lightAvailable,
+                                 bool automationEnabled) {
+    TraceRecord record = {};
+    record.timeMs = now;
+    record.type = TraceRecordType::SAMPLE;
+    record.flags = (raw.doorState ? TraceRecord::FLAG_DOOR_OPEN : 0) |
+                   (raw.systemHealthy ? TraceRecord::FLAG_HEALTHY : 0) |
+                   (automationEnabled ? TraceRecord::FLAG_AUTOMATION : 0) |
+                   (airAvailable ? TraceRecord::FLAG_AIR_AVAILABLE : 0) |
+                   (soilAvailable ? TraceRecord::FLAG_SOIL_AVAILABLE : 0) |
+                   (lightAvailable ? TraceRecord::FLAG_LIGHT_AVAILABLE : 0);
+    record.outputs = outputBits(after);
+    encode(raw, record.values);
+    append(record);
+}
+
+void TraceRecorder::recordDoor(uint32_t now, const SensorData& data, bool automationEnabled) {
+    TraceRecord record = {};
+    record.timeMs = now;
+    record.type = TraceRecordType::DOOR;
+    record.flags = (data.doorState ? TraceRecord::FLAG_DOOR_OPEN : 0) |
+                   (automationEnabled ? TraceRecord::FLAG_AUTOMATION : 0);
+    record.outputs = outputBits(data);
+    append(record);
+}
+
+void TraceRecorder::recordCommand(uint32_t now, ControlDevice device, int16_t value, ControlCause cause) {
+    TraceRecord record = {};
+    record.timeMs = now;
+    record.type = TraceRecordType::COMMAND;
+    record.flags = (uint8_t)cause;
+    record.device = (uint8_t)device;
+    record.values[0] = (uint16_t)value;
+    append(record);
+}
+
+void TraceRecorder::append(const TraceRecord& record) {
+    uint32_t sequence = total.load(std::memory_order_relaxed);
+    records[sequence % Constants::TRACE_CAPACITY] = record;
+    total.store(sequence + 1, std::memory_order_release);
+}
+
+bool TraceRecorder::read(uint32_t sequence, TraceRecord& record) const {
+    record = records[sequence % Constants::TRACE_CAPACITY];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // Ячейку начинают перезаписывать, когда total == sequence + TRACE_CAPACITY
+    return total.load(std::memory_order_relaxed) - sequence < Constants::TRACE_CAPACITY;
+}
+
+uint8_t TraceRecorder::outputBits(const SensorData& data) {
+    return (data.pumpState ? 1 << (uint8_t)ControlDevice::PUMP : 0) |
+           (data.fanState ? 1 << (uint8_t)ControlDevice::FAN : 0) |
+           (data.heaterState ? 1 << (uint8_t)ControlDevice::HEATER : 0) |
+           (data.lightState ? 1 << (uint8_t)ControlDevice::LIGHT : 0);
+}
+
+void TraceRecorder::encode(const SensorData& data, uint16_t* values) {
+    values[0] = encodeValue(data.airTemperature);
+    values[1] = encodeValue(data.airHumidity);
+    values[2] = encodeValue(data.pressure);
+    values[3] = encodeValue(data.soilTemperature);
+    values[4] = encodeValue(data.soilMoisture);
+    values[5] = encodeValue(data.lightLevel);
+}
+
+void TraceRecorder::decode(const uint16_t* values, SensorData& data) {
+    data.airTemperature = decodeValue<Temperature>(values[0]);
+    data.airHumidity = decodeValue<Percent>(values[1]);
+    data.pressure = decodeValue<Pressure>(values[2]);
+    data.soilTemperature = decodeValue<Temperature>(values[3]);
+    data.soilMoisture = decodeValue<Percent>(values[4]);
+    data.lightLevel = decodeValue<Illuminance>(values[5]);
+}
@@ -0,0 +1,89 @@
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#include <atomic>
+#include "Config.h"
+#include "ActuatorHistory.h"
+
+// ===== Формат трассы =====
+// Файл трассы: TraceHeader, затем count записей TraceRecord подряд.
+// Порядок байт - little-endian (как на ESP32 и x86), поля без выравнивания
+// не используются: размеры зафиксированы static_assert.
+enum class TraceRecordType : uint8_t {
+    SAMPLE,     // опрос датчиков и шаг автоматики
+    DOOR,       // смена состояния двери
+    COMMAND,    // изменение выхода (любая причина)
+    GAP = 0xFF  // запись перезаписана во время выгрузки
+};
+
+struct TraceRecord {
+    static constexpr uint8_t FLAG_DOOR_OPEN = 0x01;
+    static constexpr uint8_t FLAG_HEALTHY = 0x02;
+    static constexpr uint8_t FLAG_AUTOMATION = 0x04;   // автоматика включена
+    // SAMPLE: источник дал отсчеты (датчик исправен)
+    static constexpr uint8_t FLAG_AIR_AVAILABLE = 0x08;
+    static constexpr uint8_t FLAG_SOIL_AVAILABLE = 0x10;
+    static constexpr uint8_t FLAG_LIGHT_AVAILABLE = 0x20;
+
+    uint32_t timeMs;
+    TraceRecordType type;
+    uint8_t flags;          // SAMPLE, DOOR: FLAG_*; COMMAND: ControlCause
+    uint8_t outputs;        // SAMPLE, DOOR: биты (1 << ControlDevice) включенных выходов после шага
+    uint8_t device;         // COMMAND: ControlDevice
+    uint16_t values[6];     // SAMPLE: сырые значения каналов по SensorChannel; COMMAND: values[0]
+};
+
+struct TraceHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t recordSize;
+    uint32_t firstSequence;     // сквозной номер первой записи
+    uint32_t count;
+};
+
+static_assert(sizeof(TraceRecord) == 20, "Trace record layout is part of the file format");
+static_assert(sizeof(TraceHeader) == 16, "Trace header layout is part of the file format");
+
+// Запись трассы на устройстве: показания до фильтрации, состояние двери и
+// выходов после каждого шага автоматики и все изменения выходов с причиной.
+// Кольцо в ОЗУ пишет только цикл управления; сетевая сторона выгружает его
+// по сквозным номерам (/api/trace?since=), перезапись во время чтения
+// обнаруживается по счетчику записей.
+class TraceRecorder {
+public:
+    static constexpr uint32_t MAGIC = 0x52544847;   // "GHTR"
+    static constexpr uint16_t VERSION = 2;     // 2: доступность источников в SAMPLE
+    static constexpr uint8_t AUTOMATION_OUTPUTS =
+        (1 << (uint8_t)ControlDevice::PUMP) | (1 << (uint8_t)ControlDevice::FAN) |
+        (1 << (uint8_t)ControlDevice::HEATER) | (1 << (uint8_t)ControlDevice::LIGHT);
+
+    // Доступность источников - та же, что получил SensorFusion на этом шаге
+    void recordSample(uint32_t now, const SensorData& raw, const SensorData& after,
+                      bool airAvailable, bool soilAvailable, bool lightAvailable, bool automationEnabled);
+    void recordDoor(uint32_t now, const SensorData& data, bool automationEnabled);
+    void recordCommand(uint32_t now, ControlDevice device, int16_t value, ControlCause cause);
+
+    // Сквозные номера [getFirstSequence(total), total) еще в кольце. Самая
+    // старая ячейка полного кольца перезаписывается следующей и в выгрузку
+    // не входит - иначе каждая выгрузка начиналась бы с пропуска.
+    uint32_t getTotal() const { return total.load(std::memory_order_acquire); }
+    static uint32_t getFirstSequence(uint32_t total) {
+        return total >= Constants::TRACE_CAPACITY ? total - Constants::TRACE_CAPACITY + 1 : 0;
+    }
+    // false - запись уже перезаписана
+    bool read(uint32_t sequence, TraceRecord& record) const;
+
+    static uint8_t outputBits(const SensorData& data);
+    static void encode(const SensorData& data, uint16_t* values);
+    static void decode(const uint16_t* values, SensorData& data);
+
+private:
+    void append(const TraceRecord& record);
+
+    TraceRecord records[Constants::TRACE_CAPACITY];
+    std::atomic<uint32_t> total{0};
+};
+
+extern TraceRecorder traceRecorder;
+
+#endif
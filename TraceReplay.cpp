@@ -0,0 +1,175 @@
+#include "TraceReplay.h"
+
+static_assert(AirTemperatureTraits::WINDOW <= TraceReplay::WARMUP_SAMPLES &&
+              AirHumidityTraits::WINDOW <= TraceReplay::WARMUP_SAMPLES &&
+              PressureTraits::WINDOW <= TraceReplay::WARMUP_SAMPLES &&
+              SoilTemperatureTraits::WINDOW <= TraceReplay::WARMUP_SAMPLES &&
+              SoilMoistureTraits::WINDOW <= TraceReplay::WARMUP_SAMPLES &&
+              LightLevelTraits::WINDOW <= TraceReplay::WARMUP_SAMPLES,
+              "Replay warm-up must fill every filter window");
+
+void TraceReplay::begin(const SystemSettings& current) {
+    settings = current;
+    fusion = SensorFusion();
+    fusion.setLogging(false);
+    automation = Automation(fusion);
+    automation.setLogging(false);
+    outputs = Outputs();
+    pendingLength = 0;
+    headerParsed = false;
+    sequence = 0;
+    nextSequence = 0;
+    restartWarmup();
+    report = Report();
+}
+
+void TraceReplay::feed(const uint8_t* data, size_t length) {
+    uint32_t start = micros();
+    while (length > 0 && report.error == nullptr) {
+        size_t need = pendingSize();
+        size_t take = need - pendingLength < length ? need - pendingLength : length;
+        memcpy(pending + pendingLength, data, take);
+        pendingLength += take;
+        data += take;
+        length -= take;
+        // После первых байт ясно, заголовок это или запись
+        if (pendingLength < pendingSize()) continue;
+
+        if (pendingSize() == sizeof(TraceHeader)) {
+            parseHeader();
+        } else {
+            TraceRecord record;
+            memcpy(&record, pending, sizeof(record));
+            // Запись, уже пришедшая в предыдущей выгрузке, не повторяется
+            if (sequence++ >= nextSequence) {
+                nextSequence = sequence;
+                apply(record);
+            }
+        }
+        pendingLength = 0;
+    }
+    report.elapsedUs += micros() - start;
+}
+
+size_t TraceReplay::pendingSize() const {
+    if (!headerParsed) return sizeof(TraceHeader);
+    if (pendingLength < HEADER_PEEK) return HEADER_PEEK;
+    TraceHeader header;
+    memcpy(&header, pending, HEADER_PEEK);
+    bool isHeader = header.magic == TraceRecorder::MAGIC && header.recordSize == sizeof(TraceRecord);
+    return isHeader ? sizeof(TraceHeader) : sizeof(TraceRecord);
+}
+
+void TraceReplay::parseHeader() {
+    TraceHeader header;
+    memcpy(&header, pending, sizeof(header));
+    if (header.magic != TraceRecorder::MAGIC || header.version != TraceRecorder::VERSION ||
+        header.recordSize != sizeof(TraceRecord)) {
+        report.error = "Invalid trace header";
+        return;
+    }
+    // Выгрузки идут подряд; выпавшие между ними из кольца записи потеряны
+    if (!headerParsed) {
+        nextSequence = header.firstSequence;
+    } else if (header.firstSequence > nextSequence) {
+        report.gaps += header.firstSequence - nextSequence;
+        restartWarmup();
+    }
+    sequence = header.firstSequence;
+    headerParsed = true;
+    report.segments++;
+}
+
+const TraceReplay::Report& TraceReplay::finish() {
+    if (report.error == nullptr && (!headerParsed || pendingLength != 0)) {
+        report.error = "Truncated trace";
+    }
+    return report;
+}
+
+void TraceReplay::apply(const TraceRecord& record) {
+    if (record.type == TraceRecordType::GAP) {
+        report.gaps++;
+        restartWarmup();
+        return;
+    }
+    if (report.records == 0) report.firstTimeMs = record.timeMs;
+    report.lastTimeMs = record.timeMs;
+    report.records++;
+
+    switch (record.type) {
+        case TraceRecordType::SAMPLE: {
+            SensorData data;
+            TraceRecorder::decode(record.values, data);
+            data.doorState = record.flags & TraceRecord::FLAG_DOOR_OPEN;
+            data.systemHealthy = record.flags & TraceRecord::FLAG_HEALTHY;
+            // Источники - как на устройстве, а не по датчикам того, кто воспроизводит
+            fusion.process(data, record.timeMs, record.flags & TraceRecord::FLAG_AIR_AVAILABLE,
+                           record.flags & TraceRecord::FLAG_SOIL_AVAILABLE,
+                           record.flags & TraceRecord::FLAG_LIGHT_AVAILABLE);
+            settings.automationEnabled = record.flags & TraceRecord::FLAG_AUTOMATION;
+            bool warmup = warmingUp(record);
+            automation.process(data, settings, outputs, record.timeMs);
+            if (warmup) {
+                // Собственные поливы на прогреве не в счет - пауза как на устройстве.
+                // Полив до начала трассы неизвестен: к концу прогрева его пауза истекла бы
+                automation.setLastPumpRun(pumpRunKnown ? devicePumpRunMs
+                                                       : warmupStartMs - Automation::PUMP_COOLDOWN - 1);
+                report.warmupSteps++;
+                outputs.bits = record.outputs;
+            } else {
+                compare(record);
+            }
+            break;
+        }
+        case TraceRecordType::DOOR:
+            if (record.flags & TraceRecord::FLAG_AUTOMATION) {
+                automation.onDoorChanged(record.flags & TraceRecord::FLAG_DOOR_OPEN, outputs);
+            }
+            if (!warm) {
+                report.warmupSteps++;
+                outputs.bits = record.outputs;
+            } else {
+                compare(record);
+            }
+            break;
+        case TraceRecordType::COMMAND:
+            // Решения автоматики проверяются по состоянию после шага, остальное - как было
+            if ((ControlCause)record.flags != ControlCause::AUTOMATION && record.device < DEVICE_COUNT) {
+                outputs.set((ControlDevice)record.device, (int16_t)record.values[0] > 0);
+            } else if (record.device == (uint8_t)ControlDevice::PUMP && (int16_t)record.values[0] > 0) {
+                devicePumpRunMs = record.timeMs;
+                pumpRunKnown = true;
+            }
+            break;
+        case TraceRecordType::GAP:
+            break;
+    }
+}
+
+// Прогрев - окно фильтров и пауза между поливами от начала (или разрыва)
+bool TraceReplay::warmingUp(const TraceRecord& record) {
+    if (warm) return false;
+    if (warmupSamples == 0) warmupStartMs = record.timeMs;
+    if (warmupSamples < WARMUP_SAMPLES) warmupSamples++;
+    warm = warmupSamples == WARMUP_SAMPLES && record.timeMs - warmupStartMs > Automation::PUMP_COOLDOWN;
+    return !warm;
+}
+
+void TraceReplay::compare(const TraceRecord& record) {
+    report.steps++;
+    uint8_t expected = record.outputs & TraceRecorder::AUTOMATION_OUTPUTS;
+    uint8_t actual = outputs.bits & TraceRecorder::AUTOMATION_OUTPUTS;
+    if (expected != actual) {
+        if (report.mismatches == 0) {
+            report.firstMismatchMs = record.timeMs;
+            report.firstMismatchExpected = expected;
+            report.firstMismatchActual = actual;
+        }
+        report.mismatches++;
+        for (uint8_t i = 0; i < DEVICE_COUNT; i++) {
+            if ((expected ^ actual) & (1 << i)) report.deviceMismatches[i]++;
+        }
+    }
+    outputs.bits = record.outputs;
+}
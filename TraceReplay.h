@@ -0,0 +1,103 @@
+#ifndef TRACE_REPLAY_H
+#define TRACE_REPLAY_H
+
+#include "Config.h"
+#include "Actuators.h"
+#include "Automation.h"
+#include "SensorFusion.h"
+#include "TraceRecorder.h"
+
+// Воспроизведение трассы через собственные экземпляры SensorFusion и
+// Automation с текущими настройками. Выходы не трогаются: решения
+// записываются и после каждого шага сравниваются с записанными на
+// устройстве. После сравнения состояние выравнивается по записи, чтобы одно
+// расхождение не тянуло за собой все следующие. Команды не от автоматики
+// (HTTP, MQTT, таймер) применяются как записаны.
+//
+// Кольцо на устройстве держит несколько часов, поэтому трасса почти всегда
+// начинается посреди работы. Фильтры и автоматика начинают с нуля, и первые
+// шаги (прогрев: окно фильтра и пауза между поливами) не сравниваются, а
+// только выравниваются по записи; время полива на прогреве берется из
+// записанных команд. Прогрев начинается заново после потерянных записей.
+//
+// Данные подаются потоком произвольными кусками - трасса за сезон не
+// обязана помещаться в память. Файл может быть склейкой нескольких
+// выгрузок (/api/trace?since=): заголовок следующей стоит на границе
+// записи, повторенные записи пропускаются, пропущенные считаются в gaps.
+class TraceReplay {
+public:
+    static constexpr uint8_t DEVICE_COUNT = (uint8_t)ControlDevice::LIGHT + 1;
+    static constexpr uint8_t WARMUP_SAMPLES = 5;    // самое длинное окно фильтра
+
+    struct Report {
+        uint32_t records = 0;
+        uint32_t steps = 0;                 // сравненные шаги автоматики: опросы и двери
+        uint32_t warmupSteps = 0;           // шаги прогрева, без сравнения
+        uint32_t mismatches = 0;            // шаги с расхождением решений
+        uint32_t deviceMismatches[DEVICE_COUNT] = {};
+        uint32_t gaps = 0;                  // потерянные записи
+        uint32_t segments = 0;              // выгрузки в файле
+        uint32_t firstTimeMs = 0;
+        uint32_t lastTimeMs = 0;
+        uint32_t firstMismatchMs = 0;
+        uint8_t firstMismatchExpected = 0;  // биты выходов
+        uint8_t firstMismatchActual = 0;
+        uint32_t elapsedUs = 0;
+        const char* error = nullptr;
+    };
+
+    void begin(const SystemSettings& settings);
+    void feed(const uint8_t* data, size_t length);
+    void abort() { report.error = "Upload aborted"; }
+    const Report& finish();
+
+private:
+    // Состояние выходов, которое получилось бы у автоматики
+    class Outputs : public Actuators {
+    public:
+        void controlPump(bool state, ControlCause cause, unsigned long duration = 0) override { set(ControlDevice::PUMP, state); }
+        void controlFan(bool state, ControlCause cause) override { set(ControlDevice::FAN, state); }
+        void controlHeater(bool state, ControlCause cause) override { set(ControlDevice::HEATER, state); }
+        void controlLight(bool state, ControlCause cause) override { set(ControlDevice::LIGHT, state); }
+
+        void set(ControlDevice device, bool state) {
+            uint8_t bit = 1 << (uint8_t)device;
+            bits = state ? (bits | bit) : (bits & ~bit);
+        }
+        uint8_t bits = 0;
+    };
+
+    // Размер ожидаемого куска: заголовок или запись различаются по первым байтам
+    size_t pendingSize() const;
+    void parseHeader();
+    void apply(const TraceRecord& record);
+    void restartWarmup() {
+        warmupSamples = 0;
+        warm = false;
+        pumpRunKnown = false;
+    }
+    bool warmingUp(const TraceRecord& record);
+    void compare(const TraceRecord& record);
+
+    SystemSettings settings;
+    SensorFusion fusion;
+    Automation automation{fusion};
+    Outputs outputs;
+
+    // Заголовок и записи могут разрезаться границей куска
+    static constexpr uint8_t HEADER_PEEK = 8;   // magic, version, recordSize
+    uint8_t pending[sizeof(TraceRecord)];
+    uint8_t pendingLength = 0;
+    bool headerParsed = false;
+    uint32_t sequence = 0;          // сквозной номер следующей записи в выгрузке
+    uint32_t nextSequence = 0;      // первая еще не примененная запись
+
+    uint8_t warmupSamples = 0;
+    bool warm = false;
+    unsigned long warmupStartMs = 0;
+    unsigned long devicePumpRunMs = 0;  // последний полив автоматики на устройстве
+    bool pumpRunKnown = false;
+    Report report;
+};
+
+#endif
@@ -1,66 +1,167 @@
 #include "WebInterface.h"
 #include "Config.h"
+#include "ControlStatus.h"
+#include "ControlTask.h"
 #include "DeviceManager.h"
+#include "DeviceNames.h"
 #include "GlobalInstances.h"
+#include "HeapMonitor.h"
+#include "Logger.h"
+#include "PowerManager.h"
+#include "Profiler.h"
+#include "TraceRecorder.h"
 #include "WiFi.h"
 
 
 void WebInterface::begin(WebServer& srv) {
     server = &srv;
     
-    Serial.println("🌐 Starting Web Interface...");
+    LOG_INFO("🌐 Starting Web Interface...");
     
     // Setup routes with diagnostics
-    server->on("/", HTTP_GET, [this]() { 
-        Serial.println("📨 GET / request received");
+    server->on("/", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_ROOT);
+        countRequest(HttpRoute::ROOT);
+        LOG_DEBUG("📨 GET / request received");
         handleRoot(); 
     });
     
-    server->on("/api/sensors", HTTP_GET, [this]() { 
-        Serial.println("📨 GET /api/sensors request received");
+    server->on("/api/sensors", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_SENSORS);
+        countRequest(HttpRoute::SENSORS);
+        LOG_DEBUG("📨 GET /api/sensors request received");
         handleSensorData(); 
     });
     
-    server->on("/api/settings", HTTP_GET, [this]() { 
-        Serial.println("📨 GET /api/settings request received");
+    server->on("/api/settings", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_SETTINGS);
+        countRequest(HttpRoute::SETTINGS);
+        LOG_DEBUG("📨 GET /api/settings request received");
         handleSettings(); 
     });
     
-    server->on("/api/settings", HTTP_POST, [this]() { 
-        Serial.println("📨 POST /api/settings request received");
+    server->on("/api/settings", HTTP_POST, [this]() {
+        PROFILE_SCOPE(HTTP_SETTINGS);
+        countRequest(HttpRoute::SETTINGS);
+        LOG_DEBUG("📨 POST /api/settings request received");
         handleSettings(); 
     });
     
-    server->on("/api/control", HTTP_POST, [this]() { 
-        Serial.println("📨 POST /api/control request received");
+    server->on("/api/control", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_CONTROL);
+        countRequest(HttpRoute::CONTROL);
+        LOG_DEBUG("📨 GET /api/control request received");
         handleControl(); 
     });
     
-    server->on("/api/system", HTTP_GET, [this]() { 
-        Serial.println("📨 GET /api/system request received");
+    server->on("/api/control", HTTP_POST, [this]() {
+        PROFILE_SCOPE(HTTP_CONTROL);
+        countRequest(HttpRoute::CONTROL);
+        LOG_DEBUG("📨 POST /api/control request received");
+        handleControl(); 
+    });
+    
+    server->on("/api/system", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_SYSTEM);
+        countRequest(HttpRoute::SYSTEM);
+        LOG_DEBUG("📨 GET /api/system request received");
         handleSystemInfo(); 
     });
     
-    server->on("/api/calibrate", HTTP_POST, [this]() { 
-        Serial.println("📨 POST /api/calibrate request received");
+    server->on("/api/calibrate", HTTP_POST, [this]() {
+        PROFILE_SCOPE(HTTP_CALIBRATE);
+        countRequest(HttpRoute::CALIBRATE);
+        LOG_DEBUG("📨 POST /api/calibrate request received");
         handleCalibrate(); 
     });
     
-    server->on("/api/reset", HTTP_POST, [this]() { 
-        Serial.println("📨 POST /api/reset request received");
+    server->on("/api/reset", HTTP_POST, [this]() {
+        PROFILE_SCOPE(HTTP_RESET);
+        countRequest(HttpRoute::RESET);
+        LOG_DEBUG("📨 POST /api/reset request received");
         handleReset(); 
     });
     
+    server->on("/metrics", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_PROMETHEUS);
+        countRequest(HttpRoute::PROMETHEUS);
+        handlePrometheus();
+    });
+    
+    server->on("/api/logs", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_LOGS);
+        countRequest(HttpRoute::LOGS);
+        handleLogs();
+    });
+    
+    server->on("/api/history", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_HISTORY);
+        countRequest(HttpRoute::HISTORY);
+        handleHistory();
+    });
+    
+    server->on("/api/energy", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_ENERGY);
+        countRequest(HttpRoute::ENERGY);
+        LOG_DEBUG("📨 GET /api/energy request received");
+        handleEnergy();
+    });
+    
+    server->on("/api/alarms", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_ALARMS);
+        countRequest(HttpRoute::ALARMS);
+        LOG_DEBUG("📨 GET /api/alarms request received");
+        handleAlarms();
+    });
+    
+    server->on("/api/alarms", HTTP_POST, [this]() {
+        PROFILE_SCOPE(HTTP_ALARMS);
+        countRequest(HttpRoute::ALARMS);
+        LOG_DEBUG("📨 POST /api/alarms request received");
+        handleAlarms();
+    });
+    
+    server->on("/api/trace", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_TRACE);
+        countRequest(HttpRoute::TRACE);
+        handleTrace();
+    });
+    
+    // Трасса загружается как multipart-файл и воспроизводится по мере приема
+    server->on("/api/trace/replay", HTTP_POST, [this]() {
+        PROFILE_SCOPE(HTTP_TRACE);
+        countRequest(HttpRoute::TRACE_REPLAY);
+        handleTraceReplay();
+    }, [this]() {
+        handleTraceUpload();
+    });
+    
+#if ENABLE_PROFILING
+    server->on("/api/metrics", HTTP_GET, [this]() {
+        PROFILE_SCOPE(HTTP_METRICS);
+        countRequest(HttpRoute::METRICS);
+        LOG_DEBUG("📨 GET /api/metrics request received");
+        handleMetrics();
+    });
+#endif
+    
     // Test endpoint
     server->on("/test", HTTP_GET, [this]() {
-        Serial.println("📨 GET /test request received");
-        server->send(200, "text/plain", "Web server is working! IP: " + WiFi.localIP().toString());
+        PROFILE_SCOPE(HTTP_STATIC);
+        countRequest(HttpRoute::STATIC);
+        LOG_DEBUG("📨 GET /test request received");
+        IPAddress ip = WiFi.localIP();
+        FixedString<48> text;
+        text.appendf("Web server is working! IP: %u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+        server->send(200, "text/plain", text.c_str());
     });
     
     // Serve static files (CSS)
     server->on("/style.css", HTTP_GET, [this]() {
-        Serial.println("📨 GET /style.css request received");
-        String css = R"(
+        PROFILE_SCOPE(HTTP_STATIC);
+        countRequest(HttpRoute::STATIC);
+        LOG_DEBUG("📨 GET /style.css request received");
+        static const char css[] PROGMEM = R"(
             body { font-family: Arial, sans-serif; margin: 0; padding: 20px; background: #f5f5f5; }
             .container { max-width: 1200px; margin: 0 auto; }
             .card { background: white; padding: 20px; margin: 10px 0; border-radius: 10px; box-shadow: 0 2px 5px rgba(0,0,0,0.1); }
@@ -84,195 +185,647 @@ void WebInterface::begin(WebServer& srv) {
             .healthy { background: #d4edda; color: #155724; }
             .unhealthy { background: #f8d7da; color: #721c24; }
         )";
-        server->send(200, "text/css", css);
+        server->send_P(200, "text/css", css);
     });
     
     server->onNotFound([this]() {
-        Serial.println("❌ 404 - Not Found: " + server->uri());
-        server->send(404, "text/plain", "Endpoint not found: " + server->uri());
+        countRequest(HttpRoute::NOT_FOUND);
+        LOG_WARN("❌ 404 - Not Found: %s", server->uri().c_str());
+        FixedString<96> text("Endpoint not found: ");
+        text += server->uri().c_str();
+        server->send(404, "text/plain", text.c_str());
     });
     
     server->begin();
-    Serial.println("✅ Web Interface initialized");
-    Serial.println("📍 Available endpoints:");
-    Serial.println("   http://" + WiFi.localIP().toString() + "/");
-    Serial.println("   http://" + WiFi.localIP().toString() + "/test");
-    Serial.println("   http://" + WiFi.localIP().toString() + "/api/sensors");
-    Serial.println("   http://" + WiFi.localIP().toString() + "/style.css");
+    LOG_INFO("✅ Web Interface initialized");
+    LOG_INFO("📍 Available endpoints: http://%s/ (/test, /api/sensors, /api/logs, /metrics)",
+             WiFi.localIP().toString().c_str());
 }
 
 void WebInterface::handleRoot() {
-    Serial.println("🔄 Generating main page...");
-    sendHTMLResponse(200, getSystemHTML());
+    LOG_DEBUG("🔄 Generating main page...");
+    sendSystemHTML();
 }
 
 void WebInterface::handleSensorData() {
-    Serial.println("📊 Sending sensor data...");
-    sendJSONResponse(200, "OK", getSensorDataJSON());
+    LOG_DEBUG("📊 Sending sensor data...");
+    fillSensorDataJSON(jsonDoc);
+    sendJSONDocument(200);
 }
 
 void WebInterface::handleSettings() {
     if (server->method() == HTTP_GET) {
-        Serial.println("⚙️ Sending settings...");
-        sendJSONResponse(200, "OK", getSettingsJSON());
+        LOG_DEBUG("⚙️ Sending settings...");
+        fillSettingsJSON(jsonDoc);
+        sendJSONDocument(200);
     } else if (server->method() == HTTP_POST) {
-        Serial.println("💾 Updating settings...");
-        String body = server->arg("plain");
-        Serial.println("Received: " + body);
+        LOG_INFO("💾 Updating settings...");
+        const String& body = server->arg("plain");
+        LOG_DEBUG("Received: %s", body.c_str());
         
-        DynamicJsonDocument doc(1024);
-        DeserializationError error = deserializeJson(doc, body);
+        JsonDocument& doc = jsonDoc;
+        DeserializationError error = deserializeJson(doc, body.c_str(), body.length());
         
         if (error) {
-            Serial.println("❌ JSON parse error: " + String(error.c_str()));
-            sendJSONResponse(400, "Invalid JSON: " + String(error.c_str()));
+            LOG_WARN("❌ JSON parse error: %s", error.c_str());
+            FixedString<48> message("Invalid JSON: ");
+            message += error.c_str();
+            sendJSONResponse(400, message);
             return;
         }
         
-        // Update settings
-        bool updated = false;
-        if (doc.containsKey("tempSetpoint")) {
-            systemSettings.tempSetpoint = doc["tempSetpoint"];
-            Serial.println("Updated tempSetpoint: " + String(systemSettings.tempSetpoint));
-            updated = true;
-        }
-        if (doc.containsKey("humSetpoint")) {
-            systemSettings.humSetpoint = doc["humSetpoint"];
-            Serial.println("Updated humSetpoint: " + String(systemSettings.humSetpoint));
-            updated = true;
-        }
-        if (doc.containsKey("soilMoistureSetpoint")) {
-            systemSettings.soilMoistureSetpoint = doc["soilMoistureSetpoint"];
-            Serial.println("Updated soilMoistureSetpoint: " + String(systemSettings.soilMoistureSetpoint));
-            updated = true;
-        }
-        if (doc.containsKey("lightOnHour")) {
-            systemSettings.lightOnHour = doc["lightOnHour"];
-            Serial.println("Updated lightOnHour: " + String(systemSettings.lightOnHour));
+        FixedString<64> message;
+        int code = applySettings(doc.as<JsonVariantConst>(), message);
+        sendJSONResponse(code, message);
+    }
+}
+
+// Общая логика изменения настроек для HTTP и MQTT
+int WebInterface::applySettings(JsonVariantConst doc, FixedString<64>& message) {
+    // Разбор - в копию настроек; systemSettings заменит цикл управления
+    ControlRequest request;
+    SystemSettings& settings = request.settings;
+    settings = systemSettings;
+    bool updated = false;
+    if (doc.containsKey("tempSetpoint")) {
+        settings.tempSetpoint = doc["tempSetpoint"];
+        LOG_INFO("Updated tempSetpoint: %.2f", settings.tempSetpoint);
+        updated = true;
+    }
+    if (doc.containsKey("humSetpoint")) {
+        settings.humSetpoint = doc["humSetpoint"];
+        LOG_INFO("Updated humSetpoint: %.2f", settings.humSetpoint);
+        updated = true;
+    }
+    if (doc.containsKey("soilMoistureSetpoint")) {
+        settings.soilMoistureSetpoint = doc["soilMoistureSetpoint"];
+        LOG_INFO("Updated soilMoistureSetpoint: %.2f", settings.soilMoistureSetpoint);
+        updated = true;
+    }
+    if (doc.containsKey("lightOnHour")) {
+        settings.lightOnHour = doc["lightOnHour"];
+        LOG_INFO("Updated lightOnHour: %d", settings.lightOnHour);
+        updated = true;
+    }
+    if (doc.containsKey("lightOffHour")) {
+        settings.lightOffHour = doc["lightOffHour"];
+        LOG_INFO("Updated lightOffHour: %d", settings.lightOffHour);
+        updated = true;
+    }
+    if (doc.containsKey("automationEnabled")) {
+        settings.automationEnabled = doc["automationEnabled"];
+        LOG_INFO("Updated automationEnabled: %d", settings.automationEnabled);
+        updated = true;
+    }
+    if (doc.containsKey("lowPowerMode")) {
+        settings.lowPowerMode = doc["lowPowerMode"];
+        LOG_INFO("Updated lowPowerMode: %d (sensor modes and CPU clock apply after restart)",
+                 settings.lowPowerMode);
+        updated = true;
+    }
+    if (doc.containsKey("telemetryEnabled")) {
+        settings.telemetryEnabled = doc["telemetryEnabled"];
+        LOG_INFO("Updated telemetryEnabled: %d", settings.telemetryEnabled);
+        updated = true;
+    }
+    if (doc.containsKey("telemetryPort")) {
+        uint16_t port = doc["telemetryPort"];
+        if (port > 0) {
+            settings.telemetryPort = port;
+            LOG_INFO("Updated telemetryPort: %u", settings.telemetryPort);
             updated = true;
         }
-        if (doc.containsKey("lightOffHour")) {
-            systemSettings.lightOffHour = doc["lightOffHour"];
-            Serial.println("Updated lightOffHour: " + String(systemSettings.lightOffHour));
+    }
+    if (doc.containsKey("telemetryInterval")) {
+        uint16_t interval = doc["telemetryInterval"];
+        if (interval >= 1 && interval <= 3600) {
+            settings.telemetryInterval = interval;
+            LOG_INFO("Updated telemetryInterval: %u", (unsigned)settings.telemetryInterval);
             updated = true;
         }
-        if (doc.containsKey("automationEnabled")) {
-            systemSettings.automationEnabled = doc["automationEnabled"];
-            Serial.println("Updated automationEnabled: " + String(systemSettings.automationEnabled));
+    }
+    if (doc.containsKey("mqttEnabled")) {
+        settings.mqttEnabled = doc["mqttEnabled"];
+        LOG_INFO("Updated mqttEnabled: %d", settings.mqttEnabled);
+        updated = true;
+    }
+    if (doc.containsKey("mqttHost")) {
+        strlcpy(settings.mqttHost, doc["mqttHost"] | "", sizeof(settings.mqttHost));
+        LOG_INFO("Updated mqttHost: %s", settings.mqttHost);
+        updated = true;
+    }
+    if (doc.containsKey("mqttPort")) {
+        uint16_t port = doc["mqttPort"];
+        if (port > 0) {
+            settings.mqttPort = port;
+            LOG_INFO("Updated mqttPort: %u", settings.mqttPort);
             updated = true;
         }
-        if (doc.containsKey("wifiSSID")) {
-            strlcpy(systemSettings.wifiSSID, doc["wifiSSID"], sizeof(systemSettings.wifiSSID));
-            Serial.println("Updated wifiSSID: " + String(systemSettings.wifiSSID));
+    }
+    
+    // Номинальные мощности и расход насоса для учета потребления
+    struct Rating { const char* key; uint16_t* field; uint16_t maxValue; };
+    const Rating ratings[] = {
+        {"pumpPowerW", &settings.pumpPowerW, Constants::MAX_RATED_POWER},
+        {"fanPowerW", &settings.fanPowerW, Constants::MAX_RATED_POWER},
+        {"heaterPowerW", &settings.heaterPowerW, Constants::MAX_RATED_POWER},
+        {"lightPowerW", &settings.lightPowerW, Constants::MAX_RATED_POWER},
+        {"pumpFlowRate", &settings.pumpFlowRate, Constants::MAX_PUMP_FLOW},
+    };
+    for (const Rating& rating : ratings) {
+        if (!doc[rating.key].is<int>()) continue;
+        int value = doc[rating.key];
+        if (value >= 0 && value <= rating.maxValue) {
+            *rating.field = value;
+            LOG_INFO("Updated %s: %d", rating.key, value);
             updated = true;
         }
-        if (doc.containsKey("wifiPassword")) {
-            strlcpy(systemSettings.wifiPassword, doc["wifiPassword"], sizeof(systemSettings.wifiPassword));
-            Serial.println("Updated wifiPassword: [hidden]");
+    }
+    if (doc["growProfile"].is<const char*>()) {
+        GrowProfile profile = LedMatrix::parseProfile(doc["growProfile"].as<const char*>());
+        if (profile != GrowProfile::COUNT) {
+            settings.growProfile = (uint8_t)profile;
+            LOG_INFO("Updated growProfile: %s", LedMatrix::profileName(profile));
             updated = true;
         }
-        
-        if (updated) {
-            sendJSONResponse(200, "Settings updated successfully");
-        } else {
-            sendJSONResponse(400, "No valid settings received");
+    }
+    // "alarms": {"<канал>": {"low": x, "high": y}}, null отключает порог
+    JsonVariantConst alarms = doc["alarms"];
+    if (!alarms.isNull()) {
+        for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+            SensorChannel channel = (SensorChannel)i;
+            JsonVariantConst limits = alarms[SensorFusion::channelName(channel)];
+            if (limits.isNull()) continue;
+            
+            float* fields[] = {&settings.alarmLow[i], &settings.alarmHigh[i]};
+            const char* keys[] = {"low", "high"};
+            for (uint8_t k = 0; k < 2; k++) {
+                if (!limits.containsKey(keys[k])) continue;
+                float value = limits[keys[k]].isNull() ? NAN : limits[keys[k]].as<float>();
+                if (!AlarmEngine::thresholdInRange(channel, value)) continue;
+                *fields[k] = value;
+                LOG_INFO("Updated alarm %s.%s: %.1f", SensorFusion::channelName(channel), keys[k], value);
+                updated = true;
+            }
         }
     }
+    if (doc.containsKey("wifiSSID")) {
+        strlcpy(settings.wifiSSID, doc["wifiSSID"] | "", sizeof(settings.wifiSSID));
+        LOG_INFO("Updated wifiSSID: %s", settings.wifiSSID);
+        updated = true;
+    }
+    if (doc.containsKey("wifiPassword")) {
+        strlcpy(settings.wifiPassword, doc["wifiPassword"] | "", sizeof(settings.wifiPassword));
+        LOG_INFO("Updated wifiPassword: [hidden]");
+        updated = true;
+    }
+    
+    if (!updated) {
+        message = "No valid settings received";
+        return 400;
+    }
+    if (!submitSettings(request)) {
+        message = "Control loop busy";
+        return 503;
+    }
+    message = "Settings updated successfully";
+    return 200;
+}
+
+// Настройки меняет только цикл управления: сеть читает их без блокировки
+bool WebInterface::submitSettings(ControlRequest& request) {
+    ControlResult result;
+    request.type = ControlRequest::Type::CONFIGURE;
+    return controlTask.submit(request, result);
 }
 
 void WebInterface::handleControl() {
-    String body = server->arg("plain");
-    Serial.println("🎛️ Control command: " + body);
+    if (server->method() == HTTP_GET) {
+        fillControlJSON(jsonDoc);
+        sendJSONDocument(200);
+        return;
+    }
+    
+    const String& body = server->arg("plain");
+    LOG_DEBUG("🎛️ Control command: %s", body.c_str());
     
-    DynamicJsonDocument doc(256);
-    DeserializationError error = deserializeJson(doc, body);
+    JsonDocument& doc = jsonDoc;
+    DeserializationError error = deserializeJson(doc, body.c_str(), body.length());
     
     if (error) {
-        Serial.println("❌ JSON parse error: " + String(error.c_str()));
+        LOG_WARN("❌ JSON parse error: %s", error.c_str());
         sendJSONResponse(400, "Invalid JSON");
         return;
     }
     
-    if (!doc.containsKey("device") || !doc.containsKey("state")) {
-        Serial.println("❌ Missing device or state in control command");
-        sendJSONResponse(400, "Missing device or state");
-        return;
+    FixedString<64> message;
+    int code = executeControl(doc.as<JsonVariantConst>(), message, ControlCause::HTTP);
+    sendJSONResponse(code, message);
+}
+
+// Общая логика управления для HTTP и MQTT: код ответа и сообщение
+int WebInterface::executeControl(JsonVariantConst doc, FixedString<64>& message, ControlCause cause) {
+    // Либо одиночная команда {device, state|value, duration}, либо {commands: [...]}
+    ControlRequest request;
+    ControlResult result;
+    DeviceManager::ControlCommand* commands = request.commands;
+    uint8_t count = 0;
+    uint8_t failedIndex = 0;
+    const char* reason = nullptr;
+    
+    if (doc.containsKey("commands")) {
+        JsonArrayConst list = doc["commands"].as<JsonArrayConst>();
+        if (list.size() == 0 || list.size() > Constants::MAX_BATCH_COMMANDS) {
+            LOG_WARN("❌ Invalid batch size: %u", (unsigned)list.size());
+            message.appendf("commands must hold 1-%u entries", Constants::MAX_BATCH_COMMANDS);
+            return 400;
+        }
+        for (JsonVariantConst item : list) {
+            if (!parseControlCommand(item, commands[count], reason)) {
+                failedIndex = count;
+                break;
+            }
+            count++;
+        }
+    } else if (parseControlCommand(doc, commands[0], reason)) {
+        count = 1;
+    }
+    
+    if (reason == nullptr) {
+        // Пакет применяет цикл управления; при ошибке проверки ничего не применяется
+        request.type = ControlRequest::Type::COMMANDS;
+        request.cause = cause;
+        request.count = count;
+        if (!controlTask.submit(request, result)) {
+            message = "Control loop busy";
+            return 503;
+        }
+        failedIndex = result.failedIndex;
+        reason = result.reason;
     }
     
-    String device = doc["device"];
-    bool state = doc["state"];
+    if (reason != nullptr) {
+        LOG_WARN("❌ Invalid control command %u: %s", failedIndex, reason);
+        message.appendf("Command %u: %s", failedIndex, reason);
+        return 400;
+    }
     
-    Serial.println("Control: " + device + " -> " + String(state));
+    for (uint8_t i = 0; i < count; i++) {
+        LOG_INFO("Control: %s -> %d", DeviceNames::name(commands[i].device), commands[i].value);
+    }
     
-    if (!validateControlCommand(device, state)) {
-        Serial.println("❌ Invalid control command");
-        sendJSONResponse(400, "Invalid device or state");
-        return;
+    if (count == 1) {
+        message.appendf("Control command executed: %s %d", DeviceNames::name(commands[0].device), commands[0].value);
+    } else {
+        message.appendf("Applied %u commands", count);
+    }
+    return 200;
+}
+
+bool WebInterface::parseControlCommand(JsonVariantConst item, DeviceManager::ControlCommand& command,
+                                       const char*& error) {
+    const char* name = item["device"];
+    if (!name) {
+        error = "missing device";
+        return false;
+    }
+    
+    command.device = DeviceNames::parse(name);
+    const DeviceManager::ControlChannel* channel = DeviceManager::findChannel(command.device);
+    if (!channel) {
+        error = "unknown device";
+        return false;
     }
     
-    applyControlCommand(device, state);
-    sendJSONResponse(200, "Control command executed: " + device + " " + (state ? "ON" : "OFF"));
+    if (item.containsKey("value")) {
+        int value = item["value"];
+        if (!item["value"].is<int>() || value < INT16_MIN || value > INT16_MAX) {
+            error = "value must be an integer";
+            return false;
+        }
+        command.value = value;
+    } else if (item.containsKey("state")) {
+        // Прежний формат: для сервопривода state задает 90° или 0°
+        bool state = item["state"];
+        if (channel->type == DeviceManager::ChannelType::SERVO) {
+            command.value = state ? Constants::DOOR_NEUTRAL_ANGLE : channel->minValue;
+        } else {
+            command.value = state ? channel->maxValue : channel->minValue;
+        }
+    } else {
+        error = "missing state or value";
+        return false;
+    }
+    
+    command.durationMs = item["duration"] | 0UL;
+    return true;
 }
 
 void WebInterface::handleSystemInfo() {
-    Serial.println("🔍 Sending system info...");
-    sendJSONResponse(200, "OK", getSystemInfoJSON());
+    LOG_DEBUG("🔍 Sending system info...");
+    fillSystemInfoJSON(jsonDoc);
+    sendJSONDocument(200);
 }
 
 void WebInterface::handleCalibrate() {
-    String type = server->arg("type");
-    Serial.println("🎯 Calibration request: " + type);
+    const String& type = server->arg("type");
+    LOG_INFO("🎯 Calibration request: %s", type.c_str());
     
-    if (type == "air") {
-        deviceManager.calibrateSoilSensor(false);
-        sendJSONResponse(200, "Air calibration completed");
-    } else if (type == "water") {
-        deviceManager.calibrateSoilSensor(true);
+    if (type != "air" && type != "water") {
+        sendJSONResponse(400, "Invalid calibration type. Use 'air' or 'water'");
+        return;
+    }
+    
+    // АЦП опрашивает цикл управления
+    ControlRequest request;
+    ControlResult result;
+    request.type = ControlRequest::Type::CALIBRATE_SOIL;
+    request.arg = type == "water";
+    if (!controlTask.submit(request, result)) {
+        sendJSONResponse(503, "Control loop busy");
+    } else if (request.arg) {
         sendJSONResponse(200, "Water calibration completed");
     } else {
-        sendJSONResponse(400, "Invalid calibration type. Use 'air' or 'water'");
+        sendJSONResponse(200, "Air calibration completed");
     }
 }
 
 void WebInterface::handleReset() {
-    String type = server->arg("type");
-    Serial.println("🔄 Reset request: " + type);
-    
-    if (type == "settings") {
-        SystemSettings defaults;
-        systemSettings = defaults;
-        sendJSONResponse(200, "Settings reset to defaults");
-    } else if (type == "wifi") {
-        strlcpy(systemSettings.wifiSSID, "", sizeof(systemSettings.wifiSSID));
-        strlcpy(systemSettings.wifiPassword, "", sizeof(systemSettings.wifiPassword));
-        sendJSONResponse(200, "WiFi settings reset");
+    const String& type = server->arg("type");
+    LOG_INFO("🔄 Reset request: %s", type.c_str());
+    
+    if (type == "settings" || type == "wifi") {
+        ControlRequest request;
+        request.settings = systemSettings;
+        if (type == "settings") {
+            request.settings = SystemSettings();
+        } else {
+            strlcpy(request.settings.wifiSSID, "", sizeof(request.settings.wifiSSID));
+            strlcpy(request.settings.wifiPassword, "", sizeof(request.settings.wifiPassword));
+        }
+        if (!submitSettings(request)) {
+            sendJSONResponse(503, "Control loop busy");
+        } else if (type == "settings") {
+            sendJSONResponse(200, "Settings reset to defaults");
+        } else {
+            sendJSONResponse(200, "WiFi settings reset");
+        }
+    } else if (type == "energy") {
+        ControlRequest request;
+        ControlResult result;
+        request.type = ControlRequest::Type::RESET_ENERGY;
+        if (controlTask.submit(request, result)) {
+            sendJSONResponse(200, "Energy counters reset");
+        } else {
+            sendJSONResponse(503, "Control loop busy");
+        }
     } else {
-        sendJSONResponse(400, "Invalid reset type. Use 'settings' or 'wifi'");
+        sendJSONResponse(400, "Invalid reset type. Use 'settings', 'wifi' or 'energy'");
     }
 }
 
-void WebInterface::sendJSONResponse(int code, const String& message, const String& jsonData) {
-    String output;
-    if (jsonData.length() > 0) {
-        output = jsonData;
+void WebInterface::handlePrometheus() {
+    // Без отладочного вывода: опрос Prometheus идет каждые 15 секунд
+    metricsExporter.render(*server);
+}
+
+void WebInterface::handleLogs() {
+    // Без отладочного вывода, иначе запрос журнала попадает в сам журнал
+    fillLogsJSON(jsonDoc);
+    sendJSONDocument(200);
+}
+
+void WebInterface::handleEnergy() {
+    fillEnergyJSON(jsonDoc);
+    sendJSONDocument(200);
+}
+
+void WebInterface::handleAlarms() {
+    if (server->method() == HTTP_GET) {
+        fillAlarmsJSON(jsonDoc);
+        sendJSONDocument(200);
+        return;
+    }
+    
+    // ?ack=<имя тревоги> | all - подтверждение
+    if (!server->hasArg("ack")) {
+        sendJSONResponse(400, "Missing ack parameter");
+        return;
+    }
+    
+    // Состояния тревог меняет только цикл управления
+    ControlRequest request;
+    ControlResult result;
+    const String& target = server->arg("ack");
+    if (target == "all") {
+        request.type = ControlRequest::Type::ACKNOWLEDGE_ALL;
+        if (!controlTask.submit(request, result)) {
+            sendJSONResponse(503, "Control loop busy");
+            return;
+        }
+        FixedString<48> message;
+        message.appendf("Acknowledged %u alarms", result.value);
+        sendJSONResponse(200, message);
+        return;
+    }
+    
+    uint8_t id = AlarmEngine::find(StringView(target.c_str(), target.length()));
+    request.type = ControlRequest::Type::ACKNOWLEDGE;
+    request.arg = id;
+    if (id == AlarmEngine::NONE) {
+        sendJSONResponse(400, "Unknown alarm");
+    } else if (!controlTask.submit(request, result)) {
+        sendJSONResponse(503, "Control loop busy");
+    } else if (result.value) {
+        sendJSONResponse(200, "Alarm acknowledged");
     } else {
-        DynamicJsonDocument doc(256);
-        doc["status"] = code;
-        doc["message"] = message;
-        serializeJson(doc, output);
+        sendJSONResponse(409, "Alarm is not awaiting acknowledgement");
     }
+}
+
+// Бинарная выгрузка трассы: TraceHeader и записи начиная с ?since=<seq>.
+// Клиент продолжает с firstSequence + count; выпавшие из кольца записи потеряны.
+// Выгрузки можно склеивать в один файл подряд - воспроизведение это понимает.
+void WebInterface::handleTrace() {
+    uint32_t total = traceRecorder.getTotal();
+    uint32_t first = TraceRecorder::getFirstSequence(total);
+    uint32_t since = server->hasArg("since") ? strtoul(server->arg("since").c_str(), nullptr, 10) : first;
+    if (since < first) since = first;
+    if (since > total) since = total;
+    
+    TraceHeader header = {TraceRecorder::MAGIC, TraceRecorder::VERSION, sizeof(TraceRecord), since, total - since};
+    server->setContentLength(sizeof(header) + (size_t)header.count * sizeof(TraceRecord));
+    server->send(200, "application/octet-stream", "");
+    server->sendContent((const char*)&header, sizeof(header));
     
-    Serial.println("📤 Sending JSON response: " + String(code) + " - " + message);
-    server->send(code, "application/json", output);
+    // Кусками по размеру буфера ответа. Буфер - байтовый и не выровнен под
+    // uint32_t, записи копируются в него побайтно
+    const uint32_t chunkRecords = RESPONSE_CAPACITY / sizeof(TraceRecord);
+    uint32_t filled = 0;
+    for (uint32_t sequence = since; sequence < total; sequence++) {
+        TraceRecord record;
+        if (!traceRecorder.read(sequence, record)) {
+            record = TraceRecord();
+            record.type = TraceRecordType::GAP;
+        }
+        memcpy(responseBuffer + filled * sizeof(TraceRecord), &record, sizeof(record));
+        if (++filled == chunkRecords) {
+            server->sendContent(responseBuffer, filled * sizeof(TraceRecord));
+            filled = 0;
+        }
+    }
+    if (filled > 0) {
+        server->sendContent(responseBuffer, filled * sizeof(TraceRecord));
+    }
 }
 
-void WebInterface::sendHTMLResponse(int code, const String& html) {
-    Serial.println("📤 Sending HTML response, length: " + String(html.length()));
-    server->send(code, "text/html", html);
+void WebInterface::handleTraceUpload() {
+    HTTPUpload& upload = server->upload();
+    powerManager.noteNetworkActivity();
+    
+    switch (upload.status) {
+        case UPLOAD_FILE_START:
+            LOG_INFO("🔁 Trace replay: %s", upload.filename.c_str());
+            traceReplay.begin(systemSettings);
+            break;
+        case UPLOAD_FILE_WRITE:
+            traceReplay.feed(upload.buf, upload.currentSize);
+            break;
+        case UPLOAD_FILE_END:
+            break;
+        case UPLOAD_FILE_ABORTED:
+            traceReplay.abort();
+            break;
+    }
 }
 
-String WebInterface::getSystemHTML() {
-    String html = R"=====(
+void WebInterface::handleTraceReplay() {
+    const TraceReplay::Report& report = traceReplay.finish();
+    if (report.error) {
+        sendJSONResponse(400, report.error);
+        return;
+    }
+    
+    JsonDocument& doc = jsonDoc;
+    doc["records"] = report.records;
+    doc["segments"] = report.segments;
+    doc["steps"] = report.steps;
+    doc["warmupSteps"] = report.warmupSteps;
+    doc["gaps"] = report.gaps;
+    doc["mismatches"] = report.mismatches;
+    JsonObject devices = doc.createNestedObject("deviceMismatches");
+    for (uint8_t i = 0; i < TraceReplay::DEVICE_COUNT; i++) {
+        devices[DeviceNames::name((ControlDevice)i)] = report.deviceMismatches[i];
+    }
+    if (report.mismatches > 0) {
+        JsonObject first = doc.createNestedObject("firstMismatch");
+        first["t"] = report.firstMismatchMs;
+        first["expected"] = report.firstMismatchExpected;
+        first["actual"] = report.firstMismatchActual;
+    }
+    
+    // Ускорение относительно реального времени записи
+    uint32_t spanMs = report.lastTimeMs - report.firstTimeMs;
+    doc["traceSeconds"] = spanMs / 1000;
+    doc["replayMs"] = report.elapsedUs / 1000;
+    if (report.elapsedUs > 0) {
+        doc["speedup"] = (uint32_t)((uint64_t)spanMs * 1000 / report.elapsedUs);
+    }
+    LOG_INFO("🔁 Trace replay: %lu steps, %lu mismatches", (unsigned long)report.steps,
+             (unsigned long)report.mismatches);
+    sendJSONDocument(200);
+}
+
+void WebInterface::handleHistory() {
+    // ?device=<имя> - фильтр по выходу, ?since=<seq> - только более новые события,
+    // ?limit=<n> - не больше n последних событий
+    ControlDevice device = ControlDevice::UNKNOWN;
+    if (server->hasArg("device")) {
+        const String& name = server->arg("device");
+        device = DeviceNames::parse(StringView(name.c_str(), name.length()));
+        if (device == ControlDevice::UNKNOWN) {
+            sendJSONResponse(400, "Unknown device");
+            return;
+        }
+    }
+    
+    uint32_t since = server->hasArg("since") ? server->arg("since").toInt() : 0;
+    long limit = server->hasArg("limit") ? server->arg("limit").toInt() : HISTORY_PAGE_SIZE;
+    if (limit <= 0 || limit > HISTORY_PAGE_SIZE) limit = HISTORY_PAGE_SIZE;
+    
+    fillHistoryJSON(jsonDoc, device, since, limit);
+    sendJSONDocument(200);
+}
+
+const char* WebInterface::routePath(HttpRoute route) {
+    switch (route) {
+        case HttpRoute::ROOT: return "/";
+        case HttpRoute::SENSORS: return "/api/sensors";
+        case HttpRoute::SETTINGS: return "/api/settings";
+        case HttpRoute::CONTROL: return "/api/control";
+        case HttpRoute::SYSTEM: return "/api/system";
+        case HttpRoute::CALIBRATE: return "/api/calibrate";
+        case HttpRoute::RESET: return "/api/reset";
+        case HttpRoute::METRICS: return "/api/metrics";
+        case HttpRoute::PROMETHEUS: return "/metrics";
+        case HttpRoute::LOGS: return "/api/logs";
+        case HttpRoute::HISTORY: return "/api/history";
+        case HttpRoute::ENERGY: return "/api/energy";
+        case HttpRoute::ALARMS: return "/api/alarms";
+        case HttpRoute::TRACE: return "/api/trace";
+        case HttpRoute::TRACE_REPLAY: return "/api/trace/replay";
+        case HttpRoute::STATIC: return "static";
+        case HttpRoute::NOT_FOUND: return "not_found";
+        case HttpRoute::COUNT: break;
+    }
+    return "unknown";
+}
+
+#if ENABLE_PROFILING
+void WebInterface::handleMetrics() {
+    if (server->hasArg("reset")) {
+        profiler.requestReset();
+        controlTask.resetStats();
+        sendJSONResponse(200, "Metrics reset");
+        return;
+    }
+    fillMetricsJSON(jsonDoc);
+    sendJSONDocument(200);
+}
+#endif
+
+void WebInterface::sendJSONResponse(int code, StringView message) {
+    // Разобранный запрос больше не нужен, документ освобождается для следующего
+    jsonDoc.clear();
+    
+    // Сообщения - константы и проверенные имена, экранирование не требуется
+    FixedString<160> output;
+    output.appendf("{\"status\":%d,\"message\":\"%.*s\"}", code, (int)message.length(), message.data());
+    
+    LOG_DEBUG("📤 Sending JSON response: %d - %.*s", code, (int)message.length(), message.data());
+    server->send(code, "application/json", output.c_str());
+}
+
+void WebInterface::sendJSONDocument(int code) {
+    // Документ и буфер ответа - поля объекта, запрос не выделяет память в куче
+    size_t length = measureJson(jsonDoc);
+    if (jsonDoc.overflowed() || length >= sizeof(responseBuffer)) {
+        LOG_ERROR("❌ JSON response too large: %u bytes", (unsigned)length);
+        jsonDoc.clear();
+        sendJSONResponse(500, "Response too large");
+        return;
+    }
+    
+    serializeJson(jsonDoc, responseBuffer, sizeof(responseBuffer));
+    jsonDoc.clear();
+    
+    LOG_DEBUG("📤 Sending JSON document: %d, length: %u", code, (unsigned)length);
+    server->send_P(code, "application/json", responseBuffer, length);
+}
+
+void WebInterface::sendSystemHTML() {
+    // Страница лежит во flash, IP подставляется отдельным чанком
+    static const char head[] PROGMEM = R"=====(
 <!DOCTYPE html>
 <html lang="en">
 <head>
@@ -285,8 +838,8 @@ String WebInterface::getSystemHTML() {
     <div class="container">
         <h1>Smart Greenhouse M2</h1>
         <p><strong>IP:</strong> )=====";
-    html += WiFi.localIP().toString();
-    html += R"=====(</p>
+;
+    static const char body[] PROGMEM = R"=====(</p>
         
         <div class="grid">
             <!-- Sensor Data -->
@@ -426,7 +979,8 @@ String WebInterface::getSystemHTML() {
             fetch('/api/control', {
                 method: 'POST',
                 headers: {'Content-Type': 'application/json'},
-                body: JSON.stringify({device: device, state: state})
+                // Число - значение выхода (угол сервопривода), bool - вкл/выкл
+                body: JSON.stringify(typeof state === 'number' ? {device: device, value: state} : {device: device, state: state})
             })
             .then(function(r) { 
                 if (!r.ok) throw new Error('Network error: ' + r.status);
@@ -532,86 +1086,317 @@ String WebInterface::getSystemHTML() {
 </body>
 </html>
 )=====";
-    return html;
+    
+    IPAddress ip = WiFi.localIP();
+    FixedString<16> address;
+    address.appendf("%u.%u.%u.%u", ip[0], ip[1], ip[2], ip[3]);
+    
+    LOG_DEBUG("📤 Sending HTML response, length: %u", (unsigned)(sizeof(head) + address.length() + sizeof(body) - 2));
+    server->setContentLength(CONTENT_LENGTH_UNKNOWN);
+    server->send(200, "text/html", "");
+    server->sendContent(head, sizeof(head) - 1);
+    server->sendContent(address.c_str(), address.length());
+    server->sendContent(body, sizeof(body) - 1);
+    server->sendContent("", 0);
 }
 
-String WebInterface::getSensorDataJSON() {
-    DynamicJsonDocument doc(1024);
+void WebInterface::fillSensorDataJSON(JsonDocument& doc) {
+    if (sensorView.airTemperature.isValid())
+        doc["airTemperature"] = sensorView.airTemperature.toFloat();
+    if (sensorView.airHumidity.isValid())
+        doc["airHumidity"] = sensorView.airHumidity.toFloat();
+    if (sensorView.pressure.isValid())
+        doc["pressure"] = sensorView.pressure.toFloat();
+    if (sensorView.soilTemperature.isValid())
+        doc["soilTemperature"] = sensorView.soilTemperature.toFloat();
+    if (sensorView.soilMoisture.isValid())
+        doc["soilMoisture"] = sensorView.soilMoisture.toFloat();
+    if (sensorView.lightLevel.isValid())
+        doc["lightLevel"] = sensorView.lightLevel.toFloat();
     
-    if (!isnan(sensorData.airTemperature))
-        doc["airTemperature"] = sensorData.airTemperature;
-    if (!isnan(sensorData.airHumidity))
-        doc["airHumidity"] = sensorData.airHumidity;
-    if (!isnan(sensorData.pressure))
-        doc["pressure"] = sensorData.pressure;
-    if (!isnan(sensorData.soilTemperature))
-        doc["soilTemperature"] = sensorData.soilTemperature;
-    if (!isnan(sensorData.soilMoisture))
-        doc["soilMoisture"] = sensorData.soilMoisture;
-    if (!isnan(sensorData.lightLevel))
-        doc["lightLevel"] = sensorData.lightLevel;
+    doc["pumpState"] = sensorView.pumpState;
+    doc["fanState"] = sensorView.fanState;
+    doc["heaterState"] = sensorView.heaterState;
+    doc["lightState"] = sensorView.lightState;
+    doc["doorState"] = sensorView.doorState;
     
-    doc["pumpState"] = sensorData.pumpState;
-    doc["fanState"] = sensorData.fanState;
-    doc["heaterState"] = sensorData.heaterState;
-    doc["lightState"] = sensorData.lightState;
-    doc["doorState"] = sensorData.doorState;
+    JsonObject door = doc.createNestedObject("door");
+    door["opens"] = statusView.door.openCount;
+    door["openSeconds"] = statusView.door.totalOpenMs / 1000;
+    door["lastOpenSeconds"] = statusView.door.lastOpenMs / 1000;
+    door["longestOpenSeconds"] = statusView.door.longestOpenMs / 1000;
     
-    String output;
-    serializeJson(doc, output);
-    return output;
+    // Достоверность каналов после фильтрации (0-100)
+    JsonObject confidence = doc.createNestedObject("confidence");
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        SensorChannel channel = (SensorChannel)i;
+        confidence[SensorFusion::channelName(channel)] = statusView.confidence[i];
+    }
+    doc["crossCheckFailed"] = statusView.crossCheckFailed;
 }
 
-String WebInterface::getSettingsJSON() {
-    DynamicJsonDocument doc(512);
-    
+void WebInterface::fillSettingsJSON(JsonDocument& doc) {
     doc["tempSetpoint"] = systemSettings.tempSetpoint;
     doc["humSetpoint"] = systemSettings.humSetpoint;
     doc["soilMoistureSetpoint"] = systemSettings.soilMoistureSetpoint;
     doc["lightOnHour"] = systemSettings.lightOnHour;
     doc["lightOffHour"] = systemSettings.lightOffHour;
     doc["automationEnabled"] = systemSettings.automationEnabled;
+    doc["lowPowerMode"] = systemSettings.lowPowerMode;
     doc["wifiSSID"] = systemSettings.wifiSSID;
+    doc["telemetryEnabled"] = systemSettings.telemetryEnabled;
+    doc["telemetryPort"] = systemSettings.telemetryPort;
+    doc["telemetryInterval"] = systemSettings.telemetryInterval;
+    doc["mqttEnabled"] = systemSettings.mqttEnabled;
+    doc["mqttHost"] = systemSettings.mqttHost;
+    doc["mqttPort"] = systemSettings.mqttPort;
+    doc["pumpPowerW"] = systemSettings.pumpPowerW;
+    doc["fanPowerW"] = systemSettings.fanPowerW;
+    doc["heaterPowerW"] = systemSettings.heaterPowerW;
+    doc["lightPowerW"] = systemSettings.lightPowerW;
+    doc["pumpFlowRate"] = systemSettings.pumpFlowRate;
+    doc["growProfile"] = LedMatrix::profileName((GrowProfile)systemSettings.growProfile);
+    
+    // Пороги тревог: null - порог отключен
+    JsonObject alarms = doc.createNestedObject("alarms");
+    for (uint8_t i = 0; i < (uint8_t)SensorChannel::COUNT; i++) {
+        JsonObject channel = alarms.createNestedObject(SensorFusion::channelName((SensorChannel)i));
+        if (isnan(systemSettings.alarmLow[i])) channel["low"] = nullptr;
+        else channel["low"] = systemSettings.alarmLow[i];
+        if (isnan(systemSettings.alarmHigh[i])) channel["high"] = nullptr;
+        else channel["high"] = systemSettings.alarmHigh[i];
+    }
+}
+
+void WebInterface::fillSystemInfoJSON(JsonDocument& doc) {
+    doc["systemHealthy"] = sensorView.systemHealthy;
+    doc["bme280Healthy"] = statusView.devices.bme280Healthy;
+    doc["bh1750Healthy"] = statusView.devices.bh1750Healthy;
+    doc["soilSensorsHealthy"] = statusView.devices.soilSensorsHealthy;
+    // char* документ копирует: сводка - временная строка
+    FixedString<384> summary = statusView.deviceSummary();
+    doc["deviceSummary"] = const_cast<char*>(summary.c_str());
+    
+    JsonArray devices = doc.createNestedArray("devices");
+    for (uint8_t i = 0; i < statusView.deviceCount; i++) {
+        const DeviceManager::DeviceStatus& status = statusView.deviceStatus[i];
+        JsonObject device = devices.createNestedObject();
+        device["name"] = status.name;
+        device["address"] = status.address;
+        device["state"] = DeviceHealth::stateName(status.state);
+        device["errorRate"] = status.errorRate;
+    }
+    
+    JsonObject bus = doc.createNestedObject("i2c");
+    bus["stuckEvents"] = statusView.i2cStuckCount;
+    bus["recoveries"] = statusView.i2cRecoveryCount;
+    bus["timeouts"] = statusView.i2cTimeoutCount;
+    JsonArray addresses = bus.createNestedArray("addresses");
+    for (uint8_t i = 0; i < statusView.i2cStatsCount; i++) {
+        const I2CBus::AddressStats& stats = statusView.i2cStats[i];
+        JsonObject entry = addresses.createNestedObject();
+        entry["address"] = stats.address;
+        entry["ok"] = stats.okCount;
+        entry["errors"] = stats.errorCount;
+        entry["timeouts"] = stats.timeoutCount;
+        entry["dataErrors"] = stats.dataErrorCount;
+        entry["p50Us"] = stats.latencyUs.percentile(50);
+        entry["p99Us"] = stats.latencyUs.percentile(99);
+        entry["maxUs"] = stats.latencyUs.max();
+    }
+    
+    // Оценка по времени бодрствования и сна, а не измерение
+    JsonObject power = doc.createNestedObject("power");
+    power["lowPowerMode"] = systemSettings.lowPowerMode;
+    power["automaticLightSleep"] = powerManager.hasAutomaticLightSleep();
+    power["averageCurrentMa"] = powerManager.getAverageCurrentMa();
+    power["sleeps"] = powerManager.getSleepCount();
+    power["sleepSeconds"] = powerManager.getSleepMicros() / 1000000.0;
+    JsonObject awake = power.createNestedObject("awakeSeconds");
+    for (uint8_t i = 0; i < (uint8_t)PowerDomain::COUNT; i++) {
+        awake[PowerManager::domainName((PowerDomain)i)] = statusView.awakeMicros((PowerDomain)i) / 1000000.0;
+    }
+    
+    // Джиттер - отклонение интервала между циклами управления от периода
+    JsonObject control = doc.createNestedObject("control");
+    const LatencyHistogram<24>& jitter = statusView.jitterUs;
+    control["mode"] = controlTask.isTasked() ? "tasks" : "loop";
+    control["periodMs"] = controlTask.getPeriodMs();
+    control["cycles"] = jitter.count();
+    control["jitterP50Us"] = jitter.percentile(50);
+    control["jitterP99Us"] = jitter.percentile(99);
+    control["jitterMaxUs"] = jitter.max();
+    control["cycleP99Us"] = statusView.cycleUs.percentile(99);
+    control["cycleMaxUs"] = statusView.cycleUs.max();
+    control["overruns"] = statusView.overruns;
+    control["requestTimeouts"] = controlTask.getTimeouts();
+    if (controlTask.isTasked()) {
+        control["controlStackFree"] = controlTask.getControlStackFree();
+        control["networkStackFree"] = controlTask.getNetworkStackFree();
+    }
+    
+    JsonObject heap = doc.createNestedObject("heap");
+    heap["free"] = ESP.getFreeHeap();
+    heap["largestBlock"] = ESP.getMaxAllocHeap();
+    heap["minFree"] = ESP.getMinFreeHeap();
+    heap["minLargestBlock"] = heapMonitor.getMinLargestBlock();
+    heap["fragmentation"] = heapMonitor.fragmentationPercent();
+    heap["largestBlockTrend"] = heapMonitor.largestBlockTrend();
+    heap["fragmenting"] = heapMonitor.isFragmenting();
+    heap["samples"] = heapMonitor.getSampleCount();
+    JsonArray subsystems = heap.createNestedArray("subsystems");
+    for (uint8_t i = 0; i < (uint8_t)HeapSubsystem::COUNT; i++) {
+        const HeapMonitor::SubsystemStats& stats = heapMonitor.getStats((HeapSubsystem)i);
+        JsonObject entry = subsystems.createNestedObject();
+        entry["name"] = HeapMonitor::subsystemName((HeapSubsystem)i);
+        entry["calls"] = stats.calls;
+        entry["growthEvents"] = stats.growthEvents;
+        entry["retainedBytes"] = stats.retainedBytes;
+        entry["maxRetained"] = stats.maxRetained;
+    }
+}
+
+void WebInterface::fillLogsJSON(JsonDocument& doc) {
+    doc["dropped"] = logger.getDroppedCount();
+    doc["suppressed"] = logger.getSuppressedCount();
     
-    String output;
-    serializeJson(doc, output);
-    return output;
+    JsonArray entries = doc.createNestedArray("entries");
+    Logger::Entry entry;
+    for (uint8_t i = 0; i < logger.getRecentCount(); i++) {
+        if (!logger.getRecent(i, entry)) break;
+        
+        char level[2] = {Logger::levelChar(entry.level), '\0'};
+        JsonObject item = entries.createNestedObject();
+        item["t"] = entry.timestamp;
+        item["level"] = level;
+        item["msg"] = entry.text;  // Копируется: запись локальная
+    }
 }
 
-String WebInterface::getSystemInfoJSON() {
-    DynamicJsonDocument doc(512);
+void WebInterface::fillAlarmsJSON(JsonDocument& doc) {
+    unsigned long now = millis();
+    doc["active"] = statusView.alarms.getActiveCount();
+    doc["unacknowledged"] = statusView.alarms.getUnacknowledgedCount();
     
-    doc["systemHealthy"] = sensorData.systemHealthy;
-    doc["bme280Healthy"] = deviceConfig.bme280Healthy;
-    doc["bh1750Healthy"] = deviceConfig.bh1750Healthy;
-    doc["soilSensorsHealthy"] = deviceConfig.soilSensorsHealthy;
-    doc["deviceSummary"] = deviceManager.getDeviceSummary();
+    JsonArray alarms = doc.createNestedArray("alarms");
+    AlarmEngine::Name name;
+    for (uint8_t id = 0; id < AlarmEngine::ALARM_COUNT; id++) {
+        AlarmEngine::name(id, name);
+        JsonObject alarm = alarms.createNestedObject();
+        alarm["name"] = name.c_str();
+        alarm["kind"] = AlarmEngine::kindName(AlarmEngine::kindOf(id));
+        alarm["state"] = AlarmEngine::stateName(statusView.alarms.getState(id));
+        alarm["raised"] = statusView.alarms.getRaiseCount(id);
+        if (statusView.alarms.getState(id) != AlarmState::NORMAL) {
+            alarm["ageSeconds"] = (now - statusView.alarms.getSince(id)) / 1000;
+        }
+    }
+}
+
+void WebInterface::fillEnergyJSON(JsonDocument& doc) {
+    // Сутки отсчитываются по наработке контроллера, а не по календарю
+    doc["day"] = statusView.energy.getDayIndex();
+    doc["dayElapsedSeconds"] = statusView.energy.getDayElapsedMs() / 1000;
+    
+    // Для каждого периода: текущее значение и последнее завершенное
+    JsonObject periods = doc.createNestedObject("periods");
+    for (uint8_t p = 0; p < (uint8_t)EnergyPeriod::COUNT; p++) {
+        EnergyPeriod period = (EnergyPeriod)p;
+        JsonObject entry = periods.createNestedObject(EnergyMeter::periodName(period));
+        entry["kWh"] = statusView.energy.getTotalEnergyKWh(period);
+        entry["waterLitres"] = statusView.energy.getWaterLitres(period);
+        if (period != EnergyPeriod::TOTAL) {
+            entry["previousKWh"] = statusView.energy.getTotalEnergyKWh(period, true);
+            entry["previousWaterLitres"] = statusView.energy.getWaterLitres(period, true);
+        }
+    }
     
-    String output;
-    serializeJson(doc, output);
-    return output;
+    JsonObject outputs = doc.createNestedObject("outputs");
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice id = DeviceManager::getChannel(i).id;
+        uint16_t power = statusView.energy.getRatedPower(id);
+        if (power == 0) continue;
+        
+        JsonObject output = outputs.createNestedObject(DeviceNames::name(id));
+        output["ratedPowerW"] = power;
+        for (uint8_t p = 0; p < (uint8_t)EnergyPeriod::COUNT; p++) {
+            EnergyPeriod period = (EnergyPeriod)p;
+            output[EnergyMeter::periodName(period)] = statusView.energy.getEnergyKWh(id, period);
+        }
+    }
 }
 
-bool WebInterface::validateControlCommand(const String& device, bool state) {
-    if (device == "pump" || device == "fan" || device == "heater" || device == "light") {
-        return true;
+void WebInterface::fillHistoryJSON(JsonDocument& doc, ControlDevice device, uint32_t since, uint16_t limit) {
+    const ActuatorHistory& history = statusView.history;
+    doc["total"] = history.getTotalEvents();
+    doc["capacity"] = ActuatorHistory::EVENT_COUNT;
+    
+    // Сводка по выходам
+    JsonObject outputs = doc.createNestedObject("outputs");
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        ControlDevice id = DeviceManager::getChannel(i).id;
+        if (device != ControlDevice::UNKNOWN && id != device) continue;
+        
+        JsonObject output = outputs.createNestedObject(DeviceNames::name(id));
+        output["active"] = history.isActive(id);
+        output["switches"] = history.getSwitchCount(id);
+        output["onTimeSeconds"] = (uint32_t)(history.getOnTimeMs(id) / 1000);
+    }
+    
+    // События от новых к старым
+    JsonArray events = doc.createNestedArray("events");
+    uint16_t added = 0;
+    for (uint16_t i = history.getEventCount(); i > 0 && added < limit; i--) {
+        uint32_t seq = history.getSequence(i - 1);
+        if (seq < since) break;
+        
+        const ActuatorHistory::Event& event = history.getEvent(i - 1);
+        if (device != ControlDevice::UNKNOWN && event.device != device) continue;
+        
+        JsonObject item = events.createNestedObject();
+        item["seq"] = seq;
+        item["t"] = event.timestamp;
+        item["device"] = DeviceNames::name(event.device);
+        item["value"] = event.value;
+        item["cause"] = ActuatorHistory::causeName(event.cause);
+        added++;
     }
-    if (device == "door") {
-        return (state == 0 || state == 90);
+}
+
+#if ENABLE_PROFILING
+void WebInterface::fillMetricsJSON(JsonDocument& doc) {
+    // Счетчик тактов переводится в микросекунды по текущей частоте CPU
+    uint32_t cyclesPerUs = ESP.getCpuFreqMHz();
+    doc["cpuMHz"] = cyclesPerUs;
+    
+    JsonArray stages = doc.createNestedArray("stages");
+    for (uint8_t i = 0; i < (uint8_t)ProfileStage::COUNT; i++) {
+        ProfileStage stage = (ProfileStage)i;
+        const LatencyHistogram<32>& histogram = profiler.get(stage);
+        if (histogram.count() == 0) continue;
+        
+        JsonObject entry = stages.createNestedObject();
+        entry["name"] = Profiler::stageName(stage);
+        entry["count"] = histogram.count();
+        entry["p50Us"] = histogram.percentile(50) / cyclesPerUs;
+        entry["p99Us"] = histogram.percentile(99) / cyclesPerUs;
+        entry["maxUs"] = histogram.max() / cyclesPerUs;
     }
-    return false;
 }
+#endif
 
-void WebInterface::applyControlCommand(const String& device, bool state) {
-    if (device == "pump") {
-        deviceManager.controlPump(state);
-    } else if (device == "fan") {
-        deviceManager.controlFan(state);
-    } else if (device == "heater") {
-        deviceManager.controlHeater(state);
-    } else if (device == "light") {
-        deviceManager.controlLight(state);
-    } else if (device == "door") {
-        deviceManager.controlDoor(state ? 90 : 0);
+void WebInterface::fillControlJSON(JsonDocument& doc) {
+    JsonArray devices = doc.createNestedArray("devices");
+    for (uint8_t i = 0; i < DeviceManager::getChannelCount(); i++) {
+        const DeviceManager::ControlChannel& channel = DeviceManager::getChannel(i);
+        JsonObject entry = devices.createNestedObject();
+        entry["name"] = DeviceNames::name(channel.id);
+        entry["type"] = DeviceManager::channelTypeName(channel.type);
+        entry["pin"] = channel.pin;
+        entry["value"] = statusView.channelValue[(uint8_t)channel.id];
+        entry["min"] = channel.minValue;
+        entry["max"] = channel.maxValue;
+        entry["maxDuration"] = channel.maxDurationMs;
+        entry["remaining"] = statusView.channelRemainingMs[(uint8_t)channel.id];
     }
 }
\ No newline at end of file
@@ -4,10 +4,36 @@
 #include <WebServer.h>
 #include <ArduinoJson.h>
 #include "Config.h"
+#include "PowerManager.h"
+#include "DeviceNames.h"
+#include "TraceReplay.h"
+
+#include "DeviceManager.h"
 
-// Forward declarations
-class DeviceManager;
 extern DeviceManager deviceManager;
+struct ControlRequest;
+
+// Маршруты HTTP для счетчиков запросов
+enum class HttpRoute : uint8_t {
+    ROOT,
+    SENSORS,
+    SETTINGS,
+    CONTROL,
+    SYSTEM,
+    CALIBRATE,
+    RESET,
+    METRICS,
+    PROMETHEUS,
+    LOGS,
+    HISTORY,
+    ENERGY,
+    ALARMS,
+    TRACE,
+    TRACE_REPLAY,
+    STATIC,
+    NOT_FOUND,
+    COUNT
+};
 
 class WebInterface {
 public:
@@ -21,18 +47,59 @@ public:
     void handleSystemInfo();
     void handleCalibrate();
     void handleReset();
+    void handlePrometheus();
+    void handleLogs();
+    void handleHistory();
+    void handleEnergy();
+    void handleAlarms();
+    void handleTrace();
+    void handleTraceUpload();
+    void handleTraceReplay();
+#if ENABLE_PROFILING
+    void handleMetrics();
+#endif
+    
+    // Разбор и применение JSON настроек/команд - общие для HTTP и MQTT
+    int applySettings(JsonVariantConst doc, FixedString<64>& message);
+    int executeControl(JsonVariantConst doc, FixedString<64>& message, ControlCause cause);
+    
+    uint32_t getRequestCount(HttpRoute route) const { return requestCounts[(uint8_t)route]; }
+    static const char* routePath(HttpRoute route);
     
 private:
     WebServer* server;
+    uint32_t requestCounts[(uint8_t)HttpRoute::COUNT] = {};
+    
+    void countRequest(HttpRoute route) {
+        requestCounts[(uint8_t)route]++;
+        powerManager.noteNetworkActivity();
+    }
+    
+    // Один документ и один буфер на все запросы: обработчики выполняются по очереди
+    static constexpr size_t JSON_CAPACITY = 6144;
+    static constexpr size_t RESPONSE_CAPACITY = 4096;
+    static constexpr uint16_t HISTORY_PAGE_SIZE = 40;
+    StaticJsonDocument<JSON_CAPACITY> jsonDoc;
+    char responseBuffer[RESPONSE_CAPACITY];
+    TraceReplay traceReplay;
     
-    void sendJSONResponse(int code, const String& message, const String& jsonData = "");
-    void sendHTMLResponse(int code, const String& html);
-    String getSystemHTML();
-    String getSensorDataJSON();
-    String getSettingsJSON();
-    String getSystemInfoJSON();
-    bool validateControlCommand(const String& device, bool state);
-    void applyControlCommand(const String& device, bool state);
+    void sendJSONResponse(int code, StringView message);
+    void sendJSONDocument(int code);
+    void sendSystemHTML();
+    void fillSensorDataJSON(JsonDocument& doc);
+    void fillSettingsJSON(JsonDocument& doc);
+    void fillSystemInfoJSON(JsonDocument& doc);
+    void fillLogsJSON(JsonDocument& doc);
+    void fillEnergyJSON(JsonDocument& doc);
+    void fillAlarmsJSON(JsonDocument& doc);
+    void fillHistoryJSON(JsonDocument& doc, ControlDevice device, uint32_t since, uint16_t limit);
+#if ENABLE_PROFILING
+    void fillMetricsJSON(JsonDocument& doc);
+#endif
+    void fillControlJSON(JsonDocument& doc);
+    bool submitSettings(ControlRequest& request);
+    bool parseControlCommand(JsonVariantConst item, DeviceManager::ControlCommand& command,
+                             const char*& error);
 };
 
 
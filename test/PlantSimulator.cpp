@@ -0,0 +1,186 @@
+#include "PlantSimulator.h"
+#include "SensorConversion.h"
+
+const WeatherProfile PlantSimulator::PROFILES[PlantSimulator::PROFILE_COUNT] = {
+    // name          mean  season daily  hum  day   peak lux  seed
+    {"temperate",    9.0,  8.0,   5.0,   78,  4.0,  80000,    0x1A2B3C4D},
+    {"continental",  5.0,  15.0,  7.0,   68,  4.5,  90000,    0x5E6F7081},
+    {"arid",         22.0, 9.0,   9.0,   30,  2.0,  110000,   0x92A3B4C5},
+    {"tropical",     26.0, 2.0,   4.0,   85,  0.8,  100000,   0xD6E7F809},
+};
+
+// Параметры теплицы: ~10 м³ воздуха, грядка на 10 л запаса воды
+static constexpr float HEAT_CAPACITY = 150000.0;    // Дж/К: воздух, каркас, грунт у поверхности
+static constexpr float ENVELOPE_UA = 25.0;          // Вт/К через стекло и каркас
+static constexpr float AIR_VOLUME = 10.0;           // м³
+static constexpr float AIR_HEAT = 1200.0;           // Дж/(м³*К)
+static constexpr float LEAK_FLOW = 0.002;           // м³/с через неплотности
+static constexpr float FAN_FLOW = 0.03;             // м³/с
+static constexpr float SOLAR_GAIN = 0.012;          // Вт на лк снаружи
+static constexpr float TRANSMISSION = 0.7;          // доля света внутрь
+static constexpr float GROW_LIGHT_LUX = 8000.0;
+static constexpr float SOIL_TAU_S = 21600.0;        // почва догоняет воздух за ~6 ч
+static constexpr float SOIL_CAPACITY_ML = 10000.0;  // 100% влажности почвы
+static constexpr float TRANSPIRATION_MAX = 0.012;   // г/с, полный свет и влажная почва
+static constexpr float LIGHT_SATURATION = 30000.0;  // лк
+static constexpr float WEATHER_TAU_S = 259200.0;    // отклонения погоды держатся ~3 суток
+static constexpr float WEATHER_SIGMA = 3.0;         // °C
+
+// Шум и калибровка датчиков (калибровка почвы - значения DeviceConfig по умолчанию)
+static constexpr float TEMP_NOISE = 0.2;
+static constexpr float HUMIDITY_NOISE = 1.5;
+static constexpr float SOIL_ADC_NOISE = 15.0;
+static constexpr uint16_t SOIL_AIR_ADC = 2800;
+static constexpr uint16_t SOIL_WATER_ADC = 1200;
+
+static constexpr uint32_t PRESSURE_PERIOD_S = 371520;    // ~4.3 суток между циклонами
+
+// Насыщающая абсолютная влажность, г/м³ (формула Магнуса)
+static float saturationVapour(float temperature) {
+    float pressure = 6.112 * expf(17.62 * temperature / (243.12 + temperature));
+    return 216.7 * pressure / (temperature + 273.15);
+}
+
+void PlantSimulator::begin(const WeatherProfile& weather, const SystemSettings& settings) {
+    *this = PlantSimulator();
+    profile = &weather;
+    random = weather.seed;
+    ratedPower[(uint8_t)ControlDevice::PUMP] = settings.pumpPowerW;
+    ratedPower[(uint8_t)ControlDevice::FAN] = settings.fanPowerW;
+    ratedPower[(uint8_t)ControlDevice::HEATER] = settings.heaterPowerW;
+    ratedPower[(uint8_t)ControlDevice::LIGHT] = settings.lightPowerW;
+    pumpFlowRate = settings.pumpFlowRate;
+
+    updateWeather(0);
+    airTemperature = outsideTemperature;
+    soilTemperature = outsideTemperature;
+    vapour = saturationVapour(outsideTemperature) * outsideHumidity / 100;
+    soilMoisture = settings.soilMoistureSetpoint;
+}
+
+void PlantSimulator::updateWeather(float dt) {
+    // Целые секунды: float за год теряет точность часа
+    uint32_t seconds = (uint32_t)(timeMs / 1000);
+    uint32_t day = seconds / 86400;
+    float hour = (seconds % 86400) / 3600.0;
+
+    // Новые сутки - новая облачность
+    if (day != weatherDay) {
+        weatherDay = day;
+        cloudiness = 0.6 + 0.4 * noise();
+    }
+    weatherOffset += -weatherOffset * dt / WEATHER_TAU_S + WEATHER_SIGMA * noise() * sqrtf(3 * dt / WEATHER_TAU_S);
+
+    // -1 в середине января, +1 в середине июля
+    float season = -cosf(TWO_PI * ((int)(day % 365) - 15) / 365);
+    // Минимум около 3 часов ночи, максимум в 15 часов
+    float daily = -cosf(TWO_PI * (hour - 3) / 24);
+
+    outsideTemperature = profile->meanTemperature + profile->seasonalAmplitude * season +
+                         profile->dailyAmplitude * daily + weatherOffset;
+    outsideHumidity = constrain(profile->meanHumidity - 15 * daily, 10.0f, 100.0f);
+    outsidePressure = 1013 + 8 * sinf(TWO_PI * (seconds % PRESSURE_PERIOD_S) / PRESSURE_PERIOD_S);
+
+    float dayLength = 12 + profile->dayLengthAmplitude * season;
+    float sunrise = 12 - dayLength / 2;
+    if (hour > sunrise && hour < sunrise + dayLength) {
+        float sun = sinf(PI * (hour - sunrise) / dayLength);
+        outsideIlluminance = profile->peakIlluminance * (0.65 + 0.35 * season) * sun * cloudiness;
+    } else {
+        outsideIlluminance = 0;
+    }
+}
+
+void PlantSimulator::step(unsigned long dtMs) {
+    float dt = dtMs / 1000.0;
+    updateWeather(dt);
+
+    // Насос с таймером работает только часть шага
+    unsigned long pumpMs = 0;
+    if (isOn(ControlDevice::PUMP)) {
+        pumpMs = (pumpRemainingMs > 0 && pumpRemainingMs < dtMs) ? pumpRemainingMs : dtMs;
+        if (pumpRemainingMs > 0) {
+            pumpRemainingMs -= pumpMs;
+            if (pumpRemainingMs == 0) outputs &= ~(1 << (uint8_t)ControlDevice::PUMP);
+        }
+    }
+
+    for (uint8_t i = 0; i < DEVICE_COUNT; i++) {
+        unsigned long onMs = i == (uint8_t)ControlDevice::PUMP ? pumpMs : (isOn((ControlDevice)i) ? dtMs : 0);
+        totals.energyWms[i] += (uint64_t)ratedPower[i] * onMs;
+    }
+    // мл/мин * мс / 60 = мкл
+    uint64_t waterUl = (uint64_t)pumpFlowRate * pumpMs / 60;
+    totals.waterUl += waterUl;
+
+    // Тепло: солнце, обогреватель и светильник, потери через ограждение и обмен воздуха
+    float flow = LEAK_FLOW + (isOn(ControlDevice::FAN) ? FAN_FLOW : 0);
+    float heat = outsideIlluminance * SOLAR_GAIN +
+                 (isOn(ControlDevice::HEATER) ? ratedPower[(uint8_t)ControlDevice::HEATER] : 0) +
+                 (isOn(ControlDevice::LIGHT) ? ratedPower[(uint8_t)ControlDevice::LIGHT] : 0) +
+                 (ENVELOPE_UA + flow * AIR_HEAT) * (outsideTemperature - airTemperature);
+    airTemperature += heat * dt / HEAT_CAPACITY;
+    soilTemperature += (airTemperature - soilTemperature) * dt / SOIL_TAU_S;
+
+    // Влага: растения испаряют воду из почвы в воздух, обмен с улицей уносит ее
+    illuminance = outsideIlluminance * TRANSMISSION + (isOn(ControlDevice::LIGHT) ? GROW_LIGHT_LUX : 0);
+    float light = illuminance < LIGHT_SATURATION ? illuminance / LIGHT_SATURATION : 1;
+    float wetness = constrain((soilMoisture - 10) / 30, 0.0f, 1.0f);
+    float transpiration = TRANSPIRATION_MAX * (0.15 + 0.85 * light) * wetness;
+
+    float outsideVapour = saturationVapour(outsideTemperature) * outsideHumidity / 100;
+    vapour += (transpiration - flow * (vapour - outsideVapour)) * dt / AIR_VOLUME;
+    float saturation = saturationVapour(airTemperature);
+    if (vapour > saturation) vapour = saturation;   // конденсат на стекле
+    if (vapour < 0) vapour = 0;
+
+    soilMoisture += (waterUl / 1000.0 - transpiration * dt) * 100 / SOIL_CAPACITY_ML;
+    soilMoisture = constrain(soilMoisture, 0.0f, 100.0f);   // избыток стекает
+
+    timeMs += dtMs;
+}
+
+float PlantSimulator::getAirHumidity() const {
+    return 100 * vapour / saturationVapour(airTemperature);
+}
+
+// Показания проходят пересчет драйвера BME280 и АЦП почвы
+void PlantSimulator::readSensors(SensorData& data) {
+    float humidity = constrain(getAirHumidity() + HUMIDITY_NOISE * noise(), 0.0f, 100.0f);
+    SensorConversion::airReading(airTemperature + TEMP_NOISE * noise(), humidity, outsidePressure, data);
+
+    int moistureRaw = SOIL_AIR_ADC + (int)((SOIL_WATER_ADC - SOIL_AIR_ADC) * soilMoisture / 100 +
+                                           SOIL_ADC_NOISE * noise());
+    SensorConversion::soilMoisture(moistureRaw, SOIL_AIR_ADC, SOIL_WATER_ADC, data.soilMoisture);
+    int temperatureRaw = (int)((soilTemperature * 100 + Constants::SOIL_TEMP_OFFSET) *
+                               Constants::SOIL_ADC_MAX / Constants::SOIL_TEMP_FULL_SCALE);
+    SensorConversion::soilTemperature(temperatureRaw, data.soilTemperature);
+
+    // BH1750 насыщается на 65535 лк
+    data.lightLevel = Illuminance::fromFloat(illuminance < 65535 ? illuminance : 65535);
+    data.pumpState = isOn(ControlDevice::PUMP);
+    data.fanState = isOn(ControlDevice::FAN);
+    data.heaterState = isOn(ControlDevice::HEATER);
+    data.lightState = isOn(ControlDevice::LIGHT);
+    data.doorState = false;
+    data.systemHealthy = true;
+}
+
+void PlantSimulator::controlPump(bool state, ControlCause cause, unsigned long duration) {
+    set(ControlDevice::PUMP, state);
+    pumpRemainingMs = state ? duration : 0;
+}
+
+void PlantSimulator::set(ControlDevice device, bool state) {
+    uint8_t bit = 1 << (uint8_t)device;
+    if (state && !(outputs & bit)) totals.cycles[(uint8_t)device]++;
+    outputs = state ? (outputs | bit) : (outputs & ~bit);
+}
+
+float PlantSimulator::noise() {
+    // xorshift32
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    return (int32_t)random / 2147483648.0f;
+}
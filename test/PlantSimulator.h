@@ -0,0 +1,90 @@
+#ifndef PLANT_SIMULATOR_H
+#define PLANT_SIMULATOR_H
+
+#include "Config.h"
+#include "Actuators.h"
+
+// Погодный профиль: годовой и суточный ход температуры и влажности снаружи,
+// долгота дня и солнце. Облачность и отклонения погоды от среднего
+// псевдослучайные, но повторяются от запуска к запуску (seed).
+struct WeatherProfile {
+    const char* name;
+    float meanTemperature;      // °C, среднегодовая
+    float seasonalAmplitude;    // °C, половина разницы лета и зимы
+    float dailyAmplitude;       // °C, половина суточного размаха
+    float meanHumidity;         // %
+    float dayLengthAmplitude;   // ч, отклонение долготы дня от 12 ч
+    float peakIlluminance;      // лк, ясный летний полдень
+    uint32_t seed;
+};
+
+// Модель теплицы с сосредоточенными параметрами: температура воздуха и
+// почвы, абсолютная влажность воздуха и запас воды в почве. Выходы
+// DeviceManager подменяются собственной реализацией Actuators, поэтому
+// Automation управляет моделью без изменений. Показания проходят тот же
+// пересчет, что и при опросе BME280 и АЦП почвы, с шумом датчиков.
+//
+// Время моделируется с 1 января, 00:00. Учет энергии и воды - по
+// номинальным мощностям и расходу насоса из настроек, как у EnergyMeter.
+class PlantSimulator : public Actuators {
+public:
+    static constexpr uint8_t DEVICE_COUNT = (uint8_t)ControlDevice::LIGHT + 1;
+    static constexpr uint8_t PROFILE_COUNT = 4;
+    static const WeatherProfile PROFILES[PROFILE_COUNT];
+
+    struct Totals {
+        uint64_t energyWms[DEVICE_COUNT];   // Вт*мс
+        uint64_t waterUl;                   // микролитры
+        uint32_t cycles[DEVICE_COUNT];      // включения реле
+    };
+
+    void begin(const WeatherProfile& profile, const SystemSettings& settings);
+    // Погода на начало шага, затем состояние на dtMs вперед при текущих выходах
+    void step(unsigned long dtMs);
+    void readSensors(SensorData& data);
+
+    void controlPump(bool state, ControlCause cause, unsigned long duration = 0) override;
+    void controlFan(bool state, ControlCause cause) override { set(ControlDevice::FAN, state); }
+    void controlHeater(bool state, ControlCause cause) override { set(ControlDevice::HEATER, state); }
+    void controlLight(bool state, ControlCause cause) override { set(ControlDevice::LIGHT, state); }
+
+    uint64_t getTimeMs() const { return timeMs; }
+    float getAirTemperature() const { return airTemperature; }
+    float getAirHumidity() const;
+    float getSoilMoisture() const { return soilMoisture; }
+    const Totals& getTotals() const { return totals; }
+
+private:
+    void updateWeather(float dt);
+    void set(ControlDevice device, bool state);
+    bool isOn(ControlDevice device) const { return outputs & (1 << (uint8_t)device); }
+    float noise();  // равномерный в [-1, 1)
+
+    const WeatherProfile* profile = nullptr;
+    uint16_t ratedPower[DEVICE_COUNT] = {};
+    uint16_t pumpFlowRate = 0;
+    uint32_t random = 1;
+    uint64_t timeMs = 0;
+
+    // Погода снаружи
+    float outsideTemperature = 0;
+    float outsideHumidity = 0;
+    float outsidePressure = 0;
+    float outsideIlluminance = 0;
+    float weatherOffset = 0;    // °C, медленное отклонение от климатической нормы
+    float cloudiness = 1;       // доля солнца на текущие сутки
+    uint32_t weatherDay = UINT32_MAX;
+
+    // Состояние теплицы
+    float airTemperature = 0;
+    float vapour = 0;           // г/м³
+    float soilTemperature = 0;
+    float soilMoisture = 0;     // %
+    float illuminance = 0;
+
+    uint8_t outputs = 0;        // биты ControlDevice
+    unsigned long pumpRemainingMs = 0;  // 0 - без автоотключения
+    Totals totals = {};
+};
+
+#endif
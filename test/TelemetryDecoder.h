@@ -0,0 +1,106 @@
+#ifndef TELEMETRY_DECODER_H
+#define TELEMETRY_DECODER_H
+
+// Разбор кадров телеметрии на стороне сборщика. Намеренно не использует
+// код прошивки: смещения и масштабы записаны здесь заново по описанию
+// формата в TelemetryPublisher.h, поэтому тест на этом декодере ловит
+// любое изменение раскладки кадра.
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+struct TelemetryFrame {
+    uint8_t version;
+    uint8_t type;
+    uint32_t deviceId;
+    uint32_t sequence;
+    uint32_t uptimeMs;
+    // NAN - значение отсутствует
+    float airTemperature;   // °C
+    float airHumidity;      // %
+    float pressure;         // гПа
+    float soilTemperature;  // °C
+    float soilMoisture;     // %
+    float lightLevel;       // лк
+    bool pump;
+    bool fan;
+    bool heater;
+    bool light;
+    bool door;
+    bool systemHealthy;
+};
+
+enum class TelemetryDecodeResult {
+    OK,
+    BAD_LENGTH,
+    BAD_MAGIC,
+    BAD_VERSION,
+    BAD_CRC
+};
+
+namespace TelemetryDecoder {
+    constexpr size_t FRAME_SIZE = 33;
+    constexpr uint16_t MAGIC = 0x4847;
+    constexpr uint8_t VERSION = 1;
+
+    inline uint16_t u16(const uint8_t* data, size_t offset) {
+        return data[offset] | (uint16_t)data[offset + 1] << 8;
+    }
+
+    inline uint32_t u32(const uint8_t* data, size_t offset) {
+        return u16(data, offset) | (uint32_t)u16(data, offset + 2) << 16;
+    }
+
+    inline uint16_t crc16(const uint8_t* data, size_t length) {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= (uint16_t)data[i] << 8;
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : (crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    inline float signedField(const uint8_t* data, size_t offset, float scale) {
+        int16_t raw = (int16_t)u16(data, offset);
+        return raw == INT16_MIN ? NAN : raw / scale;
+    }
+
+    inline float unsignedField(const uint8_t* data, size_t offset, float scale) {
+        uint16_t raw = u16(data, offset);
+        return raw == UINT16_MAX ? NAN : raw / scale;
+    }
+
+    inline TelemetryDecodeResult decode(const uint8_t* data, size_t length, TelemetryFrame& frame) {
+        if (length != FRAME_SIZE) return TelemetryDecodeResult::BAD_LENGTH;
+        if (u16(data, 0) != MAGIC) return TelemetryDecodeResult::BAD_MAGIC;
+        if (data[2] != VERSION) return TelemetryDecodeResult::BAD_VERSION;
+        if (u16(data, 31) != crc16(data, 31)) return TelemetryDecodeResult::BAD_CRC;
+
+        frame.version = data[2];
+        frame.type = data[3];
+        frame.deviceId = u32(data, 4);
+        frame.sequence = u32(data, 8);
+        frame.uptimeMs = u32(data, 12);
+        frame.airTemperature = signedField(data, 16, 100);
+        frame.airHumidity = unsignedField(data, 18, 100);
+        frame.pressure = unsignedField(data, 20, 10);
+        frame.soilTemperature = signedField(data, 22, 100);
+        frame.soilMoisture = unsignedField(data, 24, 100);
+        uint32_t light = u32(data, 26);
+        frame.lightLevel = light == UINT32_MAX ? NAN : light / 10.0f;
+
+        uint8_t flags = data[30];
+        frame.pump = flags & 0x01;
+        frame.fan = flags & 0x02;
+        frame.heater = flags & 0x04;
+        frame.light = flags & 0x08;
+        frame.door = flags & 0x10;
+        frame.systemHealthy = flags & 0x20;
+        return TelemetryDecodeResult::OK;
+    }
+}
+
+#endif
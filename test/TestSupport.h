@@ -0,0 +1,28 @@
+#ifndef TEST_SUPPORT_H
+#define TEST_SUPPORT_H
+
+#include <cstdio>
+
+// Проверки без фреймворка: тест печатает каждую неудачу и возвращает
+// число неудач из main() через TEST_RESULT().
+static int testFailures = 0;
+
+#define CHECK(condition) do { \
+    if (!(condition)) { \
+        testFailures++; \
+        printf("%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #condition); \
+    } \
+} while (0)
+
+#define CHECK_EQ(actual, expected) do { \
+    long long actualValue = (long long)(actual), expectedValue = (long long)(expected); \
+    if (actualValue != expectedValue) { \
+        testFailures++; \
+        printf("%s:%d: CHECK_EQ failed: %s == %lld, expected %lld\n", __FILE__, __LINE__, \
+               #actual, actualValue, expectedValue); \
+    } \
+} while (0)
+
+#define TEST_RESULT() (printf(testFailures ? "FAILED: %d\n" : "OK\n", testFailures), testFailures != 0)
+
+#endif
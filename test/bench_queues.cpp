@@ -0,0 +1,103 @@
+// Пропускная способность очередей против кольца под мьютексом - того, что
+// они заменили. Замер в одном потоке показывает цену операции, между
+// потоками - передачу с ожиданием сторон. Числа печатаются таблицей и не
+// проверяются: на ПК они служат для сравнения вариантов, а не порогом.
+//   bench_queues [число операций]
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include "MpscQueue.h"
+#include "SpscQueue.h"
+
+// Запись журнала по размеру близка к этой
+struct Payload {
+    uint32_t timestamp;
+    uint32_t words[7];
+};
+
+template <typename T, uint32_t SIZE>
+class MutexQueue {
+public:
+    bool push(const T& item) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (head - tail == SIZE) return false;
+        items[head++ % SIZE] = item;
+        return true;
+    }
+
+    bool pop(T& item) {
+        std::lock_guard<std::mutex> guard(lock);
+        if (head == tail) return false;
+        item = items[tail++ % SIZE];
+        return true;
+    }
+
+private:
+    std::mutex lock;
+    uint32_t head = 0;
+    uint32_t tail = 0;
+    T items[SIZE];
+};
+
+static volatile uint32_t sink;
+
+static double seconds(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, const char* mode, uint32_t count, double elapsed) {
+    printf("%-8s %-8s %10.1f Mops/s %8.1f ns/op\n", name, mode, count / elapsed / 1e6, elapsed * 1e9 / count);
+}
+
+// Пара push/pop в одном потоке: очередь не пустеет и не переполняется
+template <typename Queue>
+static void singleThread(const char* name, uint32_t count) {
+    static Queue queue;
+    Payload item = {};
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++) {
+        item.timestamp = i;
+        queue.push(item);
+        queue.pop(item);
+        sink = item.timestamp;
+    }
+    report(name, "1 thread", count, seconds(start));
+}
+
+// Производитель и потребитель в разных потоках, ожидание - через yield
+template <typename Queue>
+static void twoThreads(const char* name, uint32_t count) {
+    static Queue queue;
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([count] {
+        Payload item = {};
+        for (uint32_t i = 0; i < count;) {
+            item.timestamp = i;
+            if (queue.push(item)) i++;
+            else std::this_thread::yield();
+        }
+    });
+    Payload item;
+    for (uint32_t received = 0; received < count;) {
+        if (queue.pop(item)) received++;
+        else std::this_thread::yield();
+    }
+    producer.join();
+    sink = item.timestamp;
+    report(name, "2 thread", count, seconds(start));
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = argc > 1 ? strtoul(argv[1], nullptr, 10) : 10000000;
+    printf("%u operations, %u hardware threads\n", count, std::thread::hardware_concurrency());
+
+    singleThread<SpscQueue<Payload, 64>>("spsc", count);
+    singleThread<MpscQueue<Payload, 64>>("mpsc", count);
+    singleThread<MutexQueue<Payload, 64>>("mutex", count);
+
+    twoThreads<SpscQueue<Payload, 64>>("spsc", count);
+    twoThreads<MpscQueue<Payload, 64>>("mpsc", count);
+    twoThreads<MutexQueue<Payload, 64>>("mutex", count);
+    return 0;
+}
@@ -0,0 +1,175 @@
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+// Минимальная замена ядра Arduino-ESP32 для тестов на ПК.
+// Время и выводы управляются тестом через namespace Host.
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <cstdarg>
+#include <string>
+#include <algorithm>
+
+using std::isnan;
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 1
+#define OUTPUT 3
+#define INPUT_PULLUP 5
+#define OUTPUT_OPEN_DRAIN 0x12
+#define HEX 16
+#define DEC 10
+#define PI 3.1415926535897932384626433832795
+#define TWO_PI 6.283185307179586476925286766559
+#define CHANGE 3
+#define RISING 1
+#define FALLING 2
+#define PROGMEM
+#define F(x) x
+#define IRAM_ATTR
+#define ARDUINO_ISR_ATTR
+#ifndef constrain
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+#endif
+#define digitalPinToInterrupt(p) (p)
+
+inline size_t strlcpy(char* dst, const char* src, size_t size) {
+    size_t length = strlen(src);
+    if (size) {
+        size_t copy = length < size - 1 ? length : size - 1;
+        memcpy(dst, src, copy);
+        dst[copy] = 0;
+    }
+    return length;
+}
+
+class String {
+public:
+    String(const char* text = "") : value(text ? text : "") {}
+    String(const std::string& text) : value(text) {}
+    String(long number) : value(std::to_string(number)) {}
+    unsigned length() const { return value.size(); }
+    const char* c_str() const { return value.c_str(); }
+    long toInt() const { return atol(value.c_str()); }
+    bool operator==(const char* other) const { return value == other; }
+    bool operator==(const String& other) const { return value == other.value; }
+    bool operator!=(const char* other) const { return value != other; }
+    String& operator+=(const char* other) { value += other; return *this; }
+
+private:
+    std::string value;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t) { return 1; }
+    virtual size_t write(const uint8_t*, size_t length) { return length; }
+    size_t printf(const char*, ...) __attribute__((format(printf, 2, 3))) { return 0; }
+    size_t println(const char*) { return 0; }
+};
+
+class Stream : public Print {
+public:
+    int available() { return 0; }
+    int read() { return -1; }
+};
+
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long) {}
+    int availableForWrite() { return 128; }
+    void flush() {}
+};
+extern HardwareSerial Serial;
+
+class IPAddress {
+public:
+    IPAddress() {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : bytes{a, b, c, d} {}
+    uint8_t operator[](int index) const { return bytes[index]; }
+    bool fromString(const char* text) {
+        unsigned a, b, c, d;
+        if (sscanf(text, "%u.%u.%u.%u", &a, &b, &c, &d) != 4) return false;
+        bytes[0] = a; bytes[1] = b; bytes[2] = c; bytes[3] = d;
+        return true;
+    }
+
+private:
+    uint8_t bytes[4] = {};
+};
+
+class EspClass {
+public:
+    uint32_t getFreeHeap();
+    uint32_t getMinFreeHeap();
+    uint32_t getMaxAllocHeap();
+    uint32_t getHeapSize();
+    uint32_t getCycleCount();
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint64_t getEfuseMac() { return 0x0000A1B2C3D4E5F6ULL; }
+    void restart() {}
+};
+extern EspClass ESP;
+
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned us);
+void yield();
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+uint16_t analogRead(uint8_t pin);
+
+// ===== FreeRTOS: задачи на ПК не создаются =====
+typedef void* TaskHandle_t;
+typedef int BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+#define pdMS_TO_TICKS(x) (x)
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffff
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED {0}
+#define portENTER_CRITICAL(m) (void)(m)
+#define portEXIT_CRITICAL(m) (void)(m)
+#define portENTER_CRITICAL_ISR(m) (void)(m)
+#define portEXIT_CRITICAL_ISR(m) (void)(m)
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char* name, uint32_t stack, void* arg,
+                                   UBaseType_t priority, TaskHandle_t* handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+BaseType_t xPortGetCoreID();
+
+// ===== Управление окружением из тестов =====
+namespace Host {
+    // Виртуальное время: delay() и delayMicroseconds() только сдвигают его
+    void setMicros(uint64_t us);
+    void advanceMicros(uint64_t us);
+
+    // Модель выводов: по умолчанию читается последнее записанное значение,
+    // для INPUT_PULLUP - HIGH. Тест может подменить чтение и следить за записью.
+    extern int (*readHook)(uint8_t pin);
+    extern void (*writeHook)(uint8_t pin, uint8_t value);
+    extern uint16_t analogValues[40];
+
+    // Куча ESP для HeapMonitor
+    extern uint32_t freeHeap;
+    extern uint32_t minFreeHeap;
+    extern uint32_t maxAllocHeap;
+    extern uint32_t heapSize;
+}
+
+#endif
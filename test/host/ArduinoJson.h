@@ -0,0 +1,53 @@
+#ifndef HOST_ARDUINO_JSON_H
+#define HOST_ARDUINO_JSON_H
+
+// Замена ArduinoJson для тестов: документ хранит текст, разбор только
+// проверяет синтаксис (парные скобки, строки). Значения не извлекаются -
+// тесты подменяют код, который их читает.
+
+#include <Arduino.h>
+#include <string>
+
+class JsonVariantConst {
+public:
+    JsonVariantConst() {}
+    explicit JsonVariantConst(const std::string* text) : text(text) {}
+    bool isNull() const { return text == nullptr; }
+    const char* json() const { return text ? text->c_str() : "null"; }
+
+private:
+    const std::string* text = nullptr;
+};
+
+class JsonDocument {
+public:
+    template <class T> T as() const { return T(&text); }
+    void clear() { text.clear(); }
+    void assign(const char* input, size_t length) { text.assign(input, length); }
+
+private:
+    std::string text;
+};
+
+template <size_t CAPACITY>
+class StaticJsonDocument : public JsonDocument {};
+
+class DeserializationError {
+public:
+    enum Code { Ok, EmptyInput, IncompleteInput, InvalidInput };
+
+    DeserializationError(Code code = Ok) : value(code) {}
+    explicit operator bool() const { return value != Ok; }
+    Code code() const { return value; }
+    const char* c_str() const {
+        static const char* const names[] = {"Ok", "EmptyInput", "IncompleteInput", "InvalidInput"};
+        return names[value];
+    }
+
+private:
+    Code value;
+};
+
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length);
+
+#endif
@@ -0,0 +1,7 @@
+#ifndef HOST_EEPROM_H
+#define HOST_EEPROM_H
+
+// Только то, что нужно заголовкам прошивки
+#include <Arduino.h>
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+// Только типы, нужные заголовкам прошивки
+#include <Arduino.h>
+
+struct CRGB {
+    uint8_t r = 0, g = 0, b = 0;
+    CRGB() {}
+    CRGB(uint8_t r, uint8_t g, uint8_t b) : r(r), g(g), b(b) {}
+};
+
+#endif
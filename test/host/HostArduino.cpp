@@ -0,0 +1,62 @@
+#include <Arduino.h>
+#include <Wire.h>
+
+HardwareSerial Serial;
+EspClass ESP;
+TwoWire Wire;
+
+namespace Host {
+    static uint64_t nowUs = 0;
+    static uint8_t pinModes[40] = {};
+    static uint8_t pinLevels[40] = {};
+
+    int (*readHook)(uint8_t pin) = nullptr;
+    void (*writeHook)(uint8_t pin, uint8_t value) = nullptr;
+    uint16_t analogValues[40] = {};
+
+    uint32_t freeHeap = 200000;
+    uint32_t minFreeHeap = 200000;
+    uint32_t maxAllocHeap = 110000;
+    uint32_t heapSize = 320000;
+
+    void setMicros(uint64_t us) { nowUs = us; }
+    void advanceMicros(uint64_t us) { nowUs += us; }
+}
+
+unsigned long millis() { return (unsigned long)(Host::nowUs / 1000); }
+unsigned long micros() { return (unsigned long)Host::nowUs; }
+void delay(unsigned long ms) { Host::nowUs += (uint64_t)ms * 1000; }
+void delayMicroseconds(unsigned us) { Host::nowUs += us; }
+void yield() {}
+
+void pinMode(uint8_t pin, uint8_t mode) {
+    Host::pinModes[pin] = mode;
+    if (mode == INPUT_PULLUP) Host::pinLevels[pin] = HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+    Host::pinLevels[pin] = value;
+    if (Host::writeHook) Host::writeHook(pin, value);
+}
+
+int digitalRead(uint8_t pin) {
+    if (Host::readHook) return Host::readHook(pin);
+    return Host::pinLevels[pin];
+}
+
+uint16_t analogRead(uint8_t pin) { return Host::analogValues[pin]; }
+
+uint32_t EspClass::getFreeHeap() { return Host::freeHeap; }
+uint32_t EspClass::getMinFreeHeap() { return Host::minFreeHeap; }
+uint32_t EspClass::getMaxAllocHeap() { return Host::maxAllocHeap; }
+uint32_t EspClass::getHeapSize() { return Host::heapSize; }
+uint32_t EspClass::getCycleCount() { return (uint32_t)(Host::nowUs * 240); }
+
+BaseType_t xTaskCreatePinnedToCore(void (*)(void*), const char*, uint32_t, void*, UBaseType_t,
+                                   TaskHandle_t*, BaseType_t) {
+    return pdFAIL;
+}
+
+void vTaskDelay(TickType_t ticks) { Host::nowUs += (uint64_t)ticks * 1000; }
+// Однопоточный режим: все идет в loop(), как на ядре 1
+BaseType_t xPortGetCoreID() { return 1; }
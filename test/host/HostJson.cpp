@@ -0,0 +1,34 @@
+#include <ArduinoJson.h>
+
+// Проверка синтаксиса без построения дерева: баланс скобок вне строк
+DeserializationError deserializeJson(JsonDocument& doc, const char* input, size_t length) {
+    doc.clear();
+    size_t start = 0;
+    while (start < length && isspace((unsigned char)input[start])) start++;
+    if (start == length) return DeserializationError::EmptyInput;
+    if (input[start] != '{' && input[start] != '[') return DeserializationError::InvalidInput;
+
+    std::string stack;
+    bool inString = false;
+    for (size_t i = start; i < length; i++) {
+        char c = input[i];
+        if (inString) {
+            if (c == '\\') i++;
+            else if (c == '"') inString = false;
+            continue;
+        }
+        if (c == '"') {
+            inString = true;
+        } else if (c == '{' || c == '[') {
+            stack += c == '{' ? '}' : ']';
+        } else if (c == '}' || c == ']') {
+            if (stack.empty() || stack.back() != c) return DeserializationError::InvalidInput;
+            stack.pop_back();
+            if (stack.empty()) {
+                doc.assign(input + start, i + 1 - start);
+                return DeserializationError::Ok;
+            }
+        }
+    }
+    return DeserializationError::IncompleteInput;
+}
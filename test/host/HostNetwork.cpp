@@ -0,0 +1,155 @@
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include <PubSubClient.h>
+
+WiFiClass WiFi;
+
+namespace Host {
+    wl_status_t wifiStatus = WL_CONNECTED;
+}
+
+bool WiFiUDP::failSend = false;
+
+// Открытые сокеты для доставки пакетов
+static std::vector<WiFiUDP*> sockets;
+
+WiFiUDP::WiFiUDP() { sockets.push_back(this); }
+
+WiFiUDP::~WiFiUDP() { sockets.erase(std::find(sockets.begin(), sockets.end(), this)); }
+
+uint8_t WiFiUDP::begin(uint16_t port) {
+    localPort = port;
+    return 1;
+}
+
+void WiFiUDP::stop() {
+    localPort = 0;
+    received.clear();
+}
+
+int WiFiUDP::beginPacket(IPAddress address, uint16_t port) {
+    if (failSend || Host::wifiStatus != WL_CONNECTED) return 0;
+    outgoing.address = address;
+    outgoing.data.clear();
+    destinationPort = port;
+    composing = true;
+    return 1;
+}
+
+size_t WiFiUDP::write(const uint8_t* data, size_t length) {
+    if (!composing) return 0;
+    outgoing.data.insert(outgoing.data.end(), data, data + length);
+    return length;
+}
+
+int WiFiUDP::endPacket() {
+    if (!composing) return 0;
+    composing = false;
+    lastAddress = outgoing.address;
+    for (WiFiUDP* socket : sockets) {
+        if (socket->localPort == destinationPort) socket->received.push_back(outgoing);
+    }
+    return 1;
+}
+
+int WiFiUDP::parsePacket() {
+    if (received.empty()) return 0;
+    current = received.front();
+    received.pop_front();
+    readOffset = 0;
+    lastAddress = current.address;
+    return (int)current.data.size();
+}
+
+int WiFiUDP::read(uint8_t* buffer, size_t length) {
+    size_t available = current.data.size() - readOffset;
+    if (length > available) length = available;
+    memcpy(buffer, current.data.data() + readOffset, length);
+    readOffset += length;
+    return (int)length;
+}
+
+// ===== Брокер MQTT =====
+namespace Host {
+    HostBroker broker;
+}
+
+void HostBroker::reset() {
+    *this = HostBroker();
+}
+
+void HostBroker::drop() {
+    online = false;
+    if (client && client->status == MQTT_CONNECTED) {
+        client->status = MQTT_CONNECTION_LOST;
+        if (!willTopic.empty()) published.push_back({willTopic, willMessage, true});
+    }
+    subscriptions.clear();
+}
+
+bool HostBroker::deliver(const char* topic, const char* payload) {
+    if (!client || client->status != MQTT_CONNECTED || !client->callback) return false;
+    if (std::find(subscriptions.begin(), subscriptions.end(), topic) == subscriptions.end()) return false;
+
+    // Клиент получает изменяемые копии, как из своего буфера
+    std::string topicCopy = topic;
+    std::string payloadCopy = payload;
+    client->callback(&topicCopy[0], (uint8_t*)&payloadCopy[0], payloadCopy.size());
+    return true;
+}
+
+PubSubClient& PubSubClient::setServer(const char*, uint16_t) {
+    return *this;
+}
+
+PubSubClient& PubSubClient::setCallback(Callback handler) {
+    callback = handler;
+    return *this;
+}
+
+bool PubSubClient::setBufferSize(uint16_t size) {
+    bufferSize = size;
+    return true;
+}
+
+bool PubSubClient::connect(const char* id, const char* willTopic, uint8_t, bool, const char* willMessage) {
+    HostBroker& broker = Host::broker;
+    if (Host::wifiStatus != WL_CONNECTED || !broker.online) {
+        status = MQTT_CONNECT_FAILED;
+        return false;
+    }
+    broker.client = this;
+    broker.clientId = id;
+    broker.willTopic = willTopic;
+    broker.willMessage = willMessage;
+    broker.connects++;
+    status = MQTT_CONNECTED;
+    return true;
+}
+
+void PubSubClient::disconnect() {
+    status = MQTT_DISCONNECTED;
+    Host::broker.subscriptions.clear();
+}
+
+bool PubSubClient::connected() {
+    return status == MQTT_CONNECTED;
+}
+
+bool PubSubClient::publish(const char* topic, const char* payload, bool retained) {
+    return publish(topic, (const uint8_t*)payload, strlen(payload), retained);
+}
+
+bool PubSubClient::publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained) {
+    if (!connected()) return false;
+    // Как в библиотеке: пакет целиком должен поместиться в буфер клиента
+    if (length + strlen(topic) + 5 > bufferSize) return false;
+    Host::broker.published.push_back({topic, std::string((const char*)payload, length), retained});
+    return true;
+}
+
+bool PubSubClient::subscribe(const char* topic) {
+    if (!connected()) return false;
+    Host::broker.subscriptions.push_back(topic);
+    return true;
+}
@@ -0,0 +1,77 @@
+#ifndef HOST_PUBSUB_CLIENT_H
+#define HOST_PUBSUB_CLIENT_H
+
+// PubSubClient поверх брокера-заглушки в памяти. Тест управляет брокером
+// через Host::broker: включает и выключает его, смотрит опубликованное и
+// отправляет сообщения в подписанные топики.
+
+#include <WiFi.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#define MQTT_CONNECTION_LOST -3
+#define MQTT_CONNECT_FAILED -2
+#define MQTT_DISCONNECTED -1
+#define MQTT_CONNECTED 0
+
+class PubSubClient;
+
+struct HostBroker {
+    struct Message {
+        std::string topic;
+        std::string payload;
+        bool retained;
+    };
+
+    bool online = true;             // принимает подключения и публикации
+    std::vector<Message> published;
+    std::vector<std::string> subscriptions;
+    std::string clientId;
+    std::string willTopic;
+    std::string willMessage;
+    uint32_t connects = 0;
+    PubSubClient* client = nullptr;
+
+    void reset();
+    // Обрыв связи со стороны брокера: клиент увидит его в connected()
+    void drop();
+    // Сообщение подписчику; false - клиент не подключен или не подписан
+    bool deliver(const char* topic, const char* payload);
+};
+
+namespace Host {
+    extern HostBroker broker;
+}
+
+class PubSubClient {
+public:
+    using Callback = std::function<void(char*, uint8_t*, unsigned int)>;
+
+    PubSubClient() {}
+    explicit PubSubClient(Client&) {}
+
+    PubSubClient& setServer(const char* host, uint16_t port);
+    PubSubClient& setCallback(Callback callback);
+    bool setBufferSize(uint16_t size);
+    PubSubClient& setSocketTimeout(uint16_t) { return *this; }
+
+    bool connect(const char* id, const char* willTopic, uint8_t willQos, bool willRetain, const char* willMessage);
+    void disconnect();
+    bool connected();
+    int state() const { return status; }
+    bool loop() { return connected(); }
+
+    bool publish(const char* topic, const char* payload, bool retained = false);
+    bool publish(const char* topic, const uint8_t* payload, unsigned int length, bool retained);
+    bool subscribe(const char* topic);
+
+private:
+    friend struct HostBroker;
+
+    Callback callback;
+    uint16_t bufferSize = 256;
+    int status = MQTT_DISCONNECTED;
+};
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef HOST_TM1637_DISPLAY_H
+#define HOST_TM1637_DISPLAY_H
+
+// Только то, что нужно заголовкам прошивки
+#include <Arduino.h>
+
+class TM1637Display {
+public:
+    TM1637Display(uint8_t, uint8_t, unsigned = 100) {}
+};
+
+#endif
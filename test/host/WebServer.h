@@ -0,0 +1,12 @@
+#ifndef HOST_WEB_SERVER_H
+#define HOST_WEB_SERVER_H
+
+// Только объявление: заголовки прошивки хранят ссылку на сервер
+#include <WiFi.h>
+
+class WebServer {
+public:
+    explicit WebServer(int) {}
+};
+
+#endif
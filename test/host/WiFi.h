@@ -0,0 +1,30 @@
+#ifndef HOST_WIFI_H
+#define HOST_WIFI_H
+
+// Замена WiFi для тестов: состояние подключения задает тест через Host::wifiStatus
+
+#include <Arduino.h>
+
+enum wl_status_t { WL_IDLE_STATUS = 0, WL_CONNECTED = 3, WL_CONNECTION_LOST = 5, WL_DISCONNECTED = 6 };
+
+namespace Host {
+    extern wl_status_t wifiStatus;
+}
+
+class WiFiClass {
+public:
+    wl_status_t status() { return Host::wifiStatus; }
+    IPAddress localIP() { return IPAddress(192, 168, 1, 50); }
+    int RSSI() { return -60; }
+};
+extern WiFiClass WiFi;
+
+class Client : public Stream {
+public:
+    virtual bool connected() { return Host::wifiStatus == WL_CONNECTED; }
+    virtual void stop() {}
+};
+
+class WiFiClient : public Client {};
+
+#endif
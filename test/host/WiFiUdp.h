@@ -0,0 +1,48 @@
+#ifndef HOST_WIFI_UDP_H
+#define HOST_WIFI_UDP_H
+
+// UDP через петлю в памяти: отправленный пакет получает каждый сокет,
+// открытый через begin() на порту назначения. Адрес (в том числе
+// широковещательный) запоминается для проверки, но не фильтрует доставку.
+
+#include <WiFi.h>
+#include <deque>
+#include <vector>
+
+class WiFiUDP : public Stream {
+public:
+    WiFiUDP();
+    ~WiFiUDP();
+
+    uint8_t begin(uint16_t port);
+    void stop();
+
+    int beginPacket(IPAddress address, uint16_t port);
+    size_t write(const uint8_t* data, size_t length) override;
+    int endPacket();
+
+    // Размер следующего принятого пакета, 0 - очередь пуста
+    int parsePacket();
+    int read(uint8_t* buffer, size_t length);
+    IPAddress remoteIP() const { return lastAddress; }
+
+    // Отказ отправки для проверки счетчика ошибок
+    static bool failSend;
+
+private:
+    struct Packet {
+        IPAddress address;
+        std::vector<uint8_t> data;
+    };
+
+    uint16_t localPort = 0;
+    uint16_t destinationPort = 0;
+    IPAddress lastAddress;
+    bool composing = false;
+    Packet outgoing;
+    std::deque<Packet> received;
+    Packet current;
+    size_t readOffset = 0;
+};
+
+#endif
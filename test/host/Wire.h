@@ -0,0 +1,45 @@
+#ifndef HOST_WIRE_H
+#define HOST_WIRE_H
+
+#include <Arduino.h>
+
+// Сценарная шина I2C: тест задает коды endTransmission и число байт ответа,
+// а также ведет счет перезапусков шины.
+class TwoWire : public Stream {
+public:
+    bool begin(int sda, int scl, uint32_t frequency = 0) { beginCount++; return true; }
+    bool end() { endCount++; return true; }
+    void setTimeOut(uint16_t timeout) { timeoutMs = timeout; }
+
+    void beginTransmission(uint8_t address) { lastAddress = address; }
+    uint8_t endTransmission(bool stop = true) {
+        return transmissionError ? transmissionError(lastAddress) : 0;
+    }
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t*, size_t length) override { return length; }
+    uint8_t requestFrom(uint8_t address, uint8_t length) {
+        lastAddress = address;
+        if (requestDelayUs) Host::advanceMicros(requestDelayUs);
+        responseIndex = 0;
+        return responseLength < 0 ? length : (uint8_t)responseLength;
+    }
+    int read() { return responseIndex < sizeof(response) ? response[responseIndex++] : 0; }
+
+    // Сценарий
+    uint8_t (*transmissionError)(uint8_t address) = nullptr;  // nullptr - всегда 0 (OK)
+    int responseLength = -1;        // -1 - сколько запрошено
+    uint32_t requestDelayUs = 0;
+    uint8_t response[32] = {};
+
+    uint32_t beginCount = 0;
+    uint32_t endCount = 0;
+    uint16_t timeoutMs = 0;
+    uint8_t lastAddress = 0;
+
+private:
+    size_t responseIndex = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
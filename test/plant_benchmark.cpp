@@ -0,0 +1,99 @@
+// Прогон автоматики на модели теплицы по всем погодным профилям. Каждый
+// шаг повторяет цикл устройства: опрос датчиков, SensorFusion, Automation,
+// затем модель идет STEP_MS вперед. Качество считается по истинному
+// состоянию модели: доля времени в полосе вокруг уставок, энергия, вода и
+// число включений реле. Уставки - по умолчанию из SystemSettings.
+//   plant_benchmark [дней]
+#include <chrono>
+#include <cstdlib>
+#include "Automation.h"
+#include "DeviceNames.h"
+#include "PlantSimulator.h"
+
+static constexpr unsigned long STEP_MS = 30000;    // шаг модели - период опроса датчиков
+static constexpr uint16_t DEFAULT_DAYS = 365;
+// Полосы качества вокруг уставок
+static constexpr float TEMP_BAND = 2.0;            // °C
+static constexpr float HUMIDITY_BAND = 10.0;       // %
+static constexpr float SOIL_BAND = 10.0;           // %
+
+struct Result {
+    uint32_t steps = 0;
+    uint32_t inTemperatureBand = 0;
+    uint32_t inHumidityBand = 0;
+    uint32_t inSoilBand = 0;
+    float minTemperature = 0;
+    float maxTemperature = 0;
+    double elapsedSeconds = 0;
+};
+
+static Result run(const WeatherProfile& profile, const SystemSettings& settings, uint32_t steps,
+                  PlantSimulator& simulator) {
+    simulator.begin(profile, settings);
+    SensorFusion fusion;
+    fusion.setLogging(false);
+    Automation automation(fusion);
+    automation.setLogging(false);
+    SensorData data;
+
+    Result result;
+    result.minTemperature = result.maxTemperature = simulator.getAirTemperature();
+    auto start = std::chrono::steady_clock::now();
+    for (; result.steps < steps; result.steps++) {
+        // Тот же порядок, что в цикле управления: датчики, фильтрация, автоматика
+        unsigned long now = (unsigned long)simulator.getTimeMs();
+        simulator.readSensors(data);
+        fusion.process(data, now, true, true, true);
+        automation.process(data, settings, simulator, now);
+        simulator.step(STEP_MS);
+
+        float temperature = simulator.getAirTemperature();
+        if (fabsf(temperature - settings.tempSetpoint) <= TEMP_BAND) result.inTemperatureBand++;
+        if (fabsf(simulator.getAirHumidity() - settings.humSetpoint) <= HUMIDITY_BAND) result.inHumidityBand++;
+        if (fabsf(simulator.getSoilMoisture() - settings.soilMoistureSetpoint) <= SOIL_BAND) result.inSoilBand++;
+        if (temperature < result.minTemperature) result.minTemperature = temperature;
+        if (temperature > result.maxTemperature) result.maxTemperature = temperature;
+    }
+    result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+static float percent(uint32_t count, uint32_t total) {
+    return total ? count * 100.0f / total : 0;
+}
+
+int main(int argc, char** argv) {
+    long days = argc > 1 ? strtol(argv[1], nullptr, 10) : DEFAULT_DAYS;
+    if (days <= 0) {
+        fprintf(stderr, "usage: %s [days]\n", argv[0]);
+        return 2;
+    }
+    SystemSettings settings;
+    // Прогон проверяет автоматику независимо от сохраненного флага
+    settings.automationEnabled = true;
+    uint32_t steps = (uint32_t)((uint64_t)days * Constants::ENERGY_DAY_MS / STEP_MS);
+    printf("%ld days, step %lu s, setpoints %.1f C %.0f%% soil %.0f%%\n", days, STEP_MS / 1000,
+           settings.tempSetpoint, settings.humSetpoint, settings.soilMoistureSetpoint);
+    printf("%-12s %6s %6s %6s %6s %6s %8s %8s", "profile", "temp%", "hum%", "soil%", "min C", "max C",
+           "kWh", "water l");
+    for (uint8_t i = 0; i < PlantSimulator::DEVICE_COUNT; i++) printf(" %7s", DeviceNames::name((ControlDevice)i));
+    printf(" %9s\n", "speedup");
+
+    static PlantSimulator simulator;
+    for (const WeatherProfile& profile : PlantSimulator::PROFILES) {
+        Result result = run(profile, settings, steps, simulator);
+        const PlantSimulator::Totals& totals = simulator.getTotals();
+        uint64_t totalWms = 0;
+        for (uint64_t energy : totals.energyWms) totalWms += energy;
+
+        printf("%-12s %6.1f %6.1f %6.1f %6.1f %6.1f %8.1f %8.1f", profile.name,
+               percent(result.inTemperatureBand, result.steps), percent(result.inHumidityBand, result.steps),
+               percent(result.inSoilBand, result.steps), result.minTemperature, result.maxTemperature,
+               totalWms / 3.6e9, totals.waterUl / 1e6);
+        // Включения реле по выходам
+        for (uint32_t cycles : totals.cycles) printf(" %7u", cycles);
+        // Ускорение относительно моделируемого времени
+        printf(" %8.0fx\n", result.elapsedSeconds > 0 ? result.steps * (STEP_MS / 1000.0) / result.elapsedSeconds : 0);
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+// Журнал выходов: включения считаются по переходам выкл -> вкл,
+// смена яркости включенного выхода - только событие в журнале.
+#include "ActuatorHistory.h"
+#include "TestSupport.h"
+
+static void testBrightnessIsNotASwitch() {
+    ActuatorHistory history;
+    Host::setMicros(0);
+    CHECK(history.record(ControlDevice::LIGHT, 0, false, ControlCause::SYSTEM));
+    CHECK(history.record(ControlDevice::LIGHT, 128, true, ControlCause::HTTP));
+    Host::advanceMicros(1000000);
+    CHECK(history.record(ControlDevice::LIGHT, 200, true, ControlCause::HTTP));
+    CHECK(history.record(ControlDevice::LIGHT, 60, true, ControlCause::MQTT));
+    CHECK(!history.record(ControlDevice::LIGHT, 60, true, ControlCause::MQTT));
+    CHECK_EQ(history.getSwitchCount(ControlDevice::LIGHT), 1);
+    CHECK_EQ(history.getEventCount(), 4);
+
+    Host::advanceMicros(1000000);
+    CHECK(history.record(ControlDevice::LIGHT, 0, false, ControlCause::AUTOMATION));
+    CHECK(history.record(ControlDevice::LIGHT, 255, true, ControlCause::AUTOMATION));
+    CHECK_EQ(history.getSwitchCount(ControlDevice::LIGHT), 2);
+    CHECK_EQ(history.getOnTimeMs(ControlDevice::LIGHT), 2000);
+}
+
+static void testRelayCycles() {
+    ActuatorHistory history;
+    CHECK(history.record(ControlDevice::PUMP, 0, false, ControlCause::SYSTEM));
+    for (int i = 0; i < 3; i++) {
+        CHECK(history.record(ControlDevice::PUMP, 1, true, ControlCause::AUTOMATION));
+        CHECK(history.record(ControlDevice::PUMP, 0, false, ControlCause::TIMER));
+    }
+    CHECK_EQ(history.getSwitchCount(ControlDevice::PUMP), 3);
+    CHECK_EQ(history.getSwitchCount(ControlDevice::FAN), 0);
+
+    // Выход, включенный уже при первой записи, - одно включение
+    CHECK(history.record(ControlDevice::FAN, 1, true, ControlCause::SYSTEM));
+    CHECK_EQ(history.getSwitchCount(ControlDevice::FAN), 1);
+}
+
+int main() {
+    testBrightnessIsNotASwitch();
+    testRelayCycles();
+    return TEST_RESULT();
+}
@@ -0,0 +1,102 @@
+// Горячие пути без кучи: имена устройств, ответы и журнал не выделяют память
+#include "TestSupport.h"
+#include "Config.h"
+#include "DeviceNames.h"
+#include "Logger.h"
+
+// Счетчик выделений поверх malloc glibc: new тоже идет через malloc
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t count, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+
+static bool counting = false;
+static unsigned allocations = 0;
+
+extern "C" void* malloc(size_t size) {
+    if (counting) allocations++;
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(size_t count, size_t size) {
+    if (counting) allocations++;
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* ptr, size_t size) {
+    if (counting) allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+static void beginCounting() {
+    allocations = 0;
+    counting = true;
+}
+
+static unsigned endCounting() {
+    counting = false;
+    return allocations;
+}
+
+// Разбор имени устройства из аргумента запроса и ответ, как в обработчике /api/control
+static void handleControlRequest(const char* argument, int value, FixedString<64>& message) {
+    StringView name(argument, strlen(argument));
+    ControlDevice device = DeviceNames::parse(name);
+    message.clear();
+    if (device == ControlDevice::UNKNOWN) {
+        message = "Unknown device: ";
+        message += name;
+        return;
+    }
+    message.appendf("Control command executed: %s %d", DeviceNames::name(device), value);
+    LOG_INFO("Control: %s -> %d", DeviceNames::name(device), value);
+}
+
+static void testControlRequest() {
+    FixedString<64> message;
+    const char* names[] = {"pump", "fan", "heater", "light", "door", "valve"};
+
+    // Первый вызов прогревает буферы stdio, он не учитывается
+    handleControlRequest("pump", 1, message);
+
+    beginCounting();
+    for (int round = 0; round < 100; round++) {
+        for (const char* name : names) handleControlRequest(name, round, message);
+    }
+    CHECK_EQ(endCounting(), 0);
+    CHECK(message == StringView("Unknown device: valve"));
+}
+
+static void testStatusFormatting() {
+    SensorData data;
+    FixedString<96> text;
+    text.appendf("warm-up %.1f", 1.0);
+
+    beginCounting();
+    for (int i = 0; i < 100; i++) {
+        data.lastError = "BME280 read error";
+        text.clear();
+        text.appendf("Air: %.1fC %.1f%%, Soil: %.1f%%", 21.5, 55.0, 40.25);
+        text += ' ';
+        text += data.lastError;
+        LOG_WARN("⚠️ %s", text.c_str());
+    }
+    CHECK_EQ(endCounting(), 0);
+    CHECK(text == StringView("Air: 21.5C 55.0%, Soil: 40.2% BME280 read error") ||
+          text == StringView("Air: 21.5C 55.0%, Soil: 40.3% BME280 read error"));
+}
+
+static void testTruncation() {
+    beginCounting();
+    FixedString<8> small("greenhouse");
+    small.appendf("%d", 12345);
+    CHECK_EQ(endCounting(), 0);
+    CHECK(small.full());
+    CHECK(small == StringView("greenhou"));
+}
+
+int main() {
+    testControlRequest();
+    testStatusFormatting();
+    testTruncation();
+    return TEST_RESULT();
+}
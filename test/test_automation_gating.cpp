@@ -0,0 +1,106 @@
+// Достоверность каналов и автоматика: расхождение воздуха и почвы
+// опускает оба канала ниже порога, а недостоверная температура
+// выключает обогрев и вентиляцию вместо того, чтобы оставить их как есть.
+#include "Automation.h"
+#include "TestSupport.h"
+
+class Outputs : public Actuators {
+public:
+    void controlPump(bool state, ControlCause, unsigned long) override { pump = state; }
+    void controlFan(bool state, ControlCause) override { fan = state; }
+    void controlHeater(bool state, ControlCause) override { heater = state; }
+    void controlLight(bool state, ControlCause) override { light = state; }
+
+    bool pump = false, fan = false, heater = false, light = false;
+};
+
+static SensorData reading(float air, float soil) {
+    SensorData data;
+    data.airTemperature = Temperature::fromFloat(air);
+    data.airHumidity = Percent::fromFloat(60);
+    data.pressure = Pressure::fromFloat(1013);
+    data.soilTemperature = Temperature::fromFloat(soil);
+    data.soilMoisture = Percent::fromFloat(50);
+    data.lightLevel = Illuminance::fromFloat(1000);
+    return data;
+}
+
+struct Loop {
+    SensorFusion fusion;
+    Automation automation{fusion};
+    SystemSettings settings;
+    Outputs outputs;
+    unsigned long now = 0;
+
+    Loop() {
+        fusion.setLogging(false);
+        automation.setLogging(false);
+    }
+
+    void step(float air, float soil) {
+        SensorData data = reading(air, soil);
+        fusion.process(data, now, true, true, true);
+        automation.process(data, settings, outputs, now);
+        now += 30000;
+    }
+};
+
+static void testCrossCheckDropsBelowThreshold() {
+    Loop loop;
+    for (int i = 0; i < 20; i++) loop.step(20, 18);
+    CHECK_EQ(loop.fusion.getConfidence(SensorChannel::AIR_TEMPERATURE), 100);
+    CHECK(!loop.fusion.isCrossCheckFailed());
+
+    // Почва медленно уходит на 30 °C от воздуха: отсчеты правдоподобны,
+    // фильтр их принимает, но вместе с воздухом они невозможны
+    float soil = 18;
+    while (soil > -12) {
+        soil -= 0.4f;
+        loop.step(20, soil);
+    }
+    CHECK(loop.fusion.isCrossCheckFailed());
+    CHECK(loop.fusion.getConfidence(SensorChannel::AIR_TEMPERATURE) < Constants::FUSION_MIN_CONFIDENCE);
+    CHECK(loop.fusion.getConfidence(SensorChannel::SOIL_TEMPERATURE) < Constants::FUSION_MIN_CONFIDENCE);
+    CHECK_EQ(loop.fusion.getConfidence(SensorChannel::AIR_HUMIDITY), 100);
+}
+
+static void testUntrustedTemperatureFailsSafe() {
+    Loop loop;
+    for (int i = 0; i < 20; i++) loop.step(18, 18);
+    CHECK(loop.outputs.heater);
+    CHECK(!loop.outputs.fan);
+
+    for (float soil = 18; soil > -12; soil -= 0.4f) loop.step(18, soil);
+    CHECK(loop.fusion.isCrossCheckFailed());
+    CHECK(!loop.outputs.heater);
+    CHECK(!loop.outputs.fan);
+
+    // Каналы снова сходятся - регулирование возобновляется
+    for (float soil = -12; soil < 18; soil += 0.4f) loop.step(18, soil);
+    CHECK(!loop.fusion.isCrossCheckFailed());
+    CHECK(loop.outputs.heater);
+}
+
+static void testMissingTemperatureFailsSafe() {
+    Loop loop;
+    for (int i = 0; i < 20; i++) loop.step(32, 30);
+    CHECK(loop.outputs.fan);
+
+    // Датчик воздуха пропал: отсчеты не приходят, доверие падает до нуля
+    for (int i = 0; i < 3; i++) {
+        SensorData data = reading(32, 30);
+        loop.fusion.process(data, loop.now, false, true, true);
+        loop.automation.process(data, loop.settings, loop.outputs, loop.now);
+        loop.now += 30000;
+    }
+    CHECK_EQ(loop.fusion.getConfidence(SensorChannel::AIR_TEMPERATURE), 0);
+    CHECK(!loop.outputs.fan);
+    CHECK(!loop.outputs.heater);
+}
+
+int main() {
+    testCrossCheckDropsBelowThreshold();
+    testUntrustedTemperatureFailsSafe();
+    testMissingTemperatureFailsSafe();
+    return TEST_RESULT();
+}
@@ -0,0 +1,146 @@
+// Длительный прогон HeapMonitor: месяцы работы за секунды. Куча ESP
+// заменена моделью first-fit со слиянием свободных блоков; нагрузка -
+// опрос датчиков и HTTP-запросы с теми же размерами буферов, что на
+// устройстве. Стабильная нагрузка не должна давать тренда наибольшего
+// блока, а медленная утечка в середине кучи должна обнаруживаться.
+#include <map>
+#include <vector>
+#include "HeapMonitor.h"
+#include "TestSupport.h"
+
+class ArenaHeap {
+public:
+    explicit ArenaHeap(uint32_t size) { freeBlocks[0] = size; publish(); }
+
+    uint32_t allocate(uint32_t size) {
+        size = (size + 7) & ~7U;
+        for (auto it = freeBlocks.begin(); it != freeBlocks.end(); ++it) {
+            if (it->second < size) continue;
+            uint32_t offset = it->first;
+            uint32_t rest = it->second - size;
+            freeBlocks.erase(it);
+            if (rest > 0) freeBlocks[offset + size] = rest;
+            publish();
+            return offset;
+        }
+        return UINT32_MAX;
+    }
+
+    void release(uint32_t offset, uint32_t size) {
+        size = (size + 7) & ~7U;
+        auto next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            next = freeBlocks.erase(next);
+        }
+        if (next != freeBlocks.begin()) {
+            auto previous = std::prev(next);
+            if (previous->first + previous->second == offset) {
+                previous->second += size;
+                publish();
+                return;
+            }
+        }
+        freeBlocks[offset] = size;
+        publish();
+    }
+
+private:
+    // Модель кучи публикует свое состояние туда, откуда его читает ESP
+    void publish() {
+        uint32_t total = 0, largest = 0;
+        for (const auto& block : freeBlocks) {
+            total += block.second;
+            if (block.second > largest) largest = block.second;
+        }
+        Host::freeHeap = total;
+        Host::maxAllocHeap = largest;
+        if (total < Host::minFreeHeap) Host::minFreeHeap = total;
+    }
+
+    std::map<uint32_t, uint32_t> freeBlocks;   // смещение -> размер
+};
+
+static constexpr uint32_t ARENA_SIZE = 160000;
+static constexpr uint32_t SENSOR_CYCLES_PER_MINUTE = 30;    // опрос раз в 2 с
+static constexpr uint32_t HTTP_REQUESTS_PER_MINUTE = 6;
+
+struct Soak {
+    ArenaHeap heap{ARENA_SIZE};
+    HeapMonitor monitor;
+    std::vector<uint32_t> leaked;
+    uint32_t requests = 0;
+    bool warned = false;
+
+    Soak() {
+        Host::setMicros(0);
+        Host::minFreeHeap = ARENA_SIZE;
+        // Долгоживущие объекты, созданные при старте
+        heap.allocate(24000);
+        heap.allocate(8000);
+        heap.allocate(3000);
+    }
+
+    void sensorCycle() {
+        HEAP_SCOPE(SENSORS);
+        uint32_t frame = heap.allocate(96);
+        uint32_t scratch = heap.allocate(256);
+        heap.release(scratch, 256);
+        heap.release(frame, 96);
+    }
+
+    // leakEvery > 0 - каждый такой запрос оставляет за собой 48 байт,
+    // которые ложатся в дыру посреди кучи и дробят ее
+    void httpRequest(uint32_t leakEvery) {
+        HEAP_SCOPE(HTTP);
+        uint32_t client = heap.allocate(1600);
+        uint32_t json = heap.allocate(4096);
+        uint32_t response = heap.allocate(2048);
+        heap.release(json, 4096);
+        if (leakEvery && ++requests % leakEvery == 0) leaked.push_back(heap.allocate(48));
+        heap.release(response, 2048);
+        heap.release(client, 1600);
+    }
+
+    void runMinutes(uint32_t minutes, uint32_t leakEvery) {
+        for (uint32_t minute = 0; minute < minutes; minute++) {
+            for (uint32_t i = 0; i < SENSOR_CYCLES_PER_MINUTE; i++) sensorCycle();
+            for (uint32_t i = 0; i < HTTP_REQUESTS_PER_MINUTE; i++) httpRequest(leakEvery);
+            Host::advanceMicros(60000000ULL);
+            monitor.update();
+            if (monitor.isFragmenting()) warned = true;
+        }
+    }
+
+    void runDays(uint32_t days, uint32_t leakEvery) { runMinutes(days * 1440, leakEvery); }
+};
+
+static void testStableLoadOverMonths() {
+    Soak soak;
+    soak.runDays(120, 0);
+
+    CHECK(!soak.warned);
+    CHECK_EQ(soak.monitor.getSampleCount(), HeapMonitor::SAMPLE_COUNT);
+    CHECK(soak.monitor.largestBlockTrend() > -1.0F);
+    CHECK_EQ(soak.monitor.getMinLargestBlock(), soak.monitor.latest().largestBlock);
+    CHECK_EQ(heapMonitor.getStats(HeapSubsystem::SENSORS).retainedBytes, 0);
+    CHECK_EQ(heapMonitor.getStats(HeapSubsystem::HTTP).retainedBytes, 0);
+}
+
+static void testSlowLeakIsDetected() {
+    // 6 запросов в минуту, утечка в каждом 40-м: ~430 байт в час
+    Soak soak;
+    soak.runMinutes(1400, 40);
+    CHECK(!soak.warned);    // сутки - минимальное окно для решения
+
+    soak.runDays(3, 40);
+    CHECK(soak.warned);
+    CHECK(soak.monitor.isFragmenting());
+    CHECK(soak.monitor.largestBlockTrend() < -Constants::HEAP_TREND_WARN);
+}
+
+int main() {
+    testStableLoadOverMonths();
+    testSlowLeakIsDetected();
+    return TEST_RESULT();
+}
@@ -0,0 +1,209 @@
+// Восстановление залипшей шины и классификация ошибок I2CBus
+#include "TestSupport.h"
+#include "I2CBus.h"
+#include <Wire.h>
+
+I2CBus i2cBus;
+
+// Ведомый держит SDA, пока не получит заданное число тактов SCL
+static int stuckPulses = 0;
+static uint8_t sclLevel = HIGH;
+static uint8_t transmissionCode = 0;
+
+static int readPin(uint8_t pin) {
+    if (pin == Pins::I2C_SDA) return stuckPulses > 0 ? LOW : HIGH;
+    return HIGH;
+}
+
+static void writePin(uint8_t pin, uint8_t value) {
+    if (pin == Pins::I2C_SCL) {
+        if (sclLevel == LOW && value == HIGH && stuckPulses > 0) stuckPulses--;
+        sclLevel = value;
+    }
+}
+
+static uint8_t transmission(uint8_t address) { return transmissionCode; }
+
+static const I2CBus::AddressStats* statsOf(uint8_t address) {
+    for (uint8_t i = 0; i < i2cBus.getStatsCount(); i++) {
+        if (i2cBus.getStats(i).address == address) return &i2cBus.getStats(i);
+    }
+    return nullptr;
+}
+
+static void reset() {
+    i2cBus = I2CBus();
+    Wire = TwoWire();
+    Wire.transmissionError = transmission;
+    transmissionCode = 0;
+    stuckPulses = 0;
+    sclLevel = HIGH;
+}
+
+static void testStuckBusRecovered() {
+    reset();
+    i2cBus.begin();
+    uint32_t begins = Wire.beginCount;
+
+    // Таймаут записи при SDA, прижатом ведомым на 4 такта
+    transmissionCode = 5;
+    stuckPulses = 4;
+    uint8_t data[1] = {0};
+    CHECK(!i2cBus.write(0x76, data, 1));
+
+    CHECK_EQ(stuckPulses, 0);
+    CHECK_EQ(i2cBus.getStuckCount(), 1);
+    CHECK_EQ(i2cBus.getRecoveryCount(), 1);
+    CHECK_EQ(i2cBus.getTimeoutCount(), 1);
+    CHECK_EQ(Wire.endCount, 1);
+    CHECK_EQ(Wire.beginCount, begins + 1);
+    const I2CBus::AddressStats* stats = statsOf(0x76);
+    CHECK(stats != nullptr);
+    if (stats) CHECK_EQ(stats->timeoutCount, 1);
+
+    // После восстановления шина снова работает
+    transmissionCode = 0;
+    CHECK(i2cBus.write(0x76, data, 1));
+}
+
+static void testStuckBusAtBoot() {
+    reset();
+    stuckPulses = 2;
+    i2cBus.begin();
+    CHECK_EQ(stuckPulses, 0);
+    CHECK_EQ(i2cBus.getStuckCount(), 1);
+    CHECK_EQ(i2cBus.getRecoveryCount(), 1);
+}
+
+static void testPermanentlyStuckBus() {
+    reset();
+    i2cBus.begin();
+
+    // Девяти тактов не хватает: шина все равно перезапускается
+    transmissionCode = 4;
+    stuckPulses = 100;
+    uint8_t data[1] = {0};
+    CHECK(!i2cBus.write(0x23, data, 1));
+    CHECK_EQ(stuckPulses, 91);
+    CHECK_EQ(i2cBus.getStuckCount(), 1);
+    CHECK_EQ(i2cBus.getRecoveryCount(), 1);
+    CHECK_EQ(Wire.endCount, 1);
+    const I2CBus::AddressStats* stats = statsOf(0x23);
+    if (stats) CHECK_EQ(stats->errorCount, 1);
+}
+
+// Драйвер ждет таймаут, пока ведомый держит SDA
+static uint8_t stuckTransmission(uint8_t address) {
+    Host::advanceMicros((uint64_t)Wire.timeoutMs * 1000);
+    return 5;
+}
+
+static void testStuckBusKeepsLoopResponsive() {
+    reset();
+    i2cBus.begin();
+
+    // Ведомый не отпускает SDA никогда: каждый цикл опроса обоих датчиков
+    // упирается в таймаут, но не дольше таймаута и восстановления
+    Wire.transmissionError = stuckTransmission;
+    stuckPulses = 1000000;
+    const unsigned long recoveryUs = 200;   // проба SDA, 9 тактов и STOP
+    const unsigned long transactionBoundUs = (unsigned long)Constants::I2C_DEFAULT_TIMEOUT_MS * 1000 + recoveryUs;
+    const uint8_t addresses[] = {0x76, 0x23};
+    const uint8_t cycles = 5;
+    uint8_t command[1] = {0};
+    uint8_t buffer[2];
+    for (uint8_t cycle = 0; cycle < cycles; cycle++) {
+        unsigned long cycleStart = micros();
+        for (uint8_t address : addresses) {
+            unsigned long start = micros();
+            CHECK(!i2cBus.writeRead(address, command, 1, buffer, 2));
+            CHECK(micros() - start <= transactionBoundUs);
+        }
+        CHECK(micros() - cycleStart <= Constants::CONTROL_WORST_CYCLE_MS * 1000);
+    }
+
+    // Восстановление на каждом отказе, без накопления задержки
+    CHECK_EQ(i2cBus.getTimeoutCount(), cycles * 2);
+    CHECK_EQ(i2cBus.getRecoveryCount(), cycles * 2);
+    CHECK_EQ(Wire.endCount, cycles * 2);
+}
+
+static void testDataErrorKeepsBus() {
+    reset();
+    i2cBus.begin();
+
+    // Устройство отвечает, но драйвер отверг данные (CRC, NaN)
+    {
+        I2CBus::Transaction transaction(i2cBus, 0x44);
+        transaction.finish(false);
+    }
+    CHECK_EQ(Wire.endCount, 0);
+    CHECK_EQ(i2cBus.getRecoveryCount(), 0);
+    const I2CBus::AddressStats* stats = statsOf(0x44);
+    CHECK(stats != nullptr);
+    if (stats) {
+        CHECK_EQ(stats->dataErrorCount, 1);
+        CHECK_EQ(stats->errorCount, 0);
+    }
+}
+
+static void testNestedFailureRecoveredOnce() {
+    reset();
+    i2cBus.begin();
+
+    // Вложенное чтение упирается в таймаут: восстановление только в нем
+    Wire.responseLength = 0;
+    Wire.requestDelayUs = (uint32_t)Constants::I2C_DEFAULT_TIMEOUT_MS * 1000;
+    {
+        I2CBus::Transaction transaction(i2cBus, 0x76);
+        uint8_t buffer[2];
+        CHECK(!i2cBus.read(0x76, buffer, 2));
+        transaction.finish(false);
+    }
+    CHECK_EQ(Wire.endCount, 1);
+    CHECK_EQ(i2cBus.getTimeoutCount(), 1);
+    const I2CBus::AddressStats* stats = statsOf(0x76);
+    if (stats) {
+        CHECK_EQ(stats->timeoutCount, 1);
+        CHECK_EQ(stats->dataErrorCount, 0);
+        CHECK_EQ(stats->okCount + stats->errorCount, 0);
+    }
+}
+
+static void testSilentDeviceClassifiedByProbe() {
+    reset();
+    i2cBus.begin();
+
+    // Библиотечный драйвер не прошел, устройство не отвечает на адрес
+    transmissionCode = 2;
+    {
+        I2CBus::Transaction transaction(i2cBus, 0x23);
+        transaction.finish(false);
+    }
+    CHECK_EQ(Wire.endCount, 0);
+    const I2CBus::AddressStats* stats = statsOf(0x23);
+    if (stats) CHECK_EQ(stats->errorCount, 1);
+
+    // Таймаут на пробе - одно восстановление
+    transmissionCode = 5;
+    {
+        I2CBus::Transaction transaction(i2cBus, 0x23);
+        transaction.finish(false);
+    }
+    CHECK_EQ(Wire.endCount, 1);
+    if (stats) CHECK_EQ(stats->timeoutCount, 1);
+}
+
+int main() {
+    Host::readHook = readPin;
+    Host::writeHook = writePin;
+
+    testStuckBusRecovered();
+    testStuckBusAtBoot();
+    testPermanentlyStuckBus();
+    testStuckBusKeepsLoopResponsive();
+    testDataErrorKeepsBus();
+    testNestedFailureRecoveredOnce();
+    testSilentDeviceClassifiedByProbe();
+    return TEST_RESULT();
+}
@@ -0,0 +1,199 @@
+// MqttClient против брокера-заглушки: очередь без связи, пауза между
+// попытками подключения, порционная отправка, тревоги и ответы на команды.
+// Обработка команд, тревоги и выходы подменены здесь же - тест проверяет
+// только транспорт и формат ответов.
+#include "ControlStatus.h"
+#include "GlobalInstances.h"
+#include "TestSupport.h"
+
+SystemSettings systemSettings;
+SensorData sensorView;
+ControlStatus statusView;
+MqttClient mqttClient;
+WebInterface webInterface;
+DeviceManager deviceManager;
+AlarmEngine alarmEngine;
+PowerManager powerManager;
+
+// ===== Подмены =====
+static int controlCode = 200;
+static const char* controlMessage = "OK";
+static int controlCalls = 0;
+static AlarmEngine::Listener alarmListener = nullptr;
+
+int WebInterface::executeControl(JsonVariantConst doc, FixedString<64>& message, ControlCause cause) {
+    controlCalls++;
+    CHECK(cause == ControlCause::MQTT);
+    message = controlMessage;
+    return controlCode;
+}
+
+int WebInterface::applySettings(JsonVariantConst doc, FixedString<64>& message) {
+    message = "Settings updated successfully";
+    return 200;
+}
+
+bool AlarmEngine::addListener(Listener listener) {
+    alarmListener = listener;
+    return true;
+}
+
+void AlarmEngine::name(uint8_t id, Name& out) {
+    out.clear();
+    out.appendf("alarm%u", id);
+}
+
+const char* AlarmEngine::stateName(AlarmState state) { return "active"; }
+
+DeviceManager::DeviceManager() {}
+void DeviceManager::controlPump(bool state, ControlCause cause, unsigned long duration) {}
+void DeviceManager::controlFan(bool state, ControlCause cause) {}
+void DeviceManager::controlHeater(bool state, ControlCause cause) {}
+void DeviceManager::controlLight(bool state, ControlCause cause) {}
+
+static const DeviceManager::ControlChannel TEST_CHANNELS[] = {
+    {ControlDevice::PUMP, 0, DeviceManager::ChannelType::SWITCH, 0, 1, 0, nullptr},
+    {ControlDevice::FAN, 0, DeviceManager::ChannelType::SWITCH, 0, 1, 0, nullptr},
+};
+
+uint8_t DeviceManager::getChannelCount() { return 2; }
+const DeviceManager::ControlChannel& DeviceManager::getChannel(uint8_t index) { return TEST_CHANNELS[index]; }
+
+// ===== Проверки =====
+static std::string topic(const char* suffix) {
+    return std::string("greenhouse/C3D4E5F6/") + suffix;
+}
+
+static size_t countTopic(const char* suffix) {
+    size_t count = 0;
+    for (const HostBroker::Message& message : Host::broker.published) {
+        if (message.topic == topic(suffix)) count++;
+    }
+    return count;
+}
+
+static void advanceMs(unsigned long ms) { Host::advanceMicros((uint64_t)ms * 1000); }
+
+static void testOfflineQueueAndReconnect() {
+    Host::broker.online = false;
+    // Первая попытка сразу, затем пауза удваивается: 5, 10, 20, 40, 80 с
+    mqttClient.update();
+    CHECK_EQ(mqttClient.getQueuedCount(), 2);   // датчики и выходы
+    for (int i = 0; i < 10; i++) {
+        advanceMs(Constants::MQTT_PUBLISH_INTERVAL);
+        mqttClient.update();
+    }
+    // 11 циклов по 2 сообщения в очереди на 16: старые вытеснены
+    CHECK_EQ(mqttClient.getQueuedCount(), MqttClient::QUEUE_SIZE);
+    CHECK_EQ(mqttClient.getDroppedCount(), 22 - MqttClient::QUEUE_SIZE);
+    CHECK_EQ(mqttClient.getReconnectCount(), 0);
+    CHECK(Host::broker.published.empty());
+
+    // Брокер поднялся: подключение - при следующей разрешенной попытке
+    Host::broker.online = true;
+    advanceMs(1000);
+    mqttClient.update();
+    CHECK(!mqttClient.isConnected());
+    advanceMs(Constants::MQTT_RECONNECT_MAX);
+    mqttClient.update();
+    CHECK(mqttClient.isConnected());
+    CHECK_EQ(Host::broker.connects, 1);
+    CHECK(Host::broker.clientId == "greenhouse-C3D4E5F6");
+    CHECK(Host::broker.willTopic == topic("status") && Host::broker.willMessage == "offline");
+    CHECK_EQ(Host::broker.subscriptions.size(), 2);
+    CHECK(Host::broker.published[0].topic == topic("status"));
+    CHECK(Host::broker.published[0].payload == "online" && Host::broker.published[0].retained);
+
+    // Порции по MQTT_FLUSH_BATCH за update(), порядок сохраняется
+    CHECK_EQ(Host::broker.published.size(), 1 + Constants::MQTT_FLUSH_BATCH);
+    while (mqttClient.getQueuedCount() > 0) mqttClient.update();
+    CHECK_EQ(Host::broker.published.size(), 1 + MqttClient::QUEUE_SIZE);
+    CHECK_EQ(countTopic("sensors"), MqttClient::QUEUE_SIZE / 2);
+    CHECK(Host::broker.published[1].topic == topic("sensors"));
+    CHECK(Host::broker.published[2].topic == topic("actuators"));
+    CHECK(Host::broker.published[2].payload.find("\"fan\":1") != std::string::npos);
+    CHECK_EQ(mqttClient.getPublishedCount(), MqttClient::QUEUE_SIZE);
+}
+
+static void testConnectionLoss() {
+    Host::broker.published.clear();
+    Host::broker.drop();
+    advanceMs(Constants::MQTT_PUBLISH_INTERVAL);
+    mqttClient.update();
+    CHECK(!mqttClient.isConnected());
+    CHECK_EQ(countTopic("status"), 1);      // last will
+    CHECK_EQ(mqttClient.getQueuedCount(), 2);
+
+    // Попытка сразу после обрыва не удалась, следующая - через удвоенную паузу
+    Host::broker.online = true;
+    advanceMs(Constants::MQTT_RECONNECT_MIN);
+    mqttClient.update();
+    CHECK(!mqttClient.isConnected());
+    advanceMs(Constants::MQTT_RECONNECT_MIN);
+    mqttClient.update();
+    CHECK(mqttClient.isConnected());
+    CHECK_EQ(mqttClient.getReconnectCount(), 2);
+    CHECK_EQ(mqttClient.getQueuedCount(), 0);
+}
+
+static void testCommandResults() {
+    Host::broker.published.clear();
+    controlCode = 400;
+    controlMessage = "Unknown device \"fan\\2\"\n";
+    CHECK(Host::broker.deliver(topic("control/set").c_str(), "{\"device\":\"fan\\\\2\"}"));
+    CHECK_EQ(controlCalls, 1);
+    CHECK(Host::broker.deliver(topic("control/set").c_str(), "{\"device\":"));
+    CHECK_EQ(controlCalls, 1);
+    CHECK(Host::broker.deliver(topic("settings/set").c_str(), "{\"mqttPort\":1884}"));
+    CHECK(!Host::broker.deliver(topic("sensors").c_str(), "{}"));     // не подписан
+
+    mqttClient.update();
+    CHECK_EQ(Host::broker.published.size(), 3);
+    // Сообщение попадает в JSON экранированным
+    CHECK(Host::broker.published[0].topic == topic("control/result"));
+    CHECK(Host::broker.published[0].payload ==
+          "{\"status\":400,\"message\":\"Unknown device \\\"fan\\\\2\\\"\\n\"}");
+    CHECK(Host::broker.published[1].payload ==
+          "{\"status\":400,\"message\":\"Invalid JSON: IncompleteInput\"}");
+    CHECK(Host::broker.published[2].topic == topic("settings/result"));
+    CHECK(Host::broker.published[2].payload ==
+          "{\"status\":200,\"message\":\"Settings updated successfully\"}");
+}
+
+static void testLongMessageStaysValid() {
+    // Экранирование удлиняет текст; обрезка не режет escape-последовательность
+    FixedString<16> out;
+    out.appendJsonString("\"\"\"\"\"\"\"\"\"\"", 1);
+    out += '}';
+    CHECK_EQ(out.length(), 15);
+    CHECK(strcmp(out.c_str(), "\"\\\"\\\"\\\"\\\"\\\"\\\"\"}") == 0);
+
+    FixedString<16> control;
+    control.appendJsonString("a\tb");
+    CHECK(strcmp(control.c_str(), "\"a\\u0009b\"") == 0);
+}
+
+static void testAlarms() {
+    Host::broker.published.clear();
+    CHECK(alarmListener != nullptr);
+    alarmListener(3, AlarmState::ACTIVE);
+    mqttClient.update();
+    CHECK_EQ(countTopic("alarms"), 1);
+    CHECK(Host::broker.published.back().payload.find("\"alarm\":\"alarm3\",\"state\":\"active\"") !=
+          std::string::npos);
+}
+
+int main() {
+    Host::setMicros(1000000);
+    statusView.channelValue[(uint8_t)ControlDevice::FAN] = 1;
+    systemSettings.mqttEnabled = true;
+    strlcpy(systemSettings.mqttHost, "broker.local", sizeof(systemSettings.mqttHost));
+    mqttClient.begin();
+
+    testOfflineQueueAndReconnect();
+    testConnectionLoss();
+    testCommandResults();
+    testLongMessageStaysValid();
+    testAlarms();
+    return TEST_RESULT();
+}
@@ -0,0 +1,151 @@
+// Очереди и снимок между потоками: порядок, целостность и отсутствие
+// потерь при одновременной работе сторон. Собирается дважды - обычной
+// сборкой и под ThreadSanitizer (test_queue_stress_tsan), который ловит
+// гонки за пределами того, что видно по данным.
+#include <thread>
+#include <vector>
+#include "MpscQueue.h"
+#include "Seqlock.h"
+#include "SpscQueue.h"
+#include "TestSupport.h"
+
+// На одном ядре стороны сменяют друг друга только на yield
+static void yieldToPeer() { std::this_thread::yield(); }
+
+// Полезная нагрузка с проверочным полем: разорванная запись видна сразу
+struct Item {
+    uint32_t producer;
+    uint32_t sequence;
+    uint32_t check;
+
+    static Item make(uint32_t producer, uint32_t sequence) {
+        return {producer, sequence, ~(producer * 2654435761U ^ sequence)};
+    }
+    bool valid() const { return check == ~(producer * 2654435761U ^ sequence); }
+};
+
+static void testSpscOrder() {
+    static SpscQueue<Item, 16> queue;
+    const uint32_t count = 100000;
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < count;) {
+            if (queue.push(Item::make(0, i))) i++;
+            else yieldToPeer();
+        }
+    });
+
+    // Потребитель чередует pop() и разбор на месте через front()/release()
+    uint32_t expected = 0, broken = 0, reordered = 0;
+    while (expected < count) {
+        Item item;
+        if (expected % 2) {
+            const Item* next = queue.front();
+            if (!next) { yieldToPeer(); continue; }
+            item = *next;
+            queue.release();
+        } else if (!queue.pop(item)) {
+            yieldToPeer();
+            continue;
+        }
+        if (!item.valid()) broken++;
+        if (item.sequence != expected) reordered++;
+        expected++;
+    }
+    producer.join();
+    CHECK_EQ(broken, 0);
+    CHECK_EQ(reordered, 0);
+    CHECK(queue.empty());
+}
+
+static void testMpscPerProducerOrder() {
+    // Как в журнале: задачи и ISR пишут в одну очередь, читает одна задача
+    static MpscQueue<Item, 32> queue;
+    const uint32_t producers = 4;
+    const uint32_t count = 25000;
+    std::vector<std::thread> threads;
+    for (uint32_t p = 0; p < producers; p++) {
+        threads.emplace_back([p, count] {
+            for (uint32_t i = 0; i < count;) {
+                if (p % 2) {
+                    // Запись на месте: ячейка занята до commit()
+                    uint32_t position;
+                    Item* slot = queue.reserve(position);
+                    if (!slot) { yieldToPeer(); continue; }
+                    *slot = Item::make(p, i);
+                    queue.commit(position);
+                    i++;
+                } else if (queue.push(Item::make(p, i))) {
+                    i++;
+                } else {
+                    yieldToPeer();
+                }
+            }
+        });
+    }
+
+    uint32_t next[producers] = {};
+    uint32_t received = 0, broken = 0, reordered = 0;
+    while (received < producers * count) {
+        Item item;
+        if (!queue.pop(item)) { yieldToPeer(); continue; }
+        if (!item.valid() || item.producer >= producers) {
+            broken++;
+        } else {
+            if (item.sequence != next[item.producer]) reordered++;
+            next[item.producer] = item.sequence + 1;
+        }
+        received++;
+    }
+    for (std::thread& thread : threads) thread.join();
+    CHECK_EQ(broken, 0);
+    CHECK_EQ(reordered, 0);
+    for (uint32_t p = 0; p < producers; p++) CHECK_EQ(next[p], count);
+    Item extra;
+    CHECK(!queue.pop(extra));
+}
+
+#ifndef TSAN_BUILD
+// Seqlock копирует значение без атомарных операций и сам отбрасывает
+// копию, попавшую на запись. Для TSan это гонка, поэтому проверка - только
+// в обычной сборке.
+static void testSeqlockSnapshots() {
+    struct Snapshot { uint32_t words[32]; };
+    static Seqlock<Snapshot> lock;
+    const uint32_t versions = 20000;
+    std::thread writer([&] {
+        for (uint32_t v = 1; v <= versions; v++) {
+            Snapshot& snapshot = lock.beginWrite();
+            for (uint32_t& word : snapshot.words) word = v;
+            lock.endWrite();
+            if (v % 8 == 0) yieldToPeer();
+        }
+    });
+
+    Snapshot copy = {};
+    uint32_t seen = 0, last = 0, torn = 0, backwards = 0, reads = 0;
+    while (last < versions) {
+        if (!lock.read(copy, seen)) { yieldToPeer(); continue; }
+        for (uint32_t word : copy.words) {
+            if (word != copy.words[0]) { torn++; break; }
+        }
+        if (copy.words[0] < last) backwards++;
+        last = copy.words[0];
+        reads++;
+    }
+    writer.join();
+    CHECK_EQ(torn, 0);
+    CHECK_EQ(backwards, 0);
+    CHECK(reads > 0);
+    // Неизменный снимок повторно не копируется
+    CHECK(!lock.read(copy, seen));
+}
+#endif
+
+int main() {
+    testSpscOrder();
+    testMpscPerProducerOrder();
+#ifndef TSAN_BUILD
+    testSeqlockSnapshots();
+#endif
+    return TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+// Кадр телеметрии: раскладка 33 байт по эталону и прием через UDP-петлю
+// декодером сборщика.
+#include "TelemetryPublisher.h"
+#include "TelemetryDecoder.h"
+#include "TestSupport.h"
+
+SystemSettings systemSettings;
+SensorData sensorView;
+
+static SensorData sampleData() {
+    SensorData data;
+    data.airTemperature = Temperature::fromFloat(23.45f);
+    data.airHumidity = Percent::fromFloat(61.5f);
+    data.pressure = Pressure::fromFloat(1013.2f);
+    data.soilTemperature = Temperature::fromFloat(-1.25f);
+    // Влажность почвы отсутствует
+    data.lightLevel = Illuminance::fromFloat(1234);
+    data.pumpState = true;
+    data.heaterState = true;
+    data.systemHealthy = true;
+    return data;
+}
+
+static void testCrcCheckValue() {
+    // Контрольное значение CRC-16/CCITT-FALSE
+    const uint8_t text[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    CHECK_EQ(TelemetryPublisher::crc16(text, sizeof(text)), 0x29B1);
+    CHECK_EQ(TelemetryDecoder::crc16(text, sizeof(text)), 0x29B1);
+}
+
+static void testFrameLayout() {
+    uint8_t frame[TelemetryPublisher::FRAME_SIZE + 8];
+    memset(frame, 0xAA, sizeof(frame));
+    size_t length = TelemetryPublisher::encodeFrame(sampleData(), 0xC3D4E5F6, 7, 0x01020304, frame);
+    CHECK_EQ(length, 33);
+    CHECK_EQ(TelemetryPublisher::FRAME_SIZE, 33);
+    CHECK_EQ(frame[33], 0xAA);  // за кадр запись не выходит
+
+    const uint8_t expected[31] = {
+        0x47, 0x48,                 // магическое число
+        0x01,                       // версия
+        0x01,                       // данные датчиков
+        0xF6, 0xE5, 0xD4, 0xC3,     // устройство
+        0x07, 0x00, 0x00, 0x00,     // номер кадра
+        0x04, 0x03, 0x02, 0x01,     // время работы
+        0x29, 0x09,                 // 23.45 °C
+        0x06, 0x18,                 // 61.50 %
+        0x94, 0x27,                 // 1013.2 гПа
+        0x83, 0xFF,                 // -1.25 °C
+        0xFF, 0xFF,                 // нет данных
+        0x34, 0x30, 0x00, 0x00,     // 1234.0 лк
+        0x25,                       // насос, обогрев, исправна
+    };
+    for (size_t i = 0; i < sizeof(expected); i++) {
+        if (frame[i] != expected[i]) printf("byte %zu: 0x%02X, expected 0x%02X\n", i, frame[i], expected[i]);
+        CHECK_EQ(frame[i], expected[i]);
+    }
+    uint16_t crc = TelemetryDecoder::crc16(frame, 31);
+    CHECK_EQ(frame[31], crc & 0xFF);
+    CHECK_EQ(frame[32], crc >> 8);
+}
+
+static void testDecoderRejectsDamage() {
+    uint8_t frame[TelemetryPublisher::FRAME_SIZE];
+    TelemetryPublisher::encodeFrame(sampleData(), 1, 2, 3, frame);
+    TelemetryFrame decoded;
+
+    CHECK(TelemetryDecoder::decode(frame, sizeof(frame) - 1, decoded) == TelemetryDecodeResult::BAD_LENGTH);
+    frame[17] ^= 0x01;
+    CHECK(TelemetryDecoder::decode(frame, sizeof(frame), decoded) == TelemetryDecodeResult::BAD_CRC);
+    frame[17] ^= 0x01;
+    frame[0] = 0;
+    CHECK(TelemetryDecoder::decode(frame, sizeof(frame), decoded) == TelemetryDecodeResult::BAD_MAGIC);
+}
+
+static void testLoopback() {
+    systemSettings.telemetryEnabled = true;
+    systemSettings.telemetryPort = 4210;
+    systemSettings.telemetryInterval = 10;
+    sensorView = sampleData();
+    Host::setMicros(60000000ULL);
+
+    WiFiUDP collector;
+    collector.begin(4210);
+    TelemetryPublisher publisher;
+    publisher.begin();
+
+    publisher.update();
+    publisher.update();     // интервал еще не прошел
+    Host::advanceMicros(10000000ULL);
+    sensorView.doorState = true;
+    sensorView.airTemperature = Temperature();
+    publisher.update();
+    CHECK_EQ(publisher.getSentCount(), 2);
+
+    uint8_t buffer[64];
+    TelemetryFrame frame;
+    CHECK_EQ(collector.parsePacket(), 33);
+    CHECK_EQ(collector.remoteIP()[0], 255);
+    CHECK(TelemetryDecoder::decode(buffer, collector.read(buffer, sizeof(buffer)), frame) == TelemetryDecodeResult::OK);
+    CHECK_EQ(frame.type, 1);
+    CHECK_EQ(frame.deviceId, 0xC3D4E5F6);
+    CHECK_EQ(frame.sequence, 0);
+    CHECK_EQ(frame.uptimeMs, 60000);
+    CHECK(fabsf(frame.airTemperature - 23.45f) < 0.001f);
+    CHECK(fabsf(frame.airHumidity - 61.5f) < 0.001f);
+    CHECK(fabsf(frame.pressure - 1013.2f) < 0.01f);
+    CHECK(fabsf(frame.soilTemperature + 1.25f) < 0.001f);
+    CHECK(isnan(frame.soilMoisture));
+    CHECK(fabsf(frame.lightLevel - 1234) < 0.01f);
+    CHECK(frame.pump && frame.heater && frame.systemHealthy);
+    CHECK(!frame.fan && !frame.light && !frame.door);
+
+    CHECK_EQ(collector.parsePacket(), 33);
+    CHECK(TelemetryDecoder::decode(buffer, collector.read(buffer, sizeof(buffer)), frame) == TelemetryDecodeResult::OK);
+    CHECK_EQ(frame.sequence, 1);
+    CHECK_EQ(frame.uptimeMs, 70000);
+    CHECK(isnan(frame.airTemperature));
+    CHECK(frame.door);
+    CHECK_EQ(collector.parsePacket(), 0);
+
+    // Неудачная отправка не тратит номер кадра
+    WiFiUDP::failSend = true;
+    Host::advanceMicros(10000000ULL);
+    publisher.update();
+    WiFiUDP::failSend = false;
+    CHECK_EQ(publisher.getErrorCount(), 1);
+    CHECK_EQ(collector.parsePacket(), 0);
+    Host::advanceMicros(10000000ULL);
+    publisher.update();
+    CHECK_EQ(collector.parsePacket(), 33);
+    CHECK(TelemetryDecoder::decode(buffer, collector.read(buffer, sizeof(buffer)), frame) == TelemetryDecodeResult::OK);
+    CHECK_EQ(frame.sequence, 2);
+
+    // Без сети кадры не отправляются
+    Host::wifiStatus = WL_DISCONNECTED;
+    Host::advanceMicros(10000000ULL);
+    publisher.update();
+    Host::wifiStatus = WL_CONNECTED;
+    CHECK_EQ(collector.parsePacket(), 0);
+    CHECK_EQ(publisher.getErrorCount(), 1);
+}
+
+int main() {
+    testCrcCheckValue();
+    testFrameLayout();
+    testDecoderRejectsDamage();
+    testLoopback();
+    return TEST_RESULT();
+}
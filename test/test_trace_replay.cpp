@@ -0,0 +1,230 @@
+// Трасса туда и обратно: цикл управления записывает опросы через
+// TraceRecorder, файл выгрузки режется на куски и воспроизводится
+// TraceReplay. Решения автоматики при воспроизведении совпадают с
+// записанными, в том числе когда часть датчиков на устройстве отказала,
+// когда кольцо уже перезаписано и когда файл склеен из нескольких выгрузок.
+#include <vector>
+#include "Automation.h"
+#include "TraceReplay.h"
+#include "TestSupport.h"
+
+// Выходы устройства: состояние попадает в SensorData, изменения - в трассу,
+// как у DeviceManager
+class Outputs : public Actuators {
+public:
+    Outputs(SensorData& data, TraceRecorder& recorder, unsigned long& now)
+        : data(data), recorder(recorder), now(now) {}
+    void controlPump(bool state, ControlCause cause, unsigned long) override { set(ControlDevice::PUMP, data.pumpState, state, cause); }
+    void controlFan(bool state, ControlCause cause) override { set(ControlDevice::FAN, data.fanState, state, cause); }
+    void controlHeater(bool state, ControlCause cause) override { set(ControlDevice::HEATER, data.heaterState, state, cause); }
+    void controlLight(bool state, ControlCause cause) override { set(ControlDevice::LIGHT, data.lightState, state, cause); }
+
+private:
+    void set(ControlDevice device, bool& current, bool state, ControlCause cause) {
+        if (current == state) return;
+        current = state;
+        recorder.recordCommand(now, device, state ? 1 : 0, cause);
+    }
+
+    SensorData& data;
+    TraceRecorder& recorder;
+    unsigned long& now;
+};
+
+// Цикл управления на стенде: опрос, фильтрация, автоматика, запись
+struct Device {
+    TraceRecorder recorder;
+    SensorFusion fusion;
+    Automation automation{fusion};
+    SystemSettings settings;
+    SensorData state;
+    unsigned long now = 0;
+    Outputs outputs{state, recorder, now};
+
+    Device() {
+        fusion.setLogging(false);
+        automation.setLogging(false);
+    }
+
+    void step(float air, float soilMoisture, bool airAvailable, bool soilAvailable) {
+        // Полив короче периода опроса: к следующему шагу насос уже выключен таймером
+        if (state.pumpState) outputs.controlPump(false, ControlCause::TIMER, 0);
+        SensorData data = state;
+        data.airTemperature = Temperature::fromFloat(air);
+        data.airHumidity = Percent::fromFloat(60);
+        data.pressure = Pressure::fromFloat(1013);
+        data.soilTemperature = Temperature::fromFloat(air - 2);
+        data.soilMoisture = Percent::fromFloat(soilMoisture);
+        data.lightLevel = Illuminance::fromFloat(1000);
+        SensorData raw = data;
+        fusion.process(data, now, airAvailable, soilAvailable, true);
+        automation.process(data, settings, outputs, now);
+        data.pumpState = state.pumpState;
+        data.fanState = state.fanState;
+        data.heaterState = state.heaterState;
+        data.lightState = state.lightState;
+        recorder.recordSample(now, raw, data, airAvailable, soilAvailable, true, settings.automationEnabled);
+        now += 30000;
+    }
+
+    // Сухая почва поливается после каждой паузы, температура ходит вокруг уставки
+    void run(uint32_t steps) {
+        for (uint32_t i = 0; i < steps; i++) {
+            uint32_t phase = (now / 30000) % 40;
+            step(phase < 20 ? 22 + phase * 0.3f : 34 - (phase - 20) * 0.3f, 30, true, true);
+        }
+    }
+
+    // Файл в том виде, в каком его отдает /api/trace?since=
+    std::vector<uint8_t> download(uint32_t since = 0) const {
+        uint32_t total = recorder.getTotal();
+        uint32_t first = TraceRecorder::getFirstSequence(total);
+        if (since < first) since = first;
+        TraceHeader header = {TraceRecorder::MAGIC, TraceRecorder::VERSION, sizeof(TraceRecord), since, total - since};
+        std::vector<uint8_t> file((const uint8_t*)&header, (const uint8_t*)&header + sizeof(header));
+        for (uint32_t sequence = since; sequence < total; sequence++) {
+            TraceRecord record;
+            if (!recorder.read(sequence, record)) {
+                record = TraceRecord();
+                record.type = TraceRecordType::GAP;
+            }
+            file.insert(file.end(), (const uint8_t*)&record, (const uint8_t*)&record + sizeof(record));
+        }
+        return file;
+    }
+};
+
+// Куски не совпадают с границами записей
+static TraceReplay::Report replay(const std::vector<uint8_t>& file, const SystemSettings& settings) {
+    static TraceReplay replayer;
+    replayer.begin(settings);
+    for (size_t offset = 0; offset < file.size(); offset += 7) {
+        replayer.feed(file.data() + offset, file.size() - offset < 7 ? file.size() - offset : 7);
+    }
+    return replayer.finish();
+}
+
+static void append(std::vector<uint8_t>& file, const std::vector<uint8_t>& segment) {
+    file.insert(file.end(), segment.begin(), segment.end());
+}
+
+static void testRoundTrip() {
+    static Device device;
+    // Холодно, жарко, снова в норме; почва подсыхает до полива
+    for (int i = 0; i < 40; i++) device.step(18 + i * 0.3f, 60 - i, true, true);
+    CHECK(device.recorder.getTotal() > 40);
+
+    TraceReplay::Report report = replay(device.download(), device.settings);
+    CHECK(report.error == nullptr);
+    CHECK_EQ(report.records, device.recorder.getTotal());
+    CHECK_EQ(report.segments, 1);
+    CHECK(report.warmupSteps >= TraceReplay::WARMUP_SAMPLES);
+    CHECK_EQ(report.steps + report.warmupSteps, 40);
+    CHECK_EQ(report.mismatches, 0);
+}
+
+static void testUnavailableSourcesHonoured() {
+    // Почва на устройстве отказала: сухие отсчеты не вызывают полив, а
+    // воздух пропадает на середине - обогрев выключается
+    static Device device;
+    for (int i = 0; i < 20; i++) device.step(18, 20, true, false);
+    for (int i = 0; i < 10; i++) device.step(18, 20, false, false);
+    std::vector<uint8_t> file = device.download();
+
+    TraceReplay::Report report = replay(file, device.settings);
+    CHECK(report.error == nullptr);
+    CHECK_EQ(report.steps + report.warmupSteps, 30);
+    CHECK_EQ(report.mismatches, 0);
+
+    // Та же трасса с исправными датчиками дала бы другие решения: флаги
+    // в записи действительно управляют воспроизведением
+    const size_t flagsOffset = offsetof(TraceRecord, flags);
+    for (size_t offset = sizeof(TraceHeader); offset < file.size(); offset += sizeof(TraceRecord)) {
+        if (file[offset + offsetof(TraceRecord, type)] == (uint8_t)TraceRecordType::SAMPLE) {
+            file[offset + flagsOffset] |= TraceRecord::FLAG_AIR_AVAILABLE | TraceRecord::FLAG_SOIL_AVAILABLE;
+        }
+    }
+    report = replay(file, device.settings);
+    CHECK(report.mismatches > 0);
+    CHECK(report.deviceMismatches[(uint8_t)ControlDevice::PUMP] > 0);
+    CHECK(report.deviceMismatches[(uint8_t)ControlDevice::HEATER] > 0);
+}
+
+static void testWrappedRing() {
+    // Кольцо перезаписано: трасса начинается посреди работы, с заполненными
+    // фильтрами и паузой после полива, которых воспроизведение не видело
+    static Device device;
+    device.run(1000);
+    CHECK(TraceRecorder::getFirstSequence(device.recorder.getTotal()) > 0);
+
+    TraceReplay::Report report = replay(device.download(), device.settings);
+    CHECK(report.error == nullptr);
+    CHECK_EQ(report.records, Constants::TRACE_CAPACITY - 1);
+    CHECK(report.steps > 300);
+    CHECK_EQ(report.mismatches, 0);
+    CHECK_EQ(report.gaps, 0);
+}
+
+static void testConcatenatedSegments() {
+    static Device device;
+    device.run(150);
+    std::vector<uint8_t> first = device.download();
+    uint32_t continued = device.recorder.getTotal();
+    device.run(100);
+
+    // Продолжение с firstSequence + count: одна непрерывная трасса
+    std::vector<uint8_t> file = first;
+    append(file, device.download(continued));
+    TraceReplay::Report report = replay(file, device.settings);
+    CHECK(report.error == nullptr);
+    CHECK_EQ(report.segments, 2);
+    CHECK_EQ(report.records, device.recorder.getTotal());
+    CHECK_EQ(report.gaps, 0);
+    CHECK_EQ(report.mismatches, 0);
+    // Прогрев - только в начале
+    TraceReplay::Report single = replay(device.download(), device.settings);
+    CHECK_EQ(report.warmupSteps, single.warmupSteps);
+
+    // Перекрытие: повторная выгрузка с более раннего номера не повторяет записи
+    file = first;
+    append(file, device.download(continued - 20));
+    report = replay(file, device.settings);
+    CHECK_EQ(report.records, device.recorder.getTotal());
+    CHECK_EQ(report.mismatches, 0);
+
+    // Между выгрузками кольцо ушло вперед: потеря считается, прогрев заново
+    device.run(600);
+    file = first;
+    uint32_t lost = TraceRecorder::getFirstSequence(device.recorder.getTotal()) - continued;
+    append(file, device.download(continued));
+    report = replay(file, device.settings);
+    CHECK(report.error == nullptr);
+    CHECK_EQ(report.gaps, lost);
+    CHECK(report.warmupSteps > single.warmupSteps);
+    CHECK_EQ(report.mismatches, 0);
+}
+
+static void testRejectsOldVersion() {
+    static Device device;
+    device.step(20, 50, true, true);
+    std::vector<uint8_t> file = device.download();
+    TraceHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    header.version = 1;
+    memcpy(file.data(), &header, sizeof(header));
+    CHECK(replay(file, device.settings).error != nullptr);
+
+    // Заголовок продолжения тоже проверяется
+    file = device.download();
+    append(file, std::vector<uint8_t>((const uint8_t*)&header, (const uint8_t*)&header + sizeof(header)));
+    CHECK(replay(file, device.settings).error != nullptr);
+}
+
+int main() {
+    testRoundTrip();
+    testUnavailableSourcesHonoured();
+    testWrappedRing();
+    testConcatenatedSegments();
+    testRejectsOldVersion();
+    return TEST_RESULT();
+}
@@ -0,0 +1,55 @@
+// Воспроизведение выгруженной трассы на ПК - то же, что POST /api/trace/replay,
+// но без устройства и без ограничения на длину трассы. Выгрузки за сезон
+// дописываются в один файл с продолжением от firstSequence + count:
+//   curl http://greenhouse.local/api/trace?since=N >> trace.bin
+//   trace_replay trace.bin [температура влажность влажность_почвы]
+// Уставки по умолчанию - как в SystemSettings; для сравнения с устройством
+// задаются те, что стояли на нем при записи.
+#include <cstdlib>
+#include "DeviceNames.h"
+#include "TraceReplay.h"
+
+int main(int argc, char** argv) {
+    if (argc != 2 && argc != 5) {
+        fprintf(stderr, "usage: %s trace.bin [tempSetpoint humSetpoint soilMoistureSetpoint]\n", argv[0]);
+        return 2;
+    }
+    FILE* file = fopen(argv[1], "rb");
+    if (!file) {
+        perror(argv[1]);
+        return 2;
+    }
+
+    SystemSettings settings;
+    if (argc == 5) {
+        settings.tempSetpoint = strtof(argv[2], nullptr);
+        settings.humSetpoint = strtof(argv[3], nullptr);
+        settings.soilMoistureSetpoint = strtof(argv[4], nullptr);
+    }
+
+    static TraceReplay replay;
+    replay.begin(settings);
+    uint8_t chunk[4096];
+    size_t length;
+    while ((length = fread(chunk, 1, sizeof(chunk), file)) > 0) replay.feed(chunk, length);
+    fclose(file);
+
+    const TraceReplay::Report& report = replay.finish();
+    if (report.error) {
+        fprintf(stderr, "%s: %s\n", argv[1], report.error);
+        return 2;
+    }
+    printf("segments: %u, records: %u, steps: %u (+%u warm-up), gaps: %u, span: %u..%u ms\n",
+           report.segments, report.records, report.steps, report.warmupSteps, report.gaps,
+           report.firstTimeMs, report.lastTimeMs);
+    printf("mismatches: %u", report.mismatches);
+    for (uint8_t i = 0; i < TraceReplay::DEVICE_COUNT; i++) {
+        printf(", %s %u", DeviceNames::name((ControlDevice)i), report.deviceMismatches[i]);
+    }
+    printf("\n");
+    if (report.mismatches) {
+        printf("first at %u ms: expected outputs 0x%02X, replayed 0x%02X\n", report.firstMismatchMs,
+               report.firstMismatchExpected, report.firstMismatchActual);
+    }
+    return report.mismatches ? 1 : 0;
+}